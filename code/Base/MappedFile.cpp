@@ -0,0 +1,128 @@
+// ======================================================================== //
+// Copyright 2009-2012 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "Base/Platform.hpp"
+#include "Base/MappedFile.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+/// Windows Platform
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(PLATFORM_OS_WINDOWS)
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+namespace Base
+{
+    /* maps a file read only into memory */
+    const void* MapFile( const std::string& fileName, size_t& size )
+    {
+        size = 0;
+        HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return NULL;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return NULL;
+        }
+
+        /* the view keeps the mapping alive */
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (mapping == NULL)
+        {
+            return NULL;
+        }
+
+        const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (data != NULL)
+        {
+            size = (size_t)fileSize.QuadPart;
+        }
+        return data;
+    }
+
+    /* unmaps a file mapped by MapFile */
+    void UnmapFile( const void* data, size_t /*size*/ )
+    {
+        if (data != NULL)
+        {
+            UnmapViewOfFile(data);
+        }
+    }
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// Unix Platform
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(PLATFORM_OS_UNIX)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Base
+{
+    /* maps a file read only into memory */
+    const void* MapFile( const std::string& fileName, size_t& size )
+    {
+        size = 0;
+        int file = open(fileName.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            return NULL;
+        }
+
+        struct stat fileStat;
+        if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            close(file);
+            return NULL;
+        }
+
+        /* the mapping stays valid after the file is closed */
+        void* data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (data == MAP_FAILED)
+        {
+            return NULL;
+        }
+
+        size = (size_t)fileStat.st_size;
+        return data;
+    }
+
+    /* unmaps a file mapped by MapFile */
+    void UnmapFile( const void* data, size_t size )
+    {
+        if (data != NULL)
+        {
+            munmap(const_cast<void*>(data), size);
+        }
+    }
+}
+#endif
@@ -0,0 +1,29 @@
+// ======================================================================== //
+// Copyright 2009-2012 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace Base
+{
+  /*! maps a file read only into memory, returns NULL if it can not be opened */
+  const void* MapFile( const std::string& fileName, size_t& size );
+
+  /*! unmaps a file mapped by MapFile */
+  void UnmapFile( const void* data, size_t size );
+}
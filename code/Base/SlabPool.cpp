@@ -0,0 +1,85 @@
+// ======================================================================== //
+// Copyright 2009-2012 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "Base/SlabPool.hpp"
+
+#include <algorithm>
+
+namespace Base
+{
+  static size_t RoundUp( size_t size, size_t alignment )
+  {
+    return (size + alignment - 1) / alignment * alignment;
+  }
+
+  SlabPool::SlabPool( size_t size, size_t alignment, u32 slotsPerSlab )
+    : m_alignment( std::max( alignment, sizeof(void*) ) )
+    , m_slotsPerSlab( std::max( slotsPerSlab, 1u ) )
+    , m_count( 0 )
+    , m_bump( 0 )
+    , m_free( NULL )
+  {
+    /* the header keeps the slot aligned, a free slot has to hold the next one */
+    m_header = RoundUp( sizeof(SlabPool*), m_alignment );
+    m_stride = RoundUp( m_header + std::max( size, sizeof(void*) ), m_alignment );
+  }
+
+  SlabPool::~SlabPool( void )
+  {
+    for ( size_t i = 0; i < m_slabs.size(); i++ )
+    {
+      delete [] m_slabs[i];
+    }
+  }
+
+  void* SlabPool::Allocate( void )
+  {
+    void* slot = m_free;
+
+    if ( slot != NULL )
+    {
+      m_free = *static_cast<void**>( slot );
+    }
+    else
+    {
+      if ( m_bump == 0 )
+      {
+        m_slabs.push_back( new char[m_stride * m_slotsPerSlab + m_alignment] );
+        m_bump = m_slotsPerSlab;
+      }
+
+      /* hand out the last slab front to back */
+      char* slab = reinterpret_cast<char*>( RoundUp( reinterpret_cast<uptr>( m_slabs.back() ), m_alignment ) );
+      slot = slab + m_stride * (m_slotsPerSlab - m_bump) + m_header;
+      m_bump--;
+
+      *reinterpret_cast<SlabPool**>( static_cast<char*>( slot ) - sizeof(SlabPool*) ) = this;
+    }
+
+    m_count++;
+    return slot;
+  }
+
+  void SlabPool::Free( void* slot )
+  {
+    if ( slot != NULL )
+    {
+      *static_cast<void**>( slot ) = m_free;
+      m_free = slot;
+      m_count--;
+    }
+  }
+}
@@ -0,0 +1,88 @@
+// ======================================================================== //
+// Copyright 2009-2012 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "Base/Compat.hpp"
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace Base
+{
+  /*! hands out fixed size slots from slabs of memory, freed slots are reused first. Each slot
+   *  remembers its pool so an object can be returned without knowing where it came from. The
+   *  slabs are only released with the pool. Not thread safe. */
+  class SlabPool
+  {
+  public:
+    SlabPool( size_t size, size_t alignment, u32 slotsPerSlab = 64 );
+    ~SlabPool( void );
+
+    /*! returns an uninitialized slot of the pool's size and alignment */
+    void* Allocate( void );
+
+    /*! returns a slot to the pool, the object in it has to be destroyed already */
+    void Free( void* slot );
+
+    /*! returns the pool a slot was allocated from */
+    static SlabPool* GetPool( void* slot )
+    {
+      return *reinterpret_cast<SlabPool**>( static_cast<char*>( slot ) - sizeof(SlabPool*) );
+    }
+
+    /*! returns the number of slots in use */
+    u32 GetCount( void ) const { return m_count; }
+
+  private:
+    SlabPool( const SlabPool& );
+    SlabPool& operator=( const SlabPool& );
+
+    size_t              m_header;       /* bytes in front of a slot, the pool pointer is last */
+    size_t              m_stride;       /* bytes from one slot to the next */
+    size_t              m_alignment;
+    u32                 m_slotsPerSlab;
+    u32                 m_count;
+    u32                 m_bump;         /* slots of the last slab not handed out yet */
+    void*               m_free;         /* freed slots, each holds the next */
+    std::vector<char*>  m_slabs;
+  };
+
+  /*! pool for the objects of one class, use as new( pool.Allocate() ) T( ... ) */
+  template<class T>
+  class ObjectPool : public SlabPool
+  {
+  public:
+    ObjectPool( u32 slotsPerSlab = 64 )
+      : SlabPool( sizeof(T), alignof(T), slotsPerSlab )
+    {
+    }
+  };
+
+  /*! destroys an object created in a pool and returns its slot, the object may be of a class
+   *  derived from the one of the pool */
+  template<class T>
+  void DestroyPooled( T* object )
+  {
+    if ( object != NULL )
+    {
+      void* slot = dynamic_cast<void*>( object );
+      object->~T();
+      SlabPool::GetPool( slot )->Free( slot );
+    }
+  }
+}
@@ -0,0 +1,175 @@
+// ======================================================================== //
+// Copyright 2009-2012 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "Base/StringId.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+namespace Base
+{
+  /* a table is kept at most half full, a full one is copied into one twice the size. Readers
+   * probe without the lock; tables are never freed so a reader may finish on a replaced one */
+  struct Table
+  {
+    u32                 Size;
+    u32                 Count;
+    std::atomic<u32>*   Ids;
+    std::atomic<pcstr>* Strings;
+    std::atomic<u8>*    Reported;
+  };
+
+  static const u32 InitialSize = 1 << 14;
+
+  static std::atomic<u32>   s_ids[InitialSize];
+  static std::atomic<pcstr> s_strings[InitialSize];
+  static std::atomic<u8>    s_reported[InitialSize];
+  static Table              s_initial = { InitialSize, 0, s_ids, s_strings, s_reported };
+
+  static std::atomic<Table*> s_table( &s_initial );
+  static std::mutex          s_lock;
+
+  /* same hash as HashString without the recursion */
+  static StringId Hash( pcstr str )
+  {
+    u32 hash = 2166136261u;
+    for ( ; *str != '\0'; str++ )
+    {
+      hash = (hash ^ (u8)*str) * 16777619u;
+    }
+    return (hash != InvalidStringId) ? hash : 1;
+  }
+
+  /* returns the slot holding id or the empty slot ending its probe */
+  static u32 Find( const Table* pTable, StringId id )
+  {
+    u32 mask = pTable->Size - 1;
+    u32 i = id & mask;
+
+    for ( ; ; i = (i + 1) & mask )
+    {
+      u32 slot = pTable->Ids[i].load( std::memory_order_acquire );
+      if ( slot == id || slot == InvalidStringId )
+      {
+        return i;
+      }
+    }
+  }
+
+  static void CheckCollision( const Table* pTable, u32 i, pcstr str )
+  {
+    pcstr interned = pTable->Strings[i].load( std::memory_order_acquire );
+    if ( strcmp( interned, str ) != 0 )
+    {
+      if ( pTable->Reported[i].exchange( 1, std::memory_order_relaxed ) == 0 )
+      {
+        std::cerr << "String id " << pTable->Ids[i] << " of \"" << str << "\" collides with \""
+                  << interned << "\"." << std::endl;
+      }
+      assert( !"Two strings hash to the same StringId." );
+    }
+  }
+
+  static Table* Grow( const Table* pTable )
+  {
+    Table* pGrown = new Table;
+    pGrown->Size     = pTable->Size * 2;
+    pGrown->Count    = pTable->Count;
+    pGrown->Ids      = new std::atomic<u32>[pGrown->Size];
+    pGrown->Strings  = new std::atomic<pcstr>[pGrown->Size];
+    pGrown->Reported = new std::atomic<u8>[pGrown->Size];
+
+    for ( u32 i = 0; i < pGrown->Size; i++ )
+    {
+      pGrown->Ids[i].store( InvalidStringId, std::memory_order_relaxed );
+      pGrown->Strings[i].store( NULL, std::memory_order_relaxed );
+      pGrown->Reported[i].store( 0, std::memory_order_relaxed );
+    }
+
+    for ( u32 i = 0; i < pTable->Size; i++ )
+    {
+      u32 id = pTable->Ids[i].load( std::memory_order_relaxed );
+      if ( id != InvalidStringId )
+      {
+        u32 j = Find( pGrown, id );
+        pGrown->Strings[j].store( pTable->Strings[i].load( std::memory_order_relaxed ), std::memory_order_relaxed );
+        pGrown->Reported[j].store( pTable->Reported[i].load( std::memory_order_relaxed ), std::memory_order_relaxed );
+        pGrown->Ids[j].store( id, std::memory_order_relaxed );
+      }
+    }
+
+    return pGrown;
+  }
+
+  StringId InternString( pcstr str )
+  {
+    StringId id = Hash( str );
+
+    /* most strings are already interned, they are found without the lock */
+    const Table* pTable = s_table.load( std::memory_order_acquire );
+    u32 i = Find( pTable, id );
+    if ( pTable->Ids[i].load( std::memory_order_acquire ) == id )
+    {
+      CheckCollision( pTable, i, str );
+      return id;
+    }
+
+    std::lock_guard<std::mutex> lock( s_lock );
+
+    /* another thread may have added the string or replaced the table meanwhile */
+    Table* pCurrent = s_table.load( std::memory_order_relaxed );
+    i = Find( pCurrent, id );
+    if ( pCurrent->Ids[i].load( std::memory_order_relaxed ) == id )
+    {
+      CheckCollision( pCurrent, i, str );
+      return id;
+    }
+
+    if ( (pCurrent->Count + 1) * 2 > pCurrent->Size )
+    {
+      pCurrent = Grow( pCurrent );
+      i = Find( pCurrent, id );
+    }
+
+    size_t length = strlen( str );
+    char* copy = new char[length + 1];
+    memcpy( copy, str, length + 1 );
+
+    /* the string is stored first so a reader that sees the id also sees its string */
+    pCurrent->Strings[i].store( copy, std::memory_order_relaxed );
+    pCurrent->Ids[i].store( id, std::memory_order_release );
+    pCurrent->Count++;
+
+    s_table.store( pCurrent, std::memory_order_release );
+    return id;
+  }
+
+  pcstr GetString( StringId id )
+  {
+    const Table* pTable = s_table.load( std::memory_order_acquire );
+    u32 i = Find( pTable, id );
+
+    if ( pTable->Ids[i].load( std::memory_order_acquire ) == id )
+    {
+      return pTable->Strings[i].load( std::memory_order_acquire );
+    }
+
+    return NULL;
+  }
+}
@@ -0,0 +1,61 @@
+// ======================================================================== //
+// Copyright 2009-2012 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "Base/Compat.hpp"
+#include "Base/Platform.hpp"
+
+/* Visual Studio before 2015 has no constexpr, the ids are then hashed at run time */
+#if defined(COMPILER_MSVC) && (COMPILER_VERSION_MAJOR < 14)
+#define STRINGID_CONSTEXPR inline
+#else
+#define STRINGID_CONSTEXPR constexpr
+#endif
+
+/*! hashes a string literal into its id, at compile time where the compiler allows it */
+#define STRINGID( s ) (Base::HashString( s ))
+
+namespace Base
+{
+  /*! 32 bit id of an interned string, the FNV-1a hash of the string. The same string has the
+   *  same id in the framework and in every system library without sharing any state. */
+  typedef u32 StringId;
+
+  /*! id of no string */
+  static const StringId InvalidStringId = 0;
+
+  /*! FNV-1a step over the rest of the string, a hash of 0 is moved to 1 */
+  STRINGID_CONSTEXPR StringId HashStringStep( pcstr str, u32 hash )
+  {
+    return (*str != '\0') ? HashStringStep( str + 1, (hash ^ (u8)*str) * 16777619u ) :
+           (hash != InvalidStringId) ? hash : 1;
+  }
+
+  /*! hashes a string literal into its id, use InternString for strings known at run time */
+  STRINGID_CONSTEXPR StringId HashString( pcstr str )
+  {
+    return HashStringStep( str, 2166136261u );
+  }
+
+  /*! returns the id of a string and remembers the string for GetString. Two different strings
+   *  with the same id are reported once and assert in debug builds. Lookups of interned strings
+   *  are lock free, new strings take a lock. May be called from any thread. */
+  StringId InternString( pcstr str );
+
+  /*! returns the string of an interned id, NULL if the id was not interned in this module */
+  pcstr GetString( StringId id );
+}
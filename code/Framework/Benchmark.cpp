@@ -0,0 +1,254 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+//core
+#include "Base/Compat.hpp"
+#include "Base/Platform.hpp"
+//interface
+#include "Interfaces/Interface.hpp"
+//stdlib
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+//framework
+#include "Framework/EnvironmentManager.hpp"
+#include "Framework/Universal.hpp"
+#include "Framework/TaskManager.hpp"
+#include "Framework/Scheduler.hpp"
+#include "Framework/Benchmark.hpp"
+#include "Framework/FrameArena.hpp"
+
+
+Benchmark::Benchmark(
+    void
+    )
+    : m_ExecutedFrames( 0 )
+    , m_DroppedStepsStart( 0 )
+    , m_DroppedStepsEnd( 0 )
+    , m_ArenaBytesStart( 0 )
+    , m_ArenaBytesEnd( 0 )
+    , m_ArenaBlocksStart( 0 )
+    , m_ArenaBlocksEnd( 0 )
+{
+    IEnvironment::IVariables& Variables = EnvironmentManager::getInstance().Variables();
+    m_Frames = std::max( Variables.GetAsInt( "Benchmark::Frames", 1000 ), 1 );
+    m_WarmupFrames = std::max( Variables.GetAsInt( "Benchmark::WarmupFrames", 10 ), 0 );
+    m_DeltaTime = Variables.GetAsFloat( "Benchmark::DeltaTime", 1.0f / 60.0f );
+    m_Seed = Variables.GetAsInt( "Benchmark::Seed", 0 );
+    m_sOutput = Variables.GetAsString( "Benchmark::Output", "" );
+
+    m_FrameTimes.reserve( m_Frames );
+}
+
+
+Bool
+Benchmark::IsEnabled(
+    void
+    )
+{
+    return EnvironmentManager::getInstance().Variables().GetAsBool( "Benchmark::Enabled", False );
+}
+
+
+Bool
+Benchmark::IsNullSystem(
+    pcstr pszSystemType
+    )
+{
+    if ( !IsEnabled() )
+    {
+        return False;
+    }
+
+    // The list is separated by spaces or commas.
+    std::string sNullSystems = EnvironmentManager::getInstance().Variables().GetAsString(
+        "Benchmark::NullSystems", "Graphics Input Audio" );
+    std::replace( sNullSystems.begin(), sNullSystems.end(), ',', ' ' );
+
+    std::istringstream Stream( sNullSystems );
+    std::string sSystem;
+    while ( Stream >> sSystem )
+    {
+        if ( sSystem == pszSystemType )
+        {
+            return True;
+        }
+    }
+
+    return False;
+}
+
+
+void
+Benchmark::RecordFrame(
+    TimePoint FrameStart,
+    TimePoint FrameEnd,
+    const Scheduler* pScheduler
+    )
+{
+    // Skip the frames which warm up the caches and the scene.
+    if ( m_ExecutedFrames++ < m_WarmupFrames )
+    {
+        return;
+    }
+
+    if ( m_FrameTimes.empty() )
+    {
+        m_MeasureStart = FrameStart;
+        m_DroppedStepsStart = pScheduler->GetDroppedSteps();
+        FrameArena::getInstance().GetStatistics( m_ArenaBytesStart, m_ArenaBlocksStart );
+    }
+    m_MeasureEnd = FrameEnd;
+    m_DroppedStepsEnd = pScheduler->GetDroppedSteps();
+    FrameArena::getInstance().GetStatistics( m_ArenaBytesEnd, m_ArenaBlocksEnd );
+
+    m_FrameTimes.push_back( std::chrono::duration<f32, std::milli>( FrameEnd - FrameStart ).count() );
+
+    pScheduler->GetSystemTimes( m_LastSystemTimes );
+    for ( const auto& System : m_LastSystemTimes )
+    {
+        m_SystemTimes[ System.pszName ].push_back( System.Time * 1000.0f );
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// WriteString - Write a string as a JSON string
+static void
+WriteString(
+    FILE* pFile,
+    pcstr pszString
+    )
+{
+    fputc( '"', pFile );
+    for ( pcstr psz = pszString; *psz != '\0'; psz++ )
+    {
+        unsigned char c = static_cast<unsigned char>(*psz);
+        if ( c == '"' || c == '\\' )
+        {
+            fputc( '\\', pFile );
+            fputc( c, pFile );
+        }
+        else if ( c < 0x20 )
+        {
+            fprintf( pFile, "\\u%04x", c );
+        }
+        else
+        {
+            fputc( c, pFile );
+        }
+    }
+    fputc( '"', pFile );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// WriteTimes - Write the statistics of a set of times in milliseconds
+static void
+WriteTimes(
+    FILE* pFile,
+    std::vector<f32>& Times
+    )
+{
+    std::sort( Times.begin(), Times.end() );
+
+    // Nearest rank percentiles.
+    auto Percentile = [&Times] ( u32 Percent ) -> f32
+    {
+        size_t Rank = ( Times.size() * Percent + 99 ) / 100;
+        return Times[ std::max<size_t>( Rank, 1 ) - 1 ];
+    };
+
+    f64 Total = 0.0;
+    for ( f32 Time : Times )
+    {
+        Total += Time;
+    }
+
+    fprintf( pFile, "{ \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+             Total / Times.size(), Percentile( 50 ), Percentile( 95 ), Percentile( 99 ), Times.back() );
+}
+
+
+Error
+Benchmark::WriteReport(
+    pcstr pszGDF
+    )
+{
+    if ( m_FrameTimes.empty() )
+    {
+        std::cerr << "Benchmark ended after " << m_ExecutedFrames << " frames, before any was measured." << std::endl;
+        return Errors::Failure;
+    }
+
+    FILE* pFile = stdout;
+    if ( !m_sOutput.empty() )
+    {
+        pFile = fopen( m_sOutput.c_str(), "w" );
+        if ( pFile == nullptr )
+        {
+            std::cerr << "Benchmark could not open the output file " << m_sOutput << "." << std::endl;
+            return Errors::File::NotFound;
+        }
+    }
+
+    f32 Seconds = std::chrono::duration<f32, std::ratio<1>>( m_MeasureEnd - m_MeasureStart ).count();
+    u32 Frames = (u32)m_FrameTimes.size();
+
+    fprintf( pFile, "{\n" );
+    fprintf( pFile, "  \"gdf\": " );
+    WriteString( pFile, pszGDF );
+    fprintf( pFile, ",\n" );
+    fprintf( pFile, "  \"frames\": %u,\n", Frames );
+    fprintf( pFile, "  \"warmupFrames\": %u,\n", m_WarmupFrames );
+    fprintf( pFile, "  \"deltaTime\": %.6f,\n", m_DeltaTime );
+    fprintf( pFile, "  \"threads\": %u,\n", TaskManager::getInstance().GetNumberOfThreads() );
+    fprintf( pFile, "  \"seed\": %u,\n", m_Seed );
+    fprintf( pFile, "  \"seconds\": %.4f,\n", Seconds );
+    fprintf( pFile, "  \"framesPerSecond\": %.2f,\n", Seconds > 0.0f ? Frames / Seconds : 0.0f );
+    fprintf( pFile, "  \"droppedSteps\": %llu,\n", (unsigned long long)(m_DroppedStepsEnd - m_DroppedStepsStart) );
+
+    // The totals are taken after the first measured frame, the heap blocks should stay at 0.
+    f32 ArenaFrames = (f32)std::max( Frames, 2u ) - 1.0f;
+    fprintf( pFile, "  \"frameArena\": { \"bytesPerFrame\": %.1f, \"heapBlocksPerFrame\": %.3f },\n",
+             (f32)(m_ArenaBytesEnd - m_ArenaBytesStart) / ArenaFrames,
+             (f32)(m_ArenaBlocksEnd - m_ArenaBlocksStart) / ArenaFrames );
+    fprintf( pFile, "  \"frameMs\": " );
+    WriteTimes( pFile, m_FrameTimes );
+    fprintf( pFile, ",\n  \"systemMs\": {" );
+
+    pcstr pszSeparator = "\n";
+    for ( auto& System : m_SystemTimes )
+    {
+        fprintf( pFile, "%s    ", pszSeparator );
+        WriteString( pFile, System.first.c_str() );
+        fprintf( pFile, ": " );
+        WriteTimes( pFile, System.second );
+        pszSeparator = ",\n";
+    }
+    fprintf( pFile, "\n  }\n}\n" );
+
+    if ( pFile != stdout )
+    {
+        fclose( pFile );
+        std::clog << "Benchmark wrote the report to " << m_sOutput << std::endl;
+    }
+    else
+    {
+        fflush( pFile );
+    }
+
+    return Errors::Success;
+}
@@ -0,0 +1,117 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// <summary>
+///   Runs a scene headless for a fixed number of frames and reports the frame and system
+///   timings as JSON.
+/// </summary>
+/// <remarks>
+///   Turned on with Benchmark::Enabled.  The systems listed in Benchmark::NullSystems are
+///   replaced by stand-ins, so no window or device is needed.  Every frame advances by
+///   Benchmark::DeltaTime and rand() is seeded with Benchmark::Seed.  The first
+///   Benchmark::WarmupFrames frames are not measured, then Benchmark::Frames are.  The thread
+///   count is fixed with TaskManager::Threads.  The report is written to Benchmark::Output,
+///   or to the standard output if it is not set.
+/// </remarks>
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class Benchmark
+{
+public:
+
+    typedef std::chrono::high_resolution_clock::time_point TimePoint;
+
+    /// <summary>
+    ///   Constructor, reads the settings from the environment.
+    /// </summary>
+    Benchmark( void );
+
+    /// <summary>
+    ///   Returns True if benchmarking is turned on in the environment.
+    /// </summary>
+    static Bool IsEnabled( void );
+
+    /// <summary>
+    ///   Returns True if the system should be replaced by a NullSystem.
+    /// </summary>
+    /// <param name="pszSystemType">The type name of the system in the GDF.</param>
+    static Bool IsNullSystem( pcstr pszSystemType );
+
+    /// <summary>
+    ///   Gets the number of frames to run, including the warmup frames.
+    /// </summary>
+    u32 GetFrames( void ) const
+    {
+        return m_WarmupFrames + m_Frames;
+    }
+
+    f32 GetDeltaTime( void ) const
+    {
+        return m_DeltaTime;
+    }
+
+    u32 GetSeed( void ) const
+    {
+        return m_Seed;
+    }
+
+    /// <summary>
+    ///   Records the timings of an executed frame.
+    /// </summary>
+    /// <param name="FrameStart">The time the frame started.</param>
+    /// <param name="FrameEnd">The time the frame ended.</param>
+    /// <param name="pScheduler">The scheduler that executed the frame.</param>
+    void RecordFrame( TimePoint FrameStart, TimePoint FrameEnd, const Scheduler* pScheduler );
+
+    /// <summary>
+    ///   Writes the report of the measured frames.
+    /// </summary>
+    /// <param name="pszGDF">The GDF that was run.</param>
+    /// <returns>An error code.</returns>
+    Error WriteReport( pcstr pszGDF );
+
+
+protected:
+
+    u32                                 m_Frames;
+    u32                                 m_WarmupFrames;
+    f32                                 m_DeltaTime;
+    u32                                 m_Seed;
+    std::string                         m_sOutput;
+
+    u32                                 m_ExecutedFrames;
+    TimePoint                           m_MeasureStart;
+    TimePoint                           m_MeasureEnd;
+    u64                                 m_DroppedStepsStart;
+    u64                                 m_DroppedStepsEnd;
+
+    // Totals of the frame arenas after the first and the last measured frame.
+    u64                                 m_ArenaBytesStart;
+    u64                                 m_ArenaBytesEnd;
+    u64                                 m_ArenaBlocksStart;
+    u64                                 m_ArenaBlocksEnd;
+
+    // Frame times and update times of each system in milliseconds.
+    std::vector<f32>                    m_FrameTimes;
+    std::map<std::string, std::vector<f32>> m_SystemTimes;
+    std::vector<Scheduler::SystemTime>  m_LastSystemTimes;
+};
@@ -19,15 +19,45 @@
 #include "Interfaces/Interface.hpp"
 // Standard library
 #include <algorithm>
+#include <cstdlib>
 #include <utility>
 #include <iostream>
 #include <thread>
 // Framework
 #include "Framework/ChangeControlManager.hpp"
+#include "Framework/EnvironmentManager.hpp"
 #include "Framework/TaskManager.hpp"
 #include "Framework/PlatformManager.hpp"
+#include "Framework/Instrumentation.hpp"
 
-__thread_local ChangeManager::NotifyList* ChangeManager::m_tlsNotifyList = nullptr;
+__thread_local ChangeManager::ThreadNotifyList* ChangeManager::m_tlsNotifyLists[ ChangeManager::MaxChangeManagers ] = { nullptr };
+std::atomic<u32> ChangeManager::sm_usedTlsSlots( 0 );
+std::atomic<u32> ChangeManager::sm_nextTlsGeneration( 0 );
+__thread_local u32 ChangeManager::m_tlsGenerations[ ChangeManager::MaxChangeManagers ] = { 0 };
+__thread_local u32 ChangeManager::m_tlsDistributedBuffer[ ChangeManager::MaxChangeManagers ] = { 0 };
+
+///////////////////////////////////////////////////////////////////////////////
+// GetOwnerTypes - Returns the system owning a subject, all systems if the subject
+//                 is not a system object or scene
+static System::Types::BitMask
+GetOwnerTypes(
+    ISubject* pSubject
+    )
+{
+    ISystemObject* pSystemObject = dynamic_cast<ISystemObject*>( pSubject );
+    if( pSystemObject )
+    {
+        return pSystemObject->GetSystemType();
+    }
+
+    ISystemScene* pSystemScene = dynamic_cast<ISystemScene*>( pSubject );
+    if( pSystemScene )
+    {
+        return pSystemScene->GetSystemType();
+    }
+
+    return System::Types::All;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 // ChangeManager - Default constructor 
@@ -35,7 +65,31 @@ ChangeManager::ChangeManager(
     void
     )
     : m_lastID(0)
+    , m_unusedObservers(0)
+    , m_pNotifyLists(nullptr)
+    , m_tlsSlot(AcquireTlsSlot())
+    , m_tlsGeneration(++sm_nextTlsGeneration)
+    , m_chunkSize(0)
+    , m_arenaChunks(0)
+    , m_arenaUsed(0)
+    , m_threads(0)
+    , m_overflowChunks(0)
+    , m_highWaterMark(0)
+    , m_writeBuffer(0)
+    , m_bufferCount(1)
+    , m_dirtyCount(0)
+    , m_dirtyCapacity(0)
+    , m_exclusiveTypes(0)
 {
+    if( m_tlsSlot >= MaxChangeManagers )
+    {
+        // More managers are alive than the thread local tables have room for, going on
+        // would write past their end
+        std::cerr << "ChangeManager::ChangeManager - more than MaxChangeManagers managers alive" << std::endl;
+        ASSERT( False );
+        std::abort();
+    }
+
     // Get ready to process changes in the main (this) thread
     InitThreadLocalData(this);
 }
@@ -47,24 +101,91 @@ ChangeManager::~ChangeManager(
     void
     )
 {
-    // Loop through all the subjects and their observers and clean up 
-    SubjectsList::iterator it;
-    for( it = m_subjectsList.begin(); it != m_subjectsList.end(); ++it )
+    // Loop through all the subjects and their observers and clean up, from the back so
+    // Unregister does not move the observers still to go
+    for( auto &si : m_subjectsList )
     {
-        if ( it->m_pSubject )
+        ISubject* pSubject = si.m_pSubject;
+        while( pSubject && si.m_pSubject == pSubject && si.m_observerCount )
         {
-            ObserversList &observersList = it->m_observersList;
+            Unregister( pSubject, m_observers[ si.m_firstObserver + si.m_observerCount - 1 ].m_pObserver );
+        }
+    }
+
+    // Free tls (thread local storage) data
+    FreeThreadLocalData(this);
 
-            ObserversList::iterator obsIt;
-            for( obsIt = observersList.begin(); obsIt != observersList.end(); ++obsIt )
+    // Free the notification lists of all threads and the chunks which did not fit into the arena
+    ThreadNotifyList* pList = m_pNotifyLists.load( std::memory_order_acquire );
+    while( pList )
+    {
+        for( u32 i = 0; i < MaxBuffers; ++i )
+        {
+            NotifyChunk* pChunk = pList->m_queues[ i ].m_pHead.load( std::memory_order_relaxed );
+            while( pChunk )
             {
-                Unregister(it->m_pSubject, obsIt->m_pObserver);
+                NotifyChunk* pNext = pChunk->m_pNext.load( std::memory_order_relaxed );
+                if( pChunk->m_bOverflow )
+                {
+                    delete [] pChunk->m_pNotifications;
+                    delete pChunk;
+                }
+                pChunk = pNext;
             }
         }
+
+        ThreadNotifyList* pNext = pList->m_pNext;
+        delete pList;
+        pList = pNext;
     }
 
-    // Free tls (thread local storage) data
-    FreeThreadLocalData(this);
+    // Hand the slot to the next manager, threads drop what they kept in it by its generation
+    sm_usedTlsSlots.fetch_and( ~(1u << m_tlsSlot) );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AcquireTlsSlot - Take a free slot of the thread local tables, MaxChangeManagers if
+//                  none is left
+u32
+ChangeManager::AcquireTlsSlot(
+    void
+    )
+{
+    u32 used = sm_usedTlsSlots.load();
+    for(;;)
+    {
+        u32 slot = 0;
+        while( slot < MaxChangeManagers && (used & (1u << slot)) )
+        {
+            ++slot;
+        }
+        if( slot == MaxChangeManagers )
+        {
+            return MaxChangeManagers;
+        }
+        if( sm_usedTlsSlots.compare_exchange_weak( used, used | (1u << slot) ) )
+        {
+            return slot;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ValidateThreadLocalData - Drop the thread local data the calling thread kept for an
+//                           earlier manager with the same slot
+void
+ChangeManager::ValidateThreadLocalData(
+    void
+    ) const
+{
+    if( m_tlsGenerations[ m_tlsSlot ] != m_tlsGeneration )
+    {
+        m_tlsGenerations[ m_tlsSlot ] = m_tlsGeneration;
+        m_tlsNotifyLists[ m_tlsSlot ] = nullptr;
+        m_tlsDistributedBuffer[ m_tlsSlot ] = 0;
+    }
 }
 
 
@@ -83,7 +204,7 @@ ChangeManager::Register(
     if( pInSubject || pInObserver )
     {
         // Lock out updates while we register a subjext
-        std::lock_guard<std::mutex> lock(m_UpdateMutex);
+        std::lock_guard<SharedMutex> lock(m_UpdateMutex);
 
         std::uint32_t uID = pInSubject->GetID(this);
 
@@ -97,7 +218,8 @@ ChangeManager::Register(
             }
             else
             {
-                si.m_observersList.push_back( ObserverRequest(pInObserver, observerIntrestBits, observerIdBits) );
+                AddObserver( si, ObserverRequest(pInObserver, observerIntrestBits, observerIdBits) );
+                UpdateObserverTypes( si );
                 observerIntrestBits &= ~si.m_interestBits;
                 if( observerIntrestBits )
                 {
@@ -130,8 +252,10 @@ ChangeManager::Register(
             }
             SubjectInfo &si = m_subjectsList[uID];
             si.m_pSubject = pInSubject;
-            si.m_observersList.push_back( ObserverRequest(pInObserver, observerIntrestBits, observerIdBits) );
+            AddObserver( si, ObserverRequest(pInObserver, observerIntrestBits, observerIdBits) );
             si.m_interestBits = observerIntrestBits;
+            si.m_ownerTypes = GetOwnerTypes( pInSubject );
+            UpdateObserverTypes( si );
 
             pInSubject->Attach(this, observerIntrestBits, uID);
         }
@@ -157,7 +281,7 @@ ChangeManager::Unregister(
 
     if( pInSubject || pInObserver )
     {
-        std::lock_guard<std::mutex> lock(m_UpdateMutex);
+        std::lock_guard<SharedMutex> lock(m_UpdateMutex);
 
         u32 uID = pInSubject->GetID(this);
         if ( m_subjectsList.size() <= uID  ||  m_subjectsList[uID].m_pSubject != pInSubject )
@@ -166,13 +290,18 @@ ChangeManager::Unregister(
             return Errors::Failure;
         }
 
-        ObserversList &observersList = m_subjectsList[uID].m_observersList;
-        auto itObs = std::find( observersList.begin(), observersList.end(), pInObserver );
+        SubjectInfo &si = m_subjectsList[uID];
+        ObserverRequest* pFirst = m_observers.data() + si.m_firstObserver;
+        ObserverRequest* pLast = pFirst + si.m_observerCount;
+        ObserverRequest* pObs = std::find( pFirst, pLast, pInObserver );
 
-        if( itObs != observersList.end() )
+        if( pObs != pLast )
         {
-            observersList.erase(itObs);
-            if( observersList.empty() )
+            // The range keeps its capacity for the next observers
+            std::copy( pObs + 1, pLast, pObs );
+            si.m_observerCount--;
+            UpdateObserverTypes( si );
+            if( si.m_observerCount == 0 )
             {
                 m_subjectsList[uID].m_pSubject = nullptr;
                 m_freeIDsList.push_back(uID);
@@ -201,7 +330,7 @@ ChangeManager::RemoveSubject (
     ObserversList observersList;
     // create a block to scope a lock
     {
-        std::lock_guard<std::mutex> lock(m_UpdateMutex);
+        std::lock_guard<SharedMutex> lock(m_UpdateMutex);
 
         u32 uID = pSubject->GetID(this);
         if( uID == CSubject::InvalidID)
@@ -213,7 +342,9 @@ ChangeManager::RemoveSubject (
             std::cerr << "ChangeManager::RemoveSubject - m_subjectsList[uID].m_pSubject != pSubject" << std::endl;
             return Errors::Failure;
         }
-        observersList = m_subjectsList[uID].m_observersList;
+        const SubjectInfo &si = m_subjectsList[uID];
+        observersList.assign( m_observers.begin() + si.m_firstObserver,
+                              m_observers.begin() + si.m_firstObserver + si.m_observerCount );
         m_subjectsList[uID].m_pSubject = nullptr;
         m_freeIDsList.push_back(uID);
         curError = Errors::Success;
@@ -253,17 +384,76 @@ ChangeManager::ChangeOccurred(
         else
         {
             // Get thread local notification list
-            NotifyList* notifyList = this->m_tlsNotifyList;
-            
+            NotifyQueue& queue = GetThreadNotifyList()->m_queues[ GetPostBuffer() ];
+
             // IMPLEMENTATION NOTE
-            // Don't check for duplicate instertions
+            // Duplicates are only collapsed per thread
             //
             // For the sake of performance and scalability don't do any operations 
-            // that may require locks (requesting ID or checking shared data structures).
-            // Frequent locking hurts incomparably more than even high percentage 
-            // of duplicated insertions, especially taking into account that the memory 
-            // is preallocated most of the time.
-            notifyList->push_back( Notification(pInChangedSubject, uInChangedBits) );
+            // that may require shared locks (checking shared data structures).
+            // Each thread remembers the notification it queued for a subject and adds
+            // later changes to its bits, so a subject posting several changes is queued
+            // once.  Duplicates across threads are combined by DistributeQueuedChanges.
+            u32 uID = pInChangedSubject->GetID(this);
+            if( uID != CSubject::InvalidID )
+            {
+                if( uID >= queue.m_dirty.size() )
+                {
+                    NotifyQueue::DirtyEntry empty = { 0, nullptr };
+                    queue.m_dirty.resize( std::max<size_t>( uID + 1, queue.m_dirty.size() * 2 ), empty );
+                }
+
+                NotifyQueue::DirtyEntry &dirty = queue.m_dirty[ uID ];
+                if( dirty.m_generation == queue.m_generation )
+                {
+                    // The bits can only be added while no one took them and no system got the
+                    // notification ahead of time, otherwise queue a new notification
+                    Notification &notif = *dirty.m_pNotification;
+                    if( notif.m_deliveredTypes.load() == System::Types::Null &&
+                        notif.m_changedBits.fetch_or( uInChangedBits ) != 0 &&
+                        notif.m_deliveredTypes.load() == System::Types::Null )
+                    {
+                        return Errors::Success;
+                    }
+                }
+            }
+
+            // Only this thread appends to its queue, the readers see the
+            // notification once the chunk's count is published.
+            NotifyChunk* pChunk = queue.m_pTail;
+            if( pChunk == nullptr )
+            {
+                pChunk = AllocateChunk();
+                queue.m_pTail = pChunk;
+                queue.m_pHead.store( pChunk, std::memory_order_release );
+            }
+
+            u32 count = pChunk->m_count.load( std::memory_order_relaxed );
+            if( count == m_chunkSize )
+            {
+                // Continue with the chunk kept from an earlier frame or add a new one
+                NotifyChunk* pNext = pChunk->m_pNext.load( std::memory_order_relaxed );
+                if( pNext == nullptr )
+                {
+                    pNext = AllocateChunk();
+                    pChunk->m_pNext.store( pNext, std::memory_order_release );
+                }
+                pChunk = pNext;
+                queue.m_pTail = pChunk;
+                count = 0;
+            }
+
+            Notification &notif = pChunk->m_pNotifications[ count ];
+            notif.m_pSubject = pInChangedSubject;
+            notif.m_changedBits.store( uInChangedBits, std::memory_order_relaxed );
+            notif.m_deliveredTypes.store( System::Types::Null, std::memory_order_relaxed );
+            pChunk->m_count.store( count + 1, std::memory_order_release );
+
+            if( uID != CSubject::InvalidID )
+            {
+                NotifyQueue::DirtyEntry dirty = { queue.m_generation, &notif };
+                queue.m_dirty[ uID ] = dirty;
+            }
             curError = Errors::Success;           
         }
     }
@@ -280,56 +470,214 @@ ChangeManager::DistributeQueuedChanges(
     System::Changes::BitMask ChangesToDist
     )
 {
-    // Store the parameters so they can be used by multiple threads later
-    m_systems2BeNotified = systems2BeNotified;
-    m_ChangesToDist = ChangesToDist;
+    return Distribute( m_writeBuffer.load( std::memory_order_relaxed ), systems2BeNotified, ChangesToDist );
+}
 
-    // Loop through all the notifications.  We might need to loop through multiple
-    // times because processing notifications might generate more notifications
-    for(;;)
+
+///////////////////////////////////////////////////////////////////////////////
+// SetBufferCount - Set the number of notification buffers
+void
+ChangeManager::SetBufferCount(
+    u32 Count
+    )
+{
+    if( Count == 0 || Count > MaxBuffers )
     {
-        // Make sure m_indexList is big enough to hold all subjects
-        m_indexList.resize( m_subjectsList.size() );
+        std::cerr << "ChangeManager::SetBufferCount - Count == 0 || Count > MaxBuffers" << std::endl;
+        Count = (Count == 0) ? 1 : MaxBuffers;
+    }
+
+    m_bufferCount = Count;
+    m_writeBuffer.store( 0, std::memory_order_relaxed );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SwapBuffers - Close the buffer changes are posted to and continue with the next one
+u32
+ChangeManager::SwapBuffers(
+    System::Types::BitMask& Systems,
+    System::Changes::BitMask& Changes
+    )
+{
+    u32 Buffer = m_writeBuffer.load( std::memory_order_relaxed );
+    m_writeBuffer.store( (Buffer + 1) % m_bufferCount, std::memory_order_relaxed );
 
-        // Loop through all list and build m_cumulativeNotifyList
-        for(const auto &pList : m_NotifyLists)
+    Systems = System::Types::Null;
+    Changes = System::Changes::None;
+
+    SharedMutex::SharedLock lock( m_UpdateMutex );
+    for( ThreadNotifyList* pList = m_pNotifyLists.load( std::memory_order_acquire ); pList; pList = pList->m_pNext )
+    {
+        ForEachQueued( pList->m_queues[ Buffer ], False, [&] ( Notification& notif )
         {
-            for(const auto &notif : *pList)
+            auto uID = notif.m_pSubject->GetID(this);
+            if( uID != CSubject::InvalidID )
             {
-                // Get subject for notification
-                auto uID = notif.m_pSubject->GetID(this);
-                if( uID == CSubject::InvalidID )
-                {
-#if 0	
-					std::cerr << "ChangeManager::DistributeQueuedChanges - uID == CSubject::InvalidID" << std::endl;
-#endif
-                }
-                else
-                {
-                    // Get the index for this subject
-                    auto index = m_indexList[uID];
+                const SubjectInfo &subject = m_subjectsList[ uID ];
+                Systems |= subject.m_ownerTypes | subject.m_observerTypes;
+                Changes |= notif.m_changedBits.load( std::memory_order_relaxed );
+            }
+        } );
+    }
 
-                    // If index is set, then this subject is already part of the m_cumulativeNotifyList
-                    if( index )
-                    {
-                        // Each subject only needs to be notified once for all changes
-                        // so let's combine all notifications for this subject
-                        m_cumulativeNotifyList[ index ].m_changedBits |= notif.m_changedBits;
-                    }
-                    else
-                    {
-                        // Set the index for this subject
-                        m_indexList[uID] = (std::uint32_t)m_cumulativeNotifyList.size();
+    return Buffer;
+}
 
-                        // Add a new entry to m_cumulativeNotifyList
-                        m_cumulativeNotifyList.push_back( MappedNotification(uID, notif.m_changedBits) );
-                    }
-                }
-            }
 
-            // Clear out this list
-            pList->clear();
+///////////////////////////////////////////////////////////////////////////////
+// DistributeBufferedChanges - Distribute the notifications of a closed buffer
+Error
+ChangeManager::DistributeBufferedChanges(
+    u32 Buffer
+    )
+{
+    return Distribute( Buffer, System::Types::All, System::Changes::All );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GetPostBuffer - Get the buffer the current thread posts changes to
+u32
+ChangeManager::GetPostBuffer(
+    void
+    ) const
+{
+    ValidateThreadLocalData();
+
+    u32 distributedBuffer = m_tlsDistributedBuffer[ m_tlsSlot ];
+    return distributedBuffer ? distributedBuffer - 1 : m_writeBuffer.load( std::memory_order_relaxed );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// UpdateObserverTypes - Recalculate the cumulative system types of the observers of a subject
+void
+ChangeManager::UpdateObserverTypes(
+    SubjectInfo& Subject
+    )
+{
+    Subject.m_observerTypes = 0;
+    for( u32 i = 0; i < Subject.m_observerCount; ++i )
+    {
+        const ObserverRequest &observer = m_observers[ Subject.m_firstObserver + i ];
+        if( observer.m_observerIdBits != System::Types::All )
+        {
+            Subject.m_observerTypes |= observer.m_observerIdBits;
+        }
+
+        // Registered for one system alone
+        if( observer.m_observerIdBits != 0 &&
+            (observer.m_observerIdBits & (observer.m_observerIdBits - 1)) == 0 )
+        {
+            m_exclusiveTypes |= observer.m_observerIdBits;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// HasExclusiveObserver - Check if an observer registered for one system alone is
+//                        interested in the changes of a subject
+Bool
+ChangeManager::HasExclusiveObserver(
+    const SubjectInfo& Subject,
+    System::Type SystemType,
+    u32 changedBits
+    ) const
+{
+    const ObserverRequest* obsList = m_observers.data() + Subject.m_firstObserver;
+    for( u32 j = 0; j != Subject.m_observerCount; ++j )
+    {
+        if( obsList[j].m_observerIdBits == SystemType &&
+            (obsList[j].m_interestBits & changedBits) )
+        {
+            return True;
+        }
+    }
+    return False;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AddObserver - Append an observer to the range of a subject
+void
+ChangeManager::AddObserver(
+    SubjectInfo& Subject,
+    const ObserverRequest& Request
+    )
+{
+    // Only called under m_UpdateMutex.  The distributions read the table under a shared
+    // lock, so it is free to move here.
+    if( Subject.m_observerCount == Subject.m_observerCapacity )
+    {
+        // Move the range to the end with room to grow, its old slots are left behind
+        u32 capacity = std::max<u32>( 4, Subject.m_observerCapacity * 2 );
+        u32 first = (u32)m_observers.size();
+        m_observers.resize( first + capacity );
+        std::copy( m_observers.begin() + Subject.m_firstObserver,
+                   m_observers.begin() + Subject.m_firstObserver + Subject.m_observerCount,
+                   m_observers.begin() + first );
+
+        m_unusedObservers += Subject.m_observerCapacity;
+        Subject.m_firstObserver = first;
+        Subject.m_observerCapacity = capacity;
+
+        if( m_unusedObservers > m_observers.size() / 2 )
+        {
+            CompactObservers();
         }
+    }
+
+    m_observers[ Subject.m_firstObserver + Subject.m_observerCount++ ] = Request;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CompactObservers - Drop the slots left behind by moved ranges
+void
+ChangeManager::CompactObservers(
+    void
+    )
+{
+    // Lay the ranges out in subject ID order, as the changes are grouped
+    ObserversList observers;
+    observers.reserve( m_observers.size() - m_unusedObservers );
+    for( auto &si : m_subjectsList )
+    {
+        u32 first = (u32)observers.size();
+        observers.insert( observers.end(),
+                          m_observers.begin() + si.m_firstObserver,
+                          m_observers.begin() + si.m_firstObserver + si.m_observerCapacity );
+        si.m_firstObserver = first;
+    }
+
+    m_observers.swap( observers );
+    m_unusedObservers = 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Distribute - Distribute the queued notifications of one buffer to the proper observers
+Error
+ChangeManager::Distribute(
+    u32 Buffer,
+    System::Types::BitMask systems2BeNotified,
+    System::Changes::BitMask ChangesToDist
+    )
+{
+    Instrumentation::Scope scope( "DistributeQueuedChanges", "ChangeManager" );
+
+    // Store the parameters so they can be used by multiple threads later
+    m_systems2BeNotified = systems2BeNotified;
+    m_ChangesToDist = ChangesToDist;
+
+    // Loop through all the notifications.  We might need to loop through multiple
+    // times because processing notifications might generate more notifications
+    for(;;)
+    {
+        // Combine the notifications of all threads into m_cumulativeNotifyList
+        CollectQueuedChanges( Buffer );
 
         // Determine number of notifications to process
         size_t NumberOfChanges = m_cumulativeNotifyList.size();
@@ -340,38 +688,200 @@ ChangeManager::DistributeQueuedChanges(
             break;
         }
 
-        // If we have a task manager and there are more than 50 notifications to process, let's do it parallel
-        static const u32 GrainSize = 50;
-        /*if( !m_pTaskManager && (u32)NumberOfChanges > GrainSize )
-        {
-            // Process noticitions in parallel
-            m_pTaskManager->ParallelFor( nullptr, DistributionCallback, this, 0, (u32)NumberOfChanges, GrainSize );
-        }
-        else*/
+        // Group the changes by observer
+        m_batches.Clear();
         {
-            // Not enough notifications to worry about running in parallel, just distribute in this thread
-            DistributeRange( 0, (u32)NumberOfChanges );
+            SharedMutex::SharedLock lock( m_UpdateMutex );
+            for(auto &notif : m_cumulativeNotifyList)
+            {
+                SubjectInfo &subject = m_subjectsList[ notif.m_subjectID ];
+
+                // Distribute any desired changes
+                u32 activeChanges = notif.m_changedBits & m_ChangesToDist;
+                if( activeChanges )
+                {
+                    // Clear the bit for the changes we are distributing
+                    notif.m_changedBits &= ~activeChanges;
+
+                    // Loop through all the observers and queue the notification for them
+                    const ObserverRequest* obsList = m_observers.data() + subject.m_firstObserver;
+                    for( u32 j = 0; j != subject.m_observerCount; ++j )
+                    {
+                        // Determine if this observe is interested in this notification
+                        u32 changesToSend = obsList[j].m_interestBits & activeChanges;
+
+                        // If this observer is part of the systems to be notified and did not receive
+                        // the notification ahead of its system's update then we can pass it this notification
+                        if( changesToSend &&
+                            (obsList[j].m_observerIdBits & m_systems2BeNotified) &&
+                            (obsList[j].m_observerIdBits & ~notif.m_deliveredTypes) )
+                        {
+                            m_batches.Add( obsList[j].m_pObserver, subject.m_pSubject, changesToSend );
+                        }
+                    }
+                }
+            }
         }
 
+        // Have the observers process their notifications
+        m_batches.Build();
+        DeliverBatches( m_batches, Buffer );
+
         // Check if we are distributing all the notifications
         if( m_ChangesToDist == System::Changes::All )
         {
             // If we are distributing all the notifications, clear out m_cumulativeNotifyList
             m_cumulativeNotifyList.clear();
-            m_indexList.clear();
         }
         else
         {
-            // Some of the notifications might need to be distributed later
-            // Keep m_cumulativeNotifyList and exit the loop
+            // Some of the notifications might need to be distributed later,
+            // put their remaining bits back and exit the loop
+            for(const auto &notif : m_cumulativeNotifyList)
+            {
+                if( notif.m_changedBits )
+                {
+                    MarkDirty( notif.m_subjectID, notif.m_changedBits, notif.m_deliveredTypes );
+                }
+            }
+            m_cumulativeNotifyList.clear();
             break;
         }
     }
 
+    // All notifications of the buffer are delivered, keep the chunks for the next frames
+    if( m_ChangesToDist == System::Changes::All )
+    {
+        RecycleQueues( Buffer );
+    }
+
     return Errors::Success;
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// DistributeQueuedChangesToSystem - Deliver the queued notifications to the observers of 
+//                                   one system ahead of the regular distribution
+Error
+ChangeManager::DistributeQueuedChangesToSystem(
+    System::Type SystemType
+    )
+{
+    Instrumentation::Scope scope( "DistributeQueuedChangesToSystem", "ChangeManager" );
+
+    // Collect all notifications which were not yet delivered to this system.  Other systems
+    // might still post changes and collect their own at the same time.  Only notifications
+    // handed to an observer of this system alone are marked as delivered, the others are
+    // still coalesced when posted and reduced through the dirty set.
+    MappedNotifyList notifyList;
+    u32 Buffer = m_writeBuffer.load( std::memory_order_relaxed );
+    {
+        SharedMutex::SharedLock lock( m_UpdateMutex );
+        if( (m_exclusiveTypes & SystemType) == 0 )
+        {
+            return Errors::Success;
+        }
+
+        for( ThreadNotifyList* pList = m_pNotifyLists.load( std::memory_order_acquire ); pList; pList = pList->m_pNext )
+        {
+            ForEachQueued( pList->m_queues[ Buffer ], False, [&] ( Notification& notif )
+            {
+                auto uID = notif.m_pSubject->GetID(this);
+                if( uID == CSubject::InvalidID ||
+                    !HasExclusiveObserver( m_subjectsList[ uID ], SystemType, notif.m_changedBits.load() ) )
+                {
+                    return;
+                }
+
+                // Marking the notification has to be ordered with the thread adding bits to it
+                if( (notif.m_deliveredTypes.fetch_or( SystemType ) & SystemType) == 0 )
+                {
+                    u32 changedBits = notif.m_changedBits.load();
+                    if( changedBits )
+                    {
+                        notifyList.push_back( MappedNotification(uID, changedBits) );
+                    }
+                }
+            } );
+        }
+    }
+
+    if( notifyList.empty() )
+    {
+        return Errors::Success;
+    }
+
+    // Each subject only needs to be notified once for all changes
+    std::sort( notifyList.begin(), notifyList.end(),
+        [] ( const MappedNotification& lhs, const MappedNotification& rhs ) { return lhs.m_subjectID < rhs.m_subjectID; } );
+
+    // Other systems may be distributing their changes at the same time, so use batches of our own
+    ObserverBatches batches;
+
+    {
+        SharedMutex::SharedLock lock( m_UpdateMutex );
+        size_t i = 0;
+        while( i < notifyList.size() )
+        {
+            u32 uID = notifyList[ i ].m_subjectID;
+            u32 changedBits = 0;
+            for( ; i < notifyList.size() && notifyList[ i ].m_subjectID == uID; ++i )
+            {
+                changedBits |= notifyList[ i ].m_changedBits;
+            }
+
+            // Let the observers which belong to this system only process the notification
+            SubjectInfo &subject = m_subjectsList[ uID ];
+            const ObserverRequest* obsList = m_observers.data() + subject.m_firstObserver;
+            for( u32 j = 0; j != subject.m_observerCount; ++j )
+            {
+                u32 changesToSend = obsList[j].m_interestBits & changedBits;
+                if( changesToSend &&
+                    (obsList[j].m_observerIdBits & SystemType) &&
+                    (obsList[j].m_observerIdBits & ~SystemType) == 0 )
+                {
+                    batches.Add( obsList[j].m_pObserver, subject.m_pSubject, changesToSend );
+                }
+            }
+        }
+    }
+
+    batches.Build();
+    DeliverBatches( batches, Buffer );
+
+    return Errors::Success;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// DeliverBatches - Hand each observer its batch of changes
+void
+ChangeManager::DeliverBatches(
+    ObserverBatches& Batches,
+    u32 Buffer
+    )
+{
+    u32 NumberOfChanges = (u32)Batches.m_changes.size();
+    if( NumberOfChanges == 0 )
+    {
+        return;
+    }
+
+    // If there are changes for more than one observer, let's do it parallel, ParallelFor
+    // keeps the pieces big enough to pay off
+    if( NumberOfChanges > 1 && Batches.m_observers.size() > 1 )
+    {
+        DistributionRange range = { this, &Batches, Buffer };
+        TaskManager::getInstance().ParallelForSite( this, DistributionCallback, &range, 0, NumberOfChanges );
+    }
+    else
+    {
+        // Not enough changes to worry about running in parallel, just distribute in this thread
+        DistributeRange( Batches, Buffer, 0, NumberOfChanges );
+    }
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // DistributionCallback - This callback is used to divide notifications 
 //                        distribution among multiple threads
@@ -383,53 +893,106 @@ ChangeManager::DistributionCallback(
     )
 {
     // Process the given range (this will be called from multiple threads)
-    ChangeManager* pMgr = static_cast<ChangeManager*>(param);
-    pMgr->DistributeRange( begin, end );
+    DistributionRange* pRange = static_cast<DistributionRange*>(param);
+    pRange->m_pMgr->DistributeRange( *pRange->m_pBatches, pRange->m_buffer, begin, end );
 }
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// DistributeRange - Process queued notifications for the given range
+// DistributeRange - Deliver the batches starting in the given range of changes
 void 
 ChangeManager::DistributeRange( 
+    ObserverBatches& Batches,
+    u32 Buffer,
     u32 begin, 
     u32 end 
     )
 {
-    // Loop through all the noticatiosn in the given range
-    for ( size_t i = begin; i < end; ++i )
+    // Changes posted by the observers belong to the buffer being distributed
+    ValidateThreadLocalData();
+    u32 &distributedBuffer = m_tlsDistributedBuffer[ m_tlsSlot ];
+    u32 previousBuffer = distributedBuffer;
+    distributedBuffer = Buffer + 1;
+
+    // Each batch is delivered by the range its first change falls into, so no
+    // observer is entered by more than one thread
+    const std::vector<u32> &offsets = Batches.m_offsets;
+    auto itLast = offsets.end() - 1;
+    auto itBatch = std::lower_bound( offsets.begin(), itLast, begin );
+    for( ; itBatch != itLast && *itBatch < end; ++itBatch )
     {
-        // Get the notification and the subject
-        MappedNotification &notif = m_cumulativeNotifyList[ i ];
-        SubjectInfo &subject = m_subjectsList[ notif.m_subjectID ];
+        IObserver* pObserver = Batches.m_observers[ itBatch - offsets.begin() ];
+        pObserver->ChangesOccurred( &Batches.m_changes[ *itBatch ], itBatch[ 1 ] - itBatch[ 0 ] );
+    }
 
-        // Distribute any desired changes
-        u32 activeChanges = notif.m_changedBits & m_ChangesToDist;
-        if( activeChanges )
-        {
-            // Clear the bit for the changes we are distributing
-            notif.m_changedBits &= ~activeChanges;
+    distributedBuffer = previousBuffer;
+}
 
-            // Loop through all the observers and let them process the notifictaion
-            ObserversList &obsList = subject.m_observersList;
-            for( size_t j = 0; j != obsList.size(); ++j )
-            {
-                // Determine if this observe is interested in this notification
-                u32 changesToSend = obsList[j].m_interestBits & activeChanges;
-                if ( changesToSend )
-                {
-                    // If this observer is part of the systems to be notified then we can pass it this notification
-                    if( obsList[j].m_observerIdBits & m_systems2BeNotified )
-                    {
-                        // Have the observer process this change (notification)
-                        obsList[j].m_pObserver->ChangeOccurred(subject.m_pSubject, changesToSend);
-                    }
-                }
-            }
-        }
+
+///////////////////////////////////////////////////////////////////////////////
+// ObserverBatches::Add - Queue a change for an observer
+void
+ChangeManager::ObserverBatches::Add(
+    IObserver* pObserver,
+    ISubject* pSubject,
+    u32 changedBits
+    )
+{
+    auto it = m_batchIndex.insert( std::make_pair( pObserver, (u32)m_observers.size() ) );
+    if( it.second )
+    {
+        m_observers.push_back( pObserver );
+    }
+
+    Delivery delivery = { it.first->second, pSubject, changedBits };
+    m_deliveries.push_back( delivery );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ObserverBatches::Build - Arrange the queued changes into one batch per observer
+void
+ChangeManager::ObserverBatches::Build(
+    void
+    )
+{
+    // Count the changes per observer and turn the counts into offsets.  The
+    // changes keep the order they were queued in.
+    m_offsets.assign( m_observers.size() + 1, 0 );
+    for(const auto &delivery : m_deliveries)
+    {
+        m_offsets[ delivery.m_batch + 1 ]++;
+    }
+    for( size_t i = 1; i < m_offsets.size(); ++i )
+    {
+        m_offsets[ i ] += m_offsets[ i - 1 ];
+    }
+
+    std::vector<u32> cursors( m_offsets.begin(), m_offsets.end() - 1 );
+    m_changes.resize( m_deliveries.size() );
+    for(const auto &delivery : m_deliveries)
+    {
+        IObserver::Change &change = m_changes[ cursors[ delivery.m_batch ]++ ];
+        change.pSubject = delivery.m_pSubject;
+        change.ChangeType = delivery.m_changedBits;
     }
 }
 
+
+///////////////////////////////////////////////////////////////////////////////
+// ObserverBatches::Clear - Drop all queued changes
+void
+ChangeManager::ObserverBatches::Clear(
+    void
+    )
+{
+    m_batchIndex.clear();
+    m_deliveries.clear();
+    m_observers.clear();
+    m_offsets.clear();
+    m_changes.clear();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // InitThreadLocalData - Init thread specific data
 void
@@ -440,21 +1003,11 @@ ChangeManager::InitThreadLocalData(
     if( !arg )
     {
         std::cerr << "ChangeManager::InitThreadLocalData - No manager pointer passed to InitThreadLocalNotifyList" << std::endl;
+        return;
     }
+
     ChangeManager *mgr = (ChangeManager*)arg;
-    // Check if we have allocated a NotifyList for this thread.
-    // The notify list is keep in tls (thread local storage).
-    if( mgr->m_tlsNotifyList == nullptr)
-    {
-        mgr->m_tlsNotifyList = new NotifyList();
-        // Lock out the updates and add this NotifyList to m_NotifyLists
-        std::lock_guard<std::mutex> lock(mgr->m_UpdateMutex);
-        mgr->m_NotifyLists.push_back(mgr->m_tlsNotifyList);
-    }
-    else
-    {
-        std::clog << "Thread local data already initialized on thread " << std::this_thread::get_id() << std::endl;
-    }   
+    mgr->GetThreadNotifyList();
 }
 
 
@@ -468,15 +1021,405 @@ ChangeManager::FreeThreadLocalData(
     if( !arg )
     {
         std::cerr << "ChangeManager::FreeThreadLocalData - No manager pointer passed to FreeThreadLocalNotifyList" << std::endl;
+        return;
     }
     
     ChangeManager *mgr = (ChangeManager*)arg;
 
-    // Free tls (thread local storage) data
-    if ( mgr->m_tlsNotifyList != nullptr )
+    // The list stays registered so its notifications are still distributed,
+    // it is freed along with the change manager
+    m_tlsNotifyLists[ mgr->m_tlsSlot ] = nullptr;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GetThreadNotifyList - Get the notification list of the calling thread, registering
+//                       it on first use
+ChangeManager::ThreadNotifyList*
+ChangeManager::GetThreadNotifyList(
+    void
+    )
+{
+    // The notify list is keep in tls (thread local storage).
+    ValidateThreadLocalData();
+    ThreadNotifyList* &notifyList = m_tlsNotifyLists[ m_tlsSlot ];
+    if( notifyList == nullptr )
     {
-        // Free NotifyList if it exists
-        delete mgr->m_tlsNotifyList;
-        mgr->m_tlsNotifyList = nullptr;
+        notifyList = new ThreadNotifyList();
+
+        // Lists are only ever added, so they can be pushed without a lock
+        ThreadNotifyList* pHead = m_pNotifyLists.load( std::memory_order_relaxed );
+        do
+        {
+            notifyList->m_pNext = pHead;
+        }
+        while( !m_pNotifyLists.compare_exchange_weak( pHead, notifyList,
+                                                      std::memory_order_release, std::memory_order_relaxed ) );
+
+        m_threads.fetch_add( 1, std::memory_order_relaxed );
     }
-} 
+
+    return notifyList;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AllocateChunk - Take a chunk from the arena, or from the heap once it is used up
+ChangeManager::NotifyChunk*
+ChangeManager::AllocateChunk(
+    void
+    )
+{
+    // The arena is sized by the environment which is not available at construction
+    std::call_once( m_arenaOnce, [this] ()
+    {
+        m_chunkSize = std::max( EnvironmentManager::getInstance().Variables().GetAsInt( "ChangeManager::ChunkSize", 256 ), 1 );
+        m_arenaChunks = std::max( EnvironmentManager::getInstance().Variables().GetAsInt( "ChangeManager::ArenaChunks", 128 ), 0 );
+        m_arena.reset( new NotifyChunk[ m_arenaChunks ] );
+        m_arenaNotifications.reset( new Notification[ (size_t)m_arenaChunks * m_chunkSize ] );
+    } );
+
+    NotifyChunk* pChunk;
+    u32 index = m_arenaUsed.fetch_add( 1, std::memory_order_relaxed );
+    if( index < m_arenaChunks )
+    {
+        pChunk = &m_arena[ index ];
+        pChunk->m_pNotifications = &m_arenaNotifications[ (size_t)index * m_chunkSize ];
+        pChunk->m_bOverflow = False;
+    }
+    else
+    {
+        if( m_overflowChunks.fetch_add( 1, std::memory_order_relaxed ) == 0 )
+        {
+            std::clog << "ChangeManager::AllocateChunk - arena of " << m_arenaChunks
+                      << " chunks used up, consider raising ChangeManager::ArenaChunks" << std::endl;
+        }
+        pChunk = new NotifyChunk;
+        pChunk->m_pNotifications = new Notification[ m_chunkSize ];
+        pChunk->m_bOverflow = True;
+    }
+
+    pChunk->m_count.store( 0, std::memory_order_relaxed );
+    pChunk->m_pNext.store( nullptr, std::memory_order_relaxed );
+    return pChunk;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ForEachQueued - Call a function for each notification of a queue which was not
+//                 collected by DistributeQueuedChanges yet, optionally collecting them
+template<class Function>
+void
+ChangeManager::ForEachQueued(
+    NotifyQueue& Queue,
+    Bool bConsume,
+    Function Process
+    )
+{
+    NotifyChunk* pChunk = Queue.m_pReadChunk;
+    u32 index = Queue.m_readIndex;
+    if( pChunk == nullptr )
+    {
+        pChunk = Queue.m_pHead.load( std::memory_order_acquire );
+        index = 0;
+        if( pChunk == nullptr )
+        {
+            return;
+        }
+    }
+
+    for(;;)
+    {
+        u32 count = pChunk->m_count.load( std::memory_order_acquire );
+        for( ; index < count; ++index )
+        {
+            Process( pChunk->m_pNotifications[ index ] );
+        }
+
+        // The posting thread only moves on to the next chunk once this one is full
+        NotifyChunk* pNext = pChunk->m_pNext.load( std::memory_order_acquire );
+        if( count < m_chunkSize || pNext == nullptr )
+        {
+            break;
+        }
+        pChunk = pNext;
+        index = 0;
+    }
+
+    if( bConsume )
+    {
+        Queue.m_pReadChunk = pChunk;
+        Queue.m_readIndex = index;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CollectQueuedChanges - Combine the notifications of all threads into m_cumulativeNotifyList
+void
+ChangeManager::CollectQueuedChanges(
+    u32 Buffer
+    )
+{
+    // Make sure there are dirty bits for all subjects.  Subjects registered meanwhile have
+    // not posted changes yet, their IDs are handled by the next collection.
+    u32 subjects;
+    {
+        SharedMutex::SharedLock lock( m_UpdateMutex );
+        subjects = (u32)m_subjectsList.size();
+    }
+    if( subjects > m_dirtyCapacity )
+    {
+        u32 capacity = std::max( subjects, m_dirtyCapacity * 2 );
+        std::unique_ptr<std::atomic<u32>[]> dirtyBits( new std::atomic<u32>[ capacity ] );
+        std::unique_ptr<u32[]> dirtySubjects( new u32[ capacity ] );
+        for( u32 i = 0; i < capacity; ++i )
+        {
+            dirtyBits[ i ].store( i < m_dirtyCapacity ? m_dirtyBits[ i ].load( std::memory_order_relaxed ) : 0,
+                                  std::memory_order_relaxed );
+        }
+        std::copy( m_dirtySubjects.get(), m_dirtySubjects.get() + m_dirtyCount.load( std::memory_order_relaxed ),
+                   dirtySubjects.get() );
+
+        m_dirtyBits = std::move( dirtyBits );
+        m_dirtySubjects = std::move( dirtySubjects );
+        m_dirtyCapacity = capacity;
+    }
+
+    // Reduce the queues of all threads into the dirty bits, each queue is taken by one thread
+    m_collectQueues.clear();
+    for( ThreadNotifyList* pList = m_pNotifyLists.load( std::memory_order_acquire ); pList; pList = pList->m_pNext )
+    {
+        m_collectQueues.push_back( &pList->m_queues[ Buffer ] );
+    }
+
+    if( m_collectQueues.size() > 1 )
+    {
+        CollectRange range = { this, &m_collectQueues };
+        TaskManager::getInstance().ParallelForSite( this, CollectCallback, &range, 0, (u32)m_collectQueues.size() );
+    }
+    else
+    {
+        for(auto pQueue : m_collectQueues)
+        {
+            CollectQueue( *pQueue );
+        }
+    }
+
+    // Each subject only needs to be notified once for all changes, the dirty set holds
+    // them in ID order for the observers to walk their data in order
+    u32 dirtyCount = m_dirtyCount.exchange( 0, std::memory_order_relaxed );
+    std::sort( m_dirtySubjects.get(), m_dirtySubjects.get() + dirtyCount );
+    for( u32 i = 0; i < dirtyCount; ++i )
+    {
+        u32 uID = m_dirtySubjects[ i ];
+        u32 changedBits = m_dirtyBits[ uID ].exchange( 0, std::memory_order_relaxed );
+        m_cumulativeNotifyList.push_back( MappedNotification(uID, changedBits) );
+    }
+
+    // Notifications which were already delivered to some systems can only be combined
+    // with ones delivered to the same systems
+    for(const auto &notif : m_partialNotifyList)
+    {
+        u32 &index = m_deliveredIndexMap[ ((u64)notif.m_deliveredTypes << 32) | notif.m_subjectID ];
+        if( index )
+        {
+            m_cumulativeNotifyList[ index - 1 ].m_changedBits |= notif.m_changedBits;
+        }
+        else
+        {
+            m_cumulativeNotifyList.push_back( notif );
+            index = (u32)m_cumulativeNotifyList.size();
+        }
+    }
+    m_partialNotifyList.clear();
+    m_deliveredIndexMap.clear();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CollectCallback - This callback is used to divide collecting the queues 
+//                   among multiple threads
+void
+ChangeManager::CollectCallback(
+    void *param,
+    u32 begin,
+    u32 end
+    )
+{
+    CollectRange* pRange = static_cast<CollectRange*>(param);
+    for( u32 i = begin; i < end; ++i )
+    {
+        pRange->m_pMgr->CollectQueue( *(*pRange->m_pQueues)[ i ] );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CollectQueue - Take the bits of the notifications queued by one thread
+void
+ChangeManager::CollectQueue(
+    NotifyQueue& Queue
+    )
+{
+    ForEachQueued( Queue, True, [this] ( Notification& notif )
+    {
+        // Taking the bits tells the posting thread to queue a new notification
+        u32 changedBits = notif.m_changedBits.exchange( 0 );
+        if( changedBits == 0 )
+        {
+            return;
+        }
+
+        // Get subject for notification
+        auto uID = notif.m_pSubject->GetID(this);
+        if( uID != CSubject::InvalidID )
+        {
+            MarkDirty( uID, changedBits, notif.m_deliveredTypes.load() );
+        }
+    } );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MarkDirty - Add changes to the dirty set
+void
+ChangeManager::MarkDirty(
+    u32 uID,
+    u32 changedBits,
+    u32 deliveredTypes
+    )
+{
+    if( deliveredTypes == System::Types::Null && uID < m_dirtyCapacity )
+    {
+        // The first thread to set a bit adds the subject to the dirty set
+        if( m_dirtyBits[ uID ].fetch_or( changedBits, std::memory_order_relaxed ) == 0 )
+        {
+            m_dirtySubjects[ m_dirtyCount.fetch_add( 1, std::memory_order_relaxed ) ] = uID;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock( m_partialMutex );
+        m_partialNotifyList.push_back( MappedNotification(uID, changedBits, deliveredTypes) );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RecycleQueues - Empty the queues of a distributed buffer keeping their chunks
+void
+ChangeManager::RecycleQueues(
+    u32 Buffer
+    )
+{
+    for( ThreadNotifyList* pList = m_pNotifyLists.load( std::memory_order_acquire ); pList; pList = pList->m_pNext )
+    {
+        NotifyQueue &queue = pList->m_queues[ Buffer ];
+        NotifyChunk* pHead = queue.m_pHead.load( std::memory_order_relaxed );
+        if( pHead == nullptr )
+        {
+            continue;
+        }
+
+        u32 queued = 0;
+        for( NotifyChunk* pChunk = pHead; pChunk; pChunk = pChunk->m_pNext.load( std::memory_order_relaxed ) )
+        {
+            u32 count = pChunk->m_count.load( std::memory_order_relaxed );
+            if( count == 0 )
+            {
+                break;
+            }
+            queued += count;
+            pChunk->m_count.store( 0, std::memory_order_relaxed );
+        }
+
+        if( queued > m_highWaterMark.load( std::memory_order_relaxed ) )
+        {
+            m_highWaterMark.store( queued, std::memory_order_relaxed );
+        }
+
+        queue.m_pTail = pHead;
+        queue.m_pReadChunk = nullptr;
+        queue.m_readIndex = 0;
+        queue.m_generation++;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GetQueueStatistics - Get the usage of the notification queues
+void
+ChangeManager::GetQueueStatistics(
+    QueueStatistics& Stats
+    ) const
+{
+    u32 arenaUsed = m_arenaUsed.load( std::memory_order_relaxed );
+
+    Stats.Threads = m_threads.load( std::memory_order_relaxed );
+    Stats.ChunkSize = m_chunkSize;
+    Stats.ArenaChunks = m_arenaChunks;
+    Stats.ChunksUsed = std::min( arenaUsed, m_arenaChunks );
+    Stats.OverflowChunks = m_overflowChunks.load( std::memory_order_relaxed );
+    Stats.HighWaterMark = m_highWaterMark.load( std::memory_order_relaxed );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SharedMutex::lock - Wait until no one holds the lock and take it exclusively
+void
+ChangeManager::SharedMutex::lock(
+    void
+    )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_condition.wait( lock, [this] () { return !m_bWriter && m_readers == 0; } );
+    m_bWriter = true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SharedMutex::unlock - Release the exclusive lock
+void
+ChangeManager::SharedMutex::unlock(
+    void
+    )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_bWriter = false;
+    }
+    m_condition.notify_all();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SharedMutex::lock_shared - Wait until no writer holds the lock and share it
+void
+ChangeManager::SharedMutex::lock_shared(
+    void
+    )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_condition.wait( lock, [this] () { return !m_bWriter; } );
+    m_readers++;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SharedMutex::unlock_shared - Release a shared lock
+void
+ChangeManager::SharedMutex::unlock_shared(
+    void
+    )
+{
+    bool bLast;
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        bLast = ( --m_readers == 0 );
+    }
+    if( bLast )
+    {
+        m_condition.notify_all();
+    }
+}
@@ -15,9 +15,12 @@
 #pragma once
 
 // Standard library
-#include <list>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
+#include <unordered_map>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 /// <summary>
@@ -44,17 +47,82 @@ public:
     Error DistributeQueuedChanges( System::Types::BitMask Systems2BeNotified = System::Types::All,
                                    System::Changes::BitMask ChangesToDist = System::Changes::All );
 
+    /// <summary>
+    ///   Delivers the queued notifications to the observers registered for the given system only,
+    ///   while other systems may still be executing and posting changes.  Delivered notifications
+    ///   are skipped for these observers by the next <c>DistributeQueuedChanges</c>.
+    /// </summary>
+    /// <remarks>
+    ///   The caller guarantees that the system is not executing and that no system which
+    ///   produces changes the system is interested in is executing.  Observers registered
+    ///   for more than this system are left to <c>DistributeQueuedChanges</c>.
+    /// </remarks>
+    /// <param name="SystemType">The type of the system about to be executed.</param>
+    Error DistributeQueuedChangesToSystem( System::Type SystemType );
+
+    /// <summary>
+    ///   Maximum number of notification buffers, see <c>SetBufferCount</c>.
+    /// </summary>
+    static const u32 MaxBuffers = 4;
+
+    /// <summary>
+    ///   Sets the number of notification buffers.  With more than one buffer the changes of a
+    ///   frame can be closed by <c>SwapBuffers</c> and distributed by <c>DistributeBufferedChanges</c>
+    ///   while the systems already post the changes of the next frame.
+    /// </summary>
+    /// <remarks>Must be called while no changes are queued.</remarks>
+    /// <param name="Count">The number of buffers, at most <c>MaxBuffers</c>.</param>
+    void SetBufferCount( u32 Count );
+
+    /// <summary>
+    ///   Closes the buffer changes are posted to and continues with the next one.
+    /// </summary>
+    /// <remarks>
+    ///   Must be called while no system is executing.  The next buffer has to be distributed
+    ///   already, so no more than the buffer count minus one buffers can be closed at a time.
+    /// </remarks>
+    /// <param name="Systems">Receives the systems owning or observing the changed subjects,
+    ///  these must not execute while the closed buffer is distributed.  Observers registered
+    ///  for all systems are expected to be framework objects and do not count.</param>
+    /// <param name="Changes">Receives the changes queued in the closed buffer.</param>
+    /// <returns>The closed buffer.</returns>
+    u32 SwapBuffers( System::Types::BitMask& Systems, System::Changes::BitMask& Changes );
+
+    /// <summary>
+    ///   Distributes the notifications of a buffer closed by <c>SwapBuffers</c>.  The changes
+    ///   the observers post meanwhile are added to the same buffer and distributed as well.
+    /// </summary>
+    /// <remarks>Buffers have to be distributed in the order they were closed.</remarks>
+    /// <param name="Buffer">The buffer returned by <c>SwapBuffers</c>.</param>
+    Error DistributeBufferedChanges( u32 Buffer );
+
     // IObserver Functionality
     Error ChangeOccurred( ISubject* pInChangedSubject,
                           System::Changes::BitMask uInChangedBits );
 
-    // Must be called before any parallel execution starts (that is 
-    // before changes start being accumulated in thread local lists), 
-    // but after the task manager has been initialized
-    static void InitThreadLocalData( void* mgr );
+    // Registers the calling thread's notification list ahead of its first change.
+    // Optional, threads register on their first change as well.
+    static void InitThreadLocalData( void* mgr );
 
+    // Forgets the calling thread's notification list.  Its notifications are still
+    // distributed and the list is freed with the change manager.
     static void FreeThreadLocalData( void* mgr );
 
+    /// <summary>
+    ///   Usage of the notification queues, used to size them.
+    /// </summary>
+    struct QueueStatistics
+    {
+        u32 Threads;            // threads which posted changes
+        u32 ChunkSize;          // notifications per chunk
+        u32 ArenaChunks;        // chunks in the arena
+        u32 ChunksUsed;         // chunks taken from the arena
+        u32 OverflowChunks;     // chunks allocated after the arena ran out
+        u32 HighWaterMark;      // most notifications one thread queued for a distribution
+    };
+
+    void GetQueueStatistics( QueueStatistics& Stats ) const;
+
 
 protected:
 
@@ -100,7 +168,11 @@ protected:
         SubjectInfo ()
             : m_pSubject(nullptr)
             , m_interestBits(0)
-            , m_observersList()
+            , m_ownerTypes(0)
+            , m_observerTypes(0)
+            , m_firstObserver(0)
+            , m_observerCount(0)
+            , m_observerCapacity(0)
         {}
 
         /// <summary>
@@ -114,9 +186,22 @@ protected:
         u32     m_interestBits;
 
         /// <summary>
-        ///   Observers subscribed to this subject
+        ///   System owning the subject, all systems if it is not a system object or scene
+        /// </summary>
+        u32     m_ownerTypes;
+
+        /// <summary>
+        ///   Cumulative system types of all observers from this list which belong to one system
         /// </summary>
-        ObserversList   m_observersList;
+        u32     m_observerTypes;
+
+        /// <summary>
+        ///   Observers subscribed to this subject, a range of m_observers.  The range is kept
+        ///   for the next subject with the same ID.
+        /// </summary>
+        u32     m_firstObserver;
+        u32     m_observerCount;
+        u32     m_observerCapacity;
 
     }; // class ChangeManager::ObserversList
 
@@ -139,41 +224,161 @@ protected:
     /// </summary>
     SubjectsList        m_subjectsList;
 
+    /// <summary>
+    ///   Observers of all subjects, those of a subject are contiguous.  A subject which outgrows
+    ///   its range moves to the end, the table is compacted in ID order once more than half of
+    ///   it is left behind by moved ranges.
+    /// </summary>
+    ObserversList       m_observers;
+    u32                 m_unusedObservers;
+
     struct Notification
     {
-        Notification ( ISubject* pSubject, u32 changedBits )
-            : m_pSubject(pSubject)
-            , m_changedBits(changedBits)
+        ISubject*           m_pSubject;
+        /// <summary>
+        ///   Later changes of the subject on the posting thread are added to these bits until
+        ///   DistributeQueuedChanges takes them
+        /// </summary>
+        std::atomic<u32>    m_changedBits;
+        /// <summary>
+        ///   Systems this notification was already delivered to by DistributeQueuedChangesToSystem
+        /// </summary>
+        std::atomic<u32>    m_deliveredTypes;
+    };
+
+    /// <summary>
+    ///   Fixed size block of notifications.  Only the thread owning the chunk appends to it,
+    ///   the notifications up to m_count are visible to all threads.
+    /// </summary>
+    struct NotifyChunk
+    {
+        std::atomic<u32>            m_count;
+        std::atomic<NotifyChunk*>   m_pNext;
+        Notification*               m_pNotifications;
+        Bool                        m_bOverflow;
+    };
+
+    /// <summary>
+    ///   Notifications posted by one thread to one buffer, a chain of chunks which is
+    ///   kept for the next frames once the buffer was distributed.
+    /// </summary>
+    struct NotifyQueue
+    {
+        NotifyQueue ()
+            : m_pHead(nullptr)
+            , m_pTail(nullptr)
+            , m_pReadChunk(nullptr)
+            , m_readIndex(0)
+            , m_generation(1)
+        {}
+
+        std::atomic<NotifyChunk*>   m_pHead;
+
+        /// <summary>
+        ///   Chunk the posting thread appends to
+        /// </summary>
+        NotifyChunk*                m_pTail;
+
+        /// <summary>
+        ///   Position up to which DistributeQueuedChanges has collected the notifications
+        /// </summary>
+        NotifyChunk*                m_pReadChunk;
+        u32                         m_readIndex;
+
+        /// <summary>
+        ///   Last notification the posting thread queued for each subject ID, valid if its
+        ///   generation matches the queue's.  The generation advances when the queue is emptied.
+        /// </summary>
+        struct DirtyEntry
+        {
+            u32                     m_generation;
+            Notification*           m_pNotification;
+        };
+
+        std::vector<DirtyEntry>     m_dirty;
+        u32                         m_generation;
+    };
+
+    /// <summary>
+    ///   Notifications posted by one thread.  Registered on the first change the thread posts
+    ///   and kept until the change manager is destroyed.
+    /// </summary>
+    struct ThreadNotifyList
+    {
+        ThreadNotifyList ()
+            : m_pNext(nullptr)
         {}
 
-        ISubject*   m_pSubject;
-        u32         m_changedBits;
+        NotifyQueue         m_queues[ MaxBuffers ];
+        ThreadNotifyList*   m_pNext;
     };
-public:    
-    typedef std::vector<Notification> NotifyList;
-protected:
-    typedef  std::list<NotifyList*>  ListOfNotifyLists;
 
     /// <summary>
-    ///   Cross-thread list of notification lists. Accessed only from the main thread.
+    ///   Cross-thread list of notification lists.  Lists are only ever added.
     /// </summary>
-    ListOfNotifyLists   m_NotifyLists;
+    std::atomic<ThreadNotifyList*>  m_pNotifyLists;
 
     /// <summary>
-    ///   TLS slot that store pointers to NotifyListInfo values, containing pointer 
-    ///   to thread local notification lists with fast search ability and .
+    ///   TLS slots that store pointers to the thread local notification lists,
+    ///   one slot per change manager.
     /// </summary>
-    static __thread_local NotifyList*  m_tlsNotifyList;
+    static const u32 MaxChangeManagers = 4;
+    static __thread_local ThreadNotifyList*  m_tlsNotifyLists[ MaxChangeManagers ];
+
+    /// <summary>
+    ///   Slot of this change manager in m_tlsNotifyLists.  Slots are returned when a manager
+    ///   is destroyed, sm_usedTlsSlots has a bit set for each slot in use.
+    /// </summary>
+    u32                 m_tlsSlot;
+    static std::atomic<u32> sm_usedTlsSlots;
+
+    /// <summary>
+    ///   Generation of the manager owning a slot, the thread local data of a slot is dropped
+    ///   by a thread that last used it for an earlier manager.
+    /// </summary>
+    u32                 m_tlsGeneration;
+    static std::atomic<u32> sm_nextTlsGeneration;
+    static __thread_local u32  m_tlsGenerations[ MaxChangeManagers ];
+
+    /// <summary>
+    ///   Chunks are taken from an arena allocated on first use, sized by the environment
+    ///   variables ChangeManager::ChunkSize and ChangeManager::ArenaChunks.  Once it runs
+    ///   out chunks are allocated from the heap.
+    /// </summary>
+    std::once_flag                      m_arenaOnce;
+    u32                                 m_chunkSize;
+    u32                                 m_arenaChunks;
+    std::unique_ptr<NotifyChunk[]>      m_arena;
+    std::unique_ptr<Notification[]>     m_arenaNotifications;
+    std::atomic<u32>                    m_arenaUsed;
+
+    std::atomic<u32>                    m_threads;
+    std::atomic<u32>                    m_overflowChunks;
+    std::atomic<u32>                    m_highWaterMark;
+
+    /// <summary>
+    ///   Buffer the changes are currently posted to and the number of buffers in use.
+    /// </summary>
+    std::atomic<u32>    m_writeBuffer;
+    u32                 m_bufferCount;
+
+    /// <summary>
+    ///   Buffer distributed by the current thread plus one, zero if none.  Changes posted by
+    ///   observers while a buffer is distributed go to that buffer.
+    /// </summary>
+    static __thread_local u32  m_tlsDistributedBuffer[ MaxChangeManagers ];
 
     struct MappedNotification
     {
-        MappedNotification ( u32 uID, u32 changedBits )
+        MappedNotification ( u32 uID, u32 changedBits, u32 deliveredTypes = System::Types::Null )
             : m_subjectID(uID)
             , m_changedBits(changedBits)
+            , m_deliveredTypes(deliveredTypes)
         {}
 
         u32 m_subjectID;
         u32 m_changedBits;
+        u32 m_deliveredTypes;
     };
 
     typedef std::vector<MappedNotification> MappedNotifyList;
@@ -185,17 +390,156 @@ protected:
     MappedNotifyList    m_cumulativeNotifyList;
 
     /// <summary>
-    ///   Used while generating cumulative list during the distribution stage.
+    ///   Changed bits of every subject ID, the notifications of all threads are reduced into
+    ///   them in parallel.  The IDs with bits set form the dirty set, a subject is added to it
+    ///   by the thread that sets its first bit.  Only resized while collecting.
+    /// </summary>
+    std::unique_ptr<std::atomic<u32>[]> m_dirtyBits;
+    std::unique_ptr<u32[]>              m_dirtySubjects;
+    std::atomic<u32>                    m_dirtyCount;
+    u32                                 m_dirtyCapacity;
+
+    /// <summary>
+    ///   Notifications which were partially delivered already.  They can only be combined with
+    ///   ones delivered to the same systems, using the index in m_cumulativeNotifyList plus one
+    ///   keyed by subject ID and the systems they were delivered to.
+    /// </summary>
+    MappedNotifyList                    m_partialNotifyList;
+    std::mutex                          m_partialMutex;
+    std::unordered_map<u64, u32>        m_deliveredIndexMap;
+
+    /// <summary>
+    ///   Changes to deliver grouped by observer, so each observer receives all of its changes
+    ///   with one call and different observers can be handled in parallel.
+    /// </summary>
+    struct ObserverBatches
+    {
+        /// <summary>
+        ///   Queues a change for an observer.
+        /// </summary>
+        void Add( IObserver* pObserver, ISubject* pSubject, u32 changedBits );
+
+        /// <summary>
+        ///   Arranges the queued changes into one contiguous batch per observer.
+        /// </summary>
+        void Build( void );
+
+        void Clear( void );
+
+        struct Delivery
+        {
+            u32         m_batch;
+            ISubject*   m_pSubject;
+            u32         m_changedBits;
+        };
+
+        std::unordered_map<IObserver*, u32> m_batchIndex;
+        std::vector<Delivery>               m_deliveries;
+
+        /// <summary>
+        ///   Batch i holds m_changes[ m_offsets[i] ] up to m_changes[ m_offsets[i + 1] ]
+        /// </summary>
+        std::vector<IObserver*>             m_observers;
+        std::vector<u32>                    m_offsets;
+        std::vector<IObserver::Change>      m_changes;
+    };
+
+    /// <summary>
+    ///   Batches of DistributeQueuedChanges, kept to reuse the memory.
+    /// </summary>
+    ObserverBatches     m_batches;
+
+    /// <summary>
+    ///   Lock taken by many readers or by one writer.
+    /// </summary>
+    class SharedMutex
+    {
+    public:
+        SharedMutex( void ) : m_readers(0), m_bWriter(false) {}
+
+        void lock( void );
+        void unlock( void );
+        void lock_shared( void );
+        void unlock_shared( void );
+
+        /// <summary>
+        ///   Holds a shared lock for its lifetime.
+        /// </summary>
+        class SharedLock
+        {
+        public:
+            SharedLock( SharedMutex& Mutex ) : m_mutex(Mutex) { m_mutex.lock_shared(); }
+            ~SharedLock( void ) { m_mutex.unlock_shared(); }
+
+        private:
+            SharedLock( const SharedLock& );
+            SharedLock& operator=( const SharedLock& );
+
+            SharedMutex&    m_mutex;
+        };
+
+    private:
+        std::mutex              m_mutex;
+        std::condition_variable m_condition;
+        u32                     m_readers;
+        bool                    m_bWriter;
+    };
+
+    /// <summary>
+    ///   Register, Unregister and RemoveSubject change m_subjectsList and m_observers
+    ///   exclusively.  The distributions walk them under a shared lock, which is released
+    ///   before the observers are called as they may register.
     /// </summary>
-    IDsList             m_indexList;
+    SharedMutex         m_UpdateMutex;
 
-    std::mutex          m_UpdateMutex;
+    /// <summary>
+    ///   Systems which ever had an observer registered for them alone.  Only these are handed
+    ///   notifications by <c>DistributeQueuedChangesToSystem</c>.  Guarded by m_UpdateMutex.
+    /// </summary>
+    u32                 m_exclusiveTypes;
 
 private:
     Error RemoveSubject ( ISubject* pSubject );
 
+    Error Distribute ( u32 Buffer, System::Types::BitMask Systems2BeNotified,
+                       System::Changes::BitMask ChangesToDist );
+    u32 GetPostBuffer ( void ) const;
+    static u32 AcquireTlsSlot ( void );
+    void ValidateThreadLocalData ( void ) const;
+    ThreadNotifyList* GetThreadNotifyList ( void );
+    void CollectQueuedChanges ( u32 Buffer );
+    void CollectQueue ( NotifyQueue& Queue );
+    void MarkDirty ( u32 uID, u32 changedBits, u32 deliveredTypes );
+
+    struct CollectRange
+    {
+        ChangeManager*                  m_pMgr;
+        std::vector<NotifyQueue*>*      m_pQueues;
+    };
+
+    static void CollectCallback( void *param, u32 begin, u32 end );
+    std::vector<NotifyQueue*>   m_collectQueues;
+    NotifyChunk* AllocateChunk ( void );
+    void RecycleQueues ( u32 Buffer );
+
+    template<class Function>
+    void ForEachQueued ( NotifyQueue& Queue, Bool bConsume, Function Process );
+    void UpdateObserverTypes ( SubjectInfo& Subject );
+    Bool HasExclusiveObserver ( const SubjectInfo& Subject, System::Type SystemType, u32 changedBits ) const;
+    void AddObserver ( SubjectInfo& Subject, const ObserverRequest& Request );
+    void CompactObservers ( void );
+
+    void DeliverBatches ( ObserverBatches& Batches, u32 Buffer );
+
+    struct DistributionRange
+    {
+        ChangeManager*      m_pMgr;
+        ObserverBatches*    m_pBatches;
+        u32                 m_buffer;
+    };
+
     static void DistributionCallback( void *param, u32 begin, u32 end );
-    void DistributeRange ( u32 begin, u32 end );
+    void DistributeRange ( ObserverBatches& Batches, u32 Buffer, u32 begin, u32 end );
 
     System::Types::BitMask      m_systems2BeNotified;
     System::Changes::BitMask    m_ChangesToDist;
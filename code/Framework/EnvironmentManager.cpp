@@ -18,7 +18,10 @@
 //interface
 #include "Interfaces/Interface.hpp"
 //stdlib
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sys/stat.h>
 //framework
 #include "Framework/EnvironmentManager.hpp"
 
@@ -33,11 +36,16 @@ EnvironmentManager::Variables::Add(
     In pcstr pszValue
     )
 {
-    Variables::Pair vp;
-    vp.sName = pszName;
-    vp.sValue = pszValue;
+    std::lock_guard<std::mutex> lock( m_Mutex );
 
-    m_Pairs.push_back( vp );
+    //
+    // The first value added wins, the command line is added before the GDF.
+    //
+    Variable* pVariable = Find( pszName, True );
+    if ( !pVariable->bSet.load( std::memory_order_relaxed ) )
+    {
+        Set( pVariable, pszValue );
+    }
 }
 
 // Set the value of an environment variable that already exists.  
@@ -48,15 +56,13 @@ EnvironmentManager::Variables::SetValue(
     In pcstr pszValue
     )
 {
-    for (auto & vp : m_Pairs)
+    std::lock_guard<std::mutex> lock( m_Mutex );
+
+    Variable* pVariable = Find( pszName, False );
+    if ( pVariable != nullptr )
     {
-        if ( vp.sName == pszName )
-        {
-            vp.sValue = pszValue;
-            break;
-        }
+        Set( pVariable, pszValue );
     }
-
 }
 
 
@@ -99,19 +105,11 @@ EnvironmentManager::Variables::GetAsBool(
     In Bool bDefaultValue
     )
 {
-    Bool bValue = bDefaultValue;
+    std::lock_guard<std::mutex> lock( m_Mutex );
 
-    pcstr pszValue;
-    if ( GetValue( pszName, pszValue ) )
-    {
-        if(!_stricmp( pszValue, "False" ) && !_stricmp( pszValue, "True" ))
-        {
-            std::cerr << "Bool '" << pszName << "' not True or False. It is " << pszValue << "." << std::endl;
-        }
-        bValue = _stricmp( pszValue, "True" ) == 0;
-    }
+    Variable* pVariable = Find( pszName, False );
 
-    return bValue;
+    return (pVariable != nullptr) ? GetAsBool( pVariable, bDefaultValue ) : bDefaultValue;
 }
 
 
@@ -121,15 +119,11 @@ EnvironmentManager::Variables::GetAsInt(
     In i32 DefaultValue
     )
 {
-    i32 Value = DefaultValue;
+    std::lock_guard<std::mutex> lock( m_Mutex );
 
-    pcstr pszValue;
-    if ( GetValue( pszName, pszValue ) )
-    {
-        Value = atoi( pszValue );
-    }
+    Variable* pVariable = Find( pszName, False );
 
-    return Value;
+    return (pVariable != nullptr) ? GetAsInt( pVariable, DefaultValue ) : DefaultValue;
 }
 
 
@@ -139,15 +133,22 @@ EnvironmentManager::Variables::GetAsFloat(
     In f32 DefaultValue
     )
 {
-    f32 Value = DefaultValue;
+    std::lock_guard<std::mutex> lock( m_Mutex );
 
-    pcstr pszValue;
-    if ( GetValue( pszName, pszValue ) )
-    {
-        Value = static_cast<f32>(atof( pszValue ));
-    }
+    Variable* pVariable = Find( pszName, False );
+
+    return (pVariable != nullptr) ? GetAsFloat( pVariable, DefaultValue ) : DefaultValue;
+}
+
+
+IEnvironment::IVariables::VariableHandle
+EnvironmentManager::Variables::GetHandle(
+    In pcstr pszName
+    )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
 
-    return Value;
+    return Find( pszName, True );
 }
 
 
@@ -157,19 +158,166 @@ EnvironmentManager::Variables::GetValue(
     Out pcstr& pszValue
     )
 {
-    Bool bFound = False;
+    std::lock_guard<std::mutex> lock( m_Mutex );
+
+    Variable* pVariable = Find( pszName, False );
+    if ( pVariable == nullptr || !pVariable->bSet.load( std::memory_order_relaxed ) )
+    {
+        return False;
+    }
+
+    pszValue = pVariable->pszValue;
+    return True;
+}
+
+
+EnvironmentManager::Variables::Variable*
+EnvironmentManager::Variables::Find(
+    In pcstr pszName,
+    In Bool bCreate
+    )
+{
+    auto it = m_Index.find( pszName );
+    if ( it != m_Index.end() )
+    {
+        return it->second;
+    }
 
-    for (auto & vp : m_Pairs)
+    if ( !bCreate )
     {
-        if ( vp.sName == pszName )
+        return nullptr;
+    }
+
+    m_Variables.emplace_back();
+    Variable* pVariable = &m_Variables.back();
+    pVariable->sName = pszName;
+    pVariable->pszValue = "";
+    pVariable->bSet.store( False, std::memory_order_relaxed );
+    pVariable->bValue.store( False, std::memory_order_relaxed );
+    pVariable->IntValue.store( 0, std::memory_order_relaxed );
+    pVariable->FloatValue.store( 0.0f, std::memory_order_relaxed );
+    m_Index[ pVariable->sName ] = pVariable;
+
+    return pVariable;
+}
+
+
+void
+EnvironmentManager::Variables::Set(
+    Variable* pVariable,
+    In pcstr pszValue
+    )
+{
+    pVariable->sValue = pszValue;
+    pVariable->pszValue = m_Values.insert( pVariable->sValue ).first->c_str();
+    pVariable->bValue.store( _stricmp( pszValue, "True" ) == 0, std::memory_order_relaxed );
+    pVariable->IntValue.store( atoi( pszValue ), std::memory_order_relaxed );
+    pVariable->FloatValue.store( static_cast<f32>(atof( pszValue )), std::memory_order_relaxed );
+    pVariable->bSet.store( True, std::memory_order_release );
+}
+
+
+void
+EnvironmentManager::Variables::Watch(
+    In pcstr pszFile
+    )
+{
+    m_sWatchedFile = pszFile;
+    m_WatchedTime = 0;
+    m_WatchedSize = 0;
+    m_NextWatchCheck = std::chrono::steady_clock::now();
+
+    //
+    // Take the variables that are in the file already, it may also be created later.
+    //
+    if ( IsWatchedFileChanged() )
+    {
+        ReloadWatchedFile();
+    }
+    else
+    {
+        std::cerr << "Environment is watching " << m_sWatchedFile << " which does not exist yet." << std::endl;
+    }
+}
+
+
+Bool
+EnvironmentManager::Variables::IsWatchedFileChanged(
+    void
+    )
+{
+    if ( m_sWatchedFile.empty() )
+    {
+        return False;
+    }
+
+    auto Now = std::chrono::steady_clock::now();
+    if ( Now < m_NextWatchCheck )
+    {
+        return False;
+    }
+    m_NextWatchCheck = Now + std::chrono::milliseconds( 250 );
+
+    struct stat Status;
+    if ( stat( m_sWatchedFile.c_str(), &Status ) != 0 )
+    {
+        return False;
+    }
+
+    return (i64)Status.st_mtime != m_WatchedTime || (i64)Status.st_size != m_WatchedSize;
+}
+
+
+void
+EnvironmentManager::Variables::ReloadWatchedFile(
+    void
+    )
+{
+    struct stat Status;
+    if ( stat( m_sWatchedFile.c_str(), &Status ) == 0 )
+    {
+        m_WatchedTime = (i64)Status.st_mtime;
+        m_WatchedSize = (i64)Status.st_size;
+    }
+
+    std::ifstream File( m_sWatchedFile.c_str() );
+    if ( !File )
+    {
+        std::cerr << "Environment could not open the watched file " << m_sWatchedFile << "." << std::endl;
+        return;
+    }
+
+    u32 Count = 0;
+    std::string sLine;
+    while ( std::getline( File, sLine ) )
+    {
+        //
+        // Name=Value, the same as on the command line.  Lines starting with # are comments.
+        //
+        size_t Equals = sLine.find( '=' );
+        size_t First = sLine.find_first_not_of( " \t" );
+        if ( Equals == std::string::npos || First == Equals || sLine[ First ] == '#' )
+        {
+            continue;
+        }
+
+        size_t NameEnd = sLine.find_last_not_of( " \t", Equals - 1 );
+        size_t ValueStart = sLine.find_first_not_of( " \t", Equals + 1 );
+        size_t ValueEnd = sLine.find_last_not_of( " \t\r" );
+        std::string sName = sLine.substr( First, NameEnd - First + 1 );
+        std::string sValue = (ValueStart == std::string::npos || ValueStart > ValueEnd) ?
+            std::string() : sLine.substr( ValueStart, ValueEnd - ValueStart + 1 );
+
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        Variable* pVariable = Find( sName.c_str(), True );
+        if ( !pVariable->bSet.load( std::memory_order_relaxed ) || pVariable->sValue != sValue )
         {
-            pszValue = vp.sValue.c_str();
-            bFound = True;
-            break;
+            Set( pVariable, sValue.c_str() );
+            Count++;
         }
     }
 
-    return bFound;
+    std::clog << "Environment set " << Count << " variables from " << m_sWatchedFile << std::endl;
 }
 
 
@@ -189,3 +337,21 @@ EnvironmentManager::SetStatus(
 {
     m_RuntimeStatus.store(Status);
 }
+
+
+f32
+EnvironmentManager::GetInterpolation(
+    void
+    )
+{
+    return m_Interpolation.load( std::memory_order_relaxed );
+}
+
+
+void
+EnvironmentManager::SetInterpolation(
+    f32 Interpolation
+    )
+{
+    m_Interpolation.store( Interpolation, std::memory_order_relaxed );
+}
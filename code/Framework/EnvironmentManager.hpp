@@ -15,9 +15,13 @@
 #pragma once
 #include <stddef.h> 
 #include <atomic>
+#include <chrono>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 ////////////////////////////////////////////////////////////////////////
@@ -44,7 +48,7 @@ private:
         return *this;
     }
 
-    EnvironmentManager() {m_RuntimeStatus.store(IEnvironment::IRuntime::Status::Unknown);}
+    EnvironmentManager() {m_RuntimeStatus.store(IEnvironment::IRuntime::Status::Unknown); m_Interpolation.store(1.0f);}
     
 public:
 
@@ -97,28 +101,63 @@ public:
         virtual f32 GetAsFloat( In pcstr pszName, 
                                 In f32 DefaultValue=0.0f );
 
+        // Implementation of IEnvironment::IVariables::GetHandle.
+        virtual VariableHandle GetHandle( In pcstr pszName );
 
-    protected:
+        using IEnvironment::IVariables::GetAsBool;
+        using IEnvironment::IVariables::GetAsInt;
+        using IEnvironment::IVariables::GetAsFloat;
 
-        // Only accessible via the EnvironmentManager class.
-        Variables() {}
+        // Watches a file of Name=Value lines, the variables in it are set whenever it changes.
+        void Watch( In pcstr pszFile );
 
-        // Gets the value of a variable.
-        Bool GetValue( In pcstr pszName, Out pcstr& pszValue );
+        // Checks if the watched file changed.  The file is looked at no more than a few times
+        // a second.
+        Bool IsWatchedFileChanged( void );
+
+        // Sets the variables of the watched file.  Called between frames so the values do not
+        // change while the systems run.
+        void ReloadWatchedFile( void );
 
 
     protected:
 
-        struct Pair
+        // Only accessible via the EnvironmentManager class.
+        Variables() : m_WatchedTime( 0 ), m_WatchedSize( 0 ) {}
+
+        struct Variable : public IEnvironment::IVariables::Value
         {
             std::string                             sName;
             std::string                             sValue;
+            // The copy of the value in m_Values handed out by GetAsString.
+            pcstr                                   pszValue;
         };
 
-        typedef std::vector<Pair>                   Pairs;
-        typedef Pairs::iterator                     PairsIt;
+        // Gets a variable by name, creating it unset if asked to.  The mutex must be held.
+        Variable* Find( In pcstr pszName, In Bool bCreate );
+
+        // Parses and publishes the value of a variable.  The mutex must be held.
+        void Set( Variable* pVariable, In pcstr pszValue );
+
+        // Gets the value of a set variable.
+        Bool GetValue( In pcstr pszName, Out pcstr& pszValue );
+
+
+    protected:
 
-        Pairs                                       m_Pairs;
+        // The variables never move so their handles stay valid.
+        std::deque<Variable>                        m_Variables;
+        std::unordered_map<std::string, Variable*>  m_Index;
+        std::mutex                                  m_Mutex;
+
+        // Every value a variable ever had, so the strings returned by GetAsString stay valid
+        // when the watched file is reloaded.
+        std::unordered_set<std::string>             m_Values;
+
+        std::string                                 m_sWatchedFile;
+        i64                                         m_WatchedTime;
+        i64                                         m_WatchedSize;
+        std::chrono::steady_clock::time_point       m_NextWatchCheck;
     };
 
 
@@ -132,12 +171,19 @@ public:
     // Implementation of IEnvironment::IRuntime::SetStatus.
     virtual void SetStatus( IEnvironment::IRuntime::Status Status );
 
+    // Implementation of IEnvironment::IRuntime::GetInterpolation.
+    virtual f32 GetInterpolation( void );
+
+    // Implementation of IEnvironment::IRuntime::SetInterpolation.
+    virtual void SetInterpolation( f32 Interpolation );
+
 
 protected:
 
     Variables                                       m_Variables;
 
     std::atomic<IEnvironment::IRuntime::Status>     m_RuntimeStatus;
+    std::atomic<f32>                                m_Interpolation;
 
 
 public:
@@ -0,0 +1,288 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+//core
+#include "Base/Compat.hpp"
+#include "Base/Platform.hpp"
+//interface
+#include "Interfaces/Interface.hpp"
+//stdlib
+#include <algorithm>
+#include <cstdlib>
+//framework
+#include "Framework/EnvironmentManager.hpp"
+#include "Framework/FrameArena.hpp"
+
+std::once_flag
+FrameArena::only_one;
+std::shared_ptr<FrameArena>
+FrameArena::instance_ = nullptr;
+
+__thread_local FrameArena::ThreadArena*
+FrameArena::sm_pThreadArena = nullptr;
+
+// Memory of a frame stays valid while the next frame uses the other generation.
+static const u32 Generations = 2;
+
+// The header of a block is padded so the memory after it is aligned to a cache line.
+static const size_t BlockHeaderSize = 64;
+
+struct FrameArena::Block
+{
+    Block*                              pNext;
+    size_t                              Size;
+    size_t                              Used;
+
+    u8* GetData( void )
+    {
+        return reinterpret_cast<u8*>( this ) + BlockHeaderSize;
+    }
+};
+
+struct FrameArena::ThreadArena
+{
+    struct Generation
+    {
+        u32                             Frame;
+        Block*                          pFirst;
+        Block*                          pCurrent;
+    };
+
+    Generation                          aGenerations[ Generations ];
+
+    // Only written by the owning thread, read for the statistics.
+    std::atomic<u64>                    Bytes;
+    std::atomic<u64>                    Blocks;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FrameArena - Default constructor
+FrameArena::FrameArena(
+    void
+    )
+    : m_Frame( 0 )
+    , m_BlockSize( 256 * 1024 )
+#if defined(_DEBUG)
+    , m_bPoison( True )
+#else
+    , m_bPoison( False )
+#endif
+{
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ~FrameArena - Default destructor
+FrameArena::~FrameArena(
+    void
+    )
+{
+    for ( auto pArena : m_Arenas )
+    {
+        for ( u32 i = 0; i < Generations; i++ )
+        {
+            Block* pBlock = pArena->aGenerations[ i ].pFirst;
+            while ( pBlock != nullptr )
+            {
+                Block* pNext = pBlock->pNext;
+                free( pBlock );
+                pBlock = pNext;
+            }
+        }
+        delete pArena;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Initialize - Read the settings
+void
+FrameArena::Initialize(
+    void
+    )
+{
+    IEnvironment::IVariables& Variables = EnvironmentManager::getInstance().Variables();
+    m_BlockSize = (size_t)std::max( Variables.GetAsInt( "FrameArena::BlockSize", 256 * 1024 ), 4096 );
+    m_bPoison = Variables.GetAsBool( "FrameArena::Poison", m_bPoison );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// EndFrame - Start a new frame
+void
+FrameArena::EndFrame(
+    void
+    )
+{
+    m_Frame.fetch_add( 1, std::memory_order_release );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GetStatistics - Get the totals of all threads
+void
+FrameArena::GetStatistics(
+    u64& Bytes,
+    u64& Blocks
+    )
+{
+    Bytes = 0;
+    Blocks = 0;
+
+    std::lock_guard<std::mutex> lock( m_ArenasMutex );
+    for ( auto pArena : m_Arenas )
+    {
+        Bytes += pArena->Bytes.load( std::memory_order_relaxed );
+        Blocks += pArena->Blocks.load( std::memory_order_relaxed );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Allocate - Allocate memory from the arena of the calling thread
+void*
+FrameArena::Allocate(
+    size_t Size,
+    size_t Alignment
+    )
+{
+    ASSERT( Alignment != 0 && (Alignment & (Alignment - 1)) == 0 );
+
+    ThreadArena* pArena = GetThreadArena();
+    u32 Frame = m_Frame.load( std::memory_order_acquire );
+    ThreadArena::Generation& Generation = pArena->aGenerations[ Frame % Generations ];
+
+    if ( Generation.Frame != Frame )
+    {
+        // The generation was last used two frames ago, reuse it as a whole.
+        size_t Total = 0;
+        for ( Block* pBlock = Generation.pFirst; pBlock != nullptr; pBlock = pBlock->pNext )
+        {
+            if ( m_bPoison )
+            {
+                memset( pBlock->GetData(), 0xDD, pBlock->Used );
+            }
+            Total += pBlock->Size;
+        }
+
+        if ( Generation.pFirst != nullptr && Generation.pFirst->pNext != nullptr )
+        {
+            // It did not fit into one block, make it one block of the whole size.
+            Block* pBlock = Generation.pFirst;
+            while ( pBlock != nullptr )
+            {
+                Block* pNext = pBlock->pNext;
+                free( pBlock );
+                pBlock = pNext;
+            }
+            Generation.pFirst = NewBlock( pArena, Total );
+        }
+
+        if ( Generation.pFirst != nullptr )
+        {
+            Generation.pFirst->Used = 0;
+        }
+        Generation.pCurrent = Generation.pFirst;
+        Generation.Frame = Frame;
+    }
+
+    Block* pBlock = Generation.pCurrent;
+    size_t Offset = 0;
+    if ( pBlock != nullptr )
+    {
+        Offset = ( pBlock->Used + Alignment - 1 ) & ~( Alignment - 1 );
+    }
+
+    if ( pBlock == nullptr || Offset + Size > pBlock->Size )
+    {
+        // Chain a new block, the blocks are aligned to BlockHeaderSize.
+        Block* pNew = NewBlock( pArena, std::max( m_BlockSize, Size + Alignment ) );
+        if ( pBlock != nullptr )
+        {
+            pBlock->pNext = pNew;
+        }
+        else
+        {
+            Generation.pFirst = pNew;
+        }
+        Generation.pCurrent = pNew;
+        pBlock = pNew;
+        Offset = 0;
+    }
+
+    u8* pMemory = pBlock->GetData() + Offset;
+    pBlock->Used = Offset + Size;
+    pArena->Bytes.store( pArena->Bytes.load( std::memory_order_relaxed ) + Size, std::memory_order_relaxed );
+
+    if ( m_bPoison )
+    {
+        memset( pMemory, 0xCD, Size );
+    }
+
+    return pMemory;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// NewBlock - Take a block from the heap
+FrameArena::Block*
+FrameArena::NewBlock(
+    ThreadArena* pArena,
+    size_t Size
+    )
+{
+    Block* pBlock = static_cast<Block*>( malloc( BlockHeaderSize + Size ) );
+    ASSERT( pBlock != nullptr );
+    pBlock->pNext = nullptr;
+    pBlock->Size = Size;
+    pBlock->Used = 0;
+
+    pArena->Blocks.store( pArena->Blocks.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+
+    return pBlock;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GetThreadArena - Get the arena of the calling thread
+FrameArena::ThreadArena*
+FrameArena::GetThreadArena(
+    void
+    )
+{
+    ThreadArena* pArena = sm_pThreadArena;
+
+    if ( pArena == nullptr )
+    {
+        pArena = new ThreadArena;
+        for ( u32 i = 0; i < Generations; i++ )
+        {
+            pArena->aGenerations[ i ].Frame = (u32)-1;
+            pArena->aGenerations[ i ].pFirst = nullptr;
+            pArena->aGenerations[ i ].pCurrent = nullptr;
+        }
+        pArena->Bytes.store( 0, std::memory_order_relaxed );
+        pArena->Blocks.store( 0, std::memory_order_relaxed );
+
+        {
+            std::lock_guard<std::mutex> lock( m_ArenasMutex );
+            m_Arenas.push_back( pArena );
+        }
+
+        sm_pThreadArena = pArena;
+    }
+
+    return pArena;
+}
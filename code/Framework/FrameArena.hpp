@@ -0,0 +1,124 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// <summary>
+///   Hands out memory which is only needed for a frame from an arena per thread.
+/// </summary>
+/// <remarks>
+///   Each arena keeps two generations of blocks and allocates from the one of the current
+///   frame by bumping a pointer.  EndFrame only advances the frame number, the owning thread
+///   reuses a generation as a whole the first time it allocates in a new frame, so memory stays
+///   valid until the end of the frame after the one it was allocated in.  Generations which
+///   needed more than one block are merged into one, after a few frames an arena does not call
+///   malloc any more.  The blocks are FrameArena::BlockSize bytes.  With FrameArena::Poison,
+///   the default in debug builds, new memory is filled with 0xCD and reused memory with 0xDD.
+/// </remarks>
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class FrameArena : public IService::IFrameArena
+{
+private:
+    // Singleton
+    static std::shared_ptr<FrameArena>  instance_;
+    static std::once_flag               only_one;
+
+    FrameArena(const FrameArena& rs) {
+        instance_  = rs.instance_;
+    }
+
+    FrameArena& operator = (const FrameArena& rs)
+    {
+        if (this != &rs) {
+            instance_  = rs.instance_;
+        }
+
+        return *this;
+    }
+
+    FrameArena();
+
+public:
+
+    static FrameArena& getInstance()
+    {
+        std::call_once( FrameArena::only_one, [] ()
+        {
+            FrameArena::instance_.reset(
+                new FrameArena());
+        });
+
+        return *FrameArena::instance_;
+    }
+
+    ~FrameArena();
+
+    /// <summary>
+    ///   Reads the settings from the environment.
+    /// </summary>
+    void Initialize( void );
+
+    /// <summary>
+    ///   Starts a new frame, the memory of the frame before the last one is reused from now on.
+    /// </summary>
+    void EndFrame( void );
+
+    /// <summary>
+    ///   Gets the totals of all threads since the start.
+    /// </summary>
+    /// <param name="Bytes">Receives the number of bytes allocated.</param>
+    /// <param name="Blocks">Receives the number of blocks taken from the heap.</param>
+    void GetStatistics( u64& Bytes, u64& Blocks );
+
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // IService::IFrameArena Implementations.
+
+    /// <summary cref="IService::IFrameArena::Allocate">
+    ///   Implementation of IService::IFrameArena::Allocate.
+    /// </summary>
+    virtual void* Allocate( size_t Size, size_t Alignment );
+
+
+protected:
+
+    struct Block;
+    struct ThreadArena;
+
+    /// <summary>
+    ///   Gets the arena of the calling thread, creating it on first use.
+    /// </summary>
+    ThreadArena* GetThreadArena( void );
+
+    /// <summary>
+    ///   Takes a block of at least Size bytes from the heap.
+    /// </summary>
+    Block* NewBlock( ThreadArena* pArena, size_t Size );
+
+    static __thread_local ThreadArena*  sm_pThreadArena;
+
+    std::atomic<u32>                    m_Frame;
+    size_t                              m_BlockSize;
+    Bool                                m_bPoison;
+
+    std::mutex                          m_ArenasMutex;
+    std::vector<ThreadArena*>           m_Arenas;
+};
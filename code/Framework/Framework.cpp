@@ -18,6 +18,8 @@
 // interface
 #include "Interfaces/Interface.hpp"
 // stdlib
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <stdexcept>
 #include <string>
@@ -36,7 +38,12 @@
 #include "Framework/EnvironmentManager.hpp"
 #include "Framework/ServiceManager.hpp"
 #include "Framework/Scheduler.hpp"
+#include "Framework/Benchmark.hpp"
+#include "Framework/SceneCache.hpp"
+#include "Framework/PropertyQueue.hpp"
 #include "Framework/TaskManager.hpp"
+#include "Framework/Instrumentation.hpp"
+#include "Framework/FrameArena.hpp"
 #include "Framework/Framework.hpp"
 
 
@@ -60,12 +67,30 @@ EngineExecuteGDF( pcstr pszGDF)
     }
 }
 
+void
+EngineSetVariable( pcstr pszName, pcstr pszValue )
+{
+    // The first definition of a variable is the one used.
+    EnvironmentManager::getInstance().Variables().Add( pszName, pszValue );
+}
+
 Framework::Framework( void) 
     : m_pScheduler( nullptr )
+    , m_pBenchmark( nullptr )
     , m_pSceneCCM( nullptr )
     , m_pObjectCCM( nullptr )
     , m_bExecuteLoop( True )
+    , m_bPipelined( False )
+    , m_MaxFrameLag( 1 )
+    , m_aDistributions( nullptr )
+    , m_DistributionHead( 0 )
+    , m_DistributionCount( 0 )
+    , m_SceneFramesDeferred( 0 )
+    , m_LatencyTotal( 0.0f )
+    , m_LatencyFrames( 0 )
 {
+    std::fill( m_aLatencyHistogram, m_aLatencyHistogram + LatencyBuckets, 0 );
+
     // m_pScheduler is instantiated after the environment variables
     // in the config file are parsed
     
@@ -80,13 +105,26 @@ Framework::Framework( void)
     {
         std::cerr << "m_pSceneCCM == NULL" << std::endl;
     }
+
+    m_aDistributions = new Distribution[ ChangeManager::MaxBuffers ];
+    for ( u32 i = 0; i < ChangeManager::MaxBuffers; i++ )
+    {
+        m_aDistributions[ i ].pGroup = new TaskGroup();
+    }
 }
 
 Framework::~Framework( void)
 {
     SAFE_DELETE( m_pScheduler );
+    SAFE_DELETE( m_pBenchmark );
     SAFE_DELETE( m_pSceneCCM );
     SAFE_DELETE( m_pObjectCCM );
+
+    for ( u32 i = 0; i < ChangeManager::MaxBuffers; i++ )
+    {
+        SAFE_DELETE( m_aDistributions[ i ].pGroup );
+    }
+    delete [] m_aDistributions;
 }
 
 Error
@@ -122,37 +160,105 @@ Framework::Initialize( pcstr pszGDF)
         return Errors::Memory::OutOfMemory;
     }
 
+    // Use the compiled GDF if it is up to date, otherwise parse the XML.  When compiling, the
+    // XML is parsed and what the parser does is recorded.
+    IEnvironment::IVariables& Variables = EnvironmentManager::getInstance().Variables();
+    Bool bCompile = Variables.GetAsBool( "SceneCache::Compile", False );
+    std::string sCacheFile = SceneCache::GetCacheFile( pszGDF );
+    SceneCache Cache;
+
+    if ( !bCompile && Variables.GetAsBool( "SceneCache::Enabled", True ) &&
+         Cache.Load( sCacheFile.c_str() ) == Errors::Success )
+    {
+        std::clog << "Framework is loading the compiled GDF " << sCacheFile << std::endl;
+    }
+
     // Instantiate the parser, parse the environment variables in the GDF.
-    GDFParser Parser( m_pScene, oldpath.string());
+    GDFParser Parser( m_pScene, oldpath.string(), (bCompile || Cache.IsLoaded()) ? &Cache : nullptr );
     Parser.ParseEnvironment( pszGDF );
+
+    // Start capturing the trace if requested, the environment is known now.
+    Instrumentation::getInstance().Initialize();
+    FrameArena::getInstance().Initialize();
+
+    // Seed before the systems and objects are created so the run can be repeated.
+    if ( Benchmark::IsEnabled() )
+    {
+        m_pBenchmark = new Benchmark();
+        srand( m_pBenchmark->GetSeed() );
+    }
     
     // Register the framework as the system access provider.  The system access provider gives the
     // ability for systems to set the properties in other systems.
     ServiceManager::getInstance().RegisterSystemAccessProvider( this );
 
     // Instantiate the scheduler.
-    m_pScheduler = new Scheduler();
+    m_pScheduler = new Scheduler( m_pObjectCCM );
     if ( m_pScheduler == nullptr )
     {
         std::cerr << "m_pScheduler == NULL" << std::endl;
         return Errors::Memory::OutOfMemory;
     }
 
+    if ( m_pBenchmark != nullptr )
+    {
+        m_pScheduler->EnableBenchmarking();
+        m_pScheduler->SetFixedDeltaTime( m_pBenchmark->GetDeltaTime() );
+    }
+
     // Complete the parsing of the GDF and the initial scene.
     m_sNextScene = Parser.Parse( pszGDF );
     m_sNextScene = Parser.ParseScene( pszGDF, m_sNextScene );
 
+    if ( bCompile )
+    {
+        Cache.Write( sCacheFile.c_str() );
+
+        // Only compile, do not run the scene.
+        m_bExecuteLoop = False;
+        SAFE_DELETE( m_pBenchmark );
+    }
+
     // Set the initial scene for the scheduler.
     m_pScheduler->SetScene( m_pScene );
 
     return Errors::Success;
 }
 
+static void
+ReportQueueStatistics( pcstr pszName, ChangeManager* pCCM )
+{
+    ChangeManager::QueueStatistics Stats;
+    pCCM->GetQueueStatistics( Stats );
+
+    std::clog << pszName << " change queues: " << Stats.Threads << " threads, "
+              << Stats.ChunksUsed << " of " << Stats.ArenaChunks << " chunks of "
+              << Stats.ChunkSize << " used, " << Stats.OverflowChunks << " overflow chunks, high water mark "
+              << Stats.HighWaterMark << " notifications" << std::endl;
+}
+
 void
 Framework::Shutdown( void)
 {
     std::clog << "Shutting down Framework" << std::endl;
 
+    // Report the usage of the change queues so they can be sized in the GDF.
+    if ( EnvironmentManager::getInstance().Variables().GetAsBool( "ChangeManager::ReportQueues", False ) )
+    {
+        ReportQueueStatistics( "Object", m_pObjectCCM );
+        ReportQueueStatistics( "Scene", m_pSceneCCM );
+    }
+
+    // A simulation falling behind its fixed steps runs slower than real time.
+    if ( m_pScheduler != nullptr && m_pScheduler->GetDroppedSteps() > 0 )
+    {
+        std::clog << "Scheduler dropped " << m_pScheduler->GetDroppedSteps()
+                  << " fixed steps to keep up" << std::endl;
+    }
+
+    // Write the trace of the run.
+    Instrumentation::getInstance().Shutdown();
+
     // Get rid of the scene.
     SAFE_DELETE( m_pScene );
 
@@ -182,31 +288,105 @@ Framework::Execute( void)
     m_pObjectCCM->DistributeQueuedChanges();
     m_pSceneCCM->DistributeQueuedChanges();
 
+    // With pipelined frames the object changes of a frame are distributed while the next frame
+    // executes, systems which are not affected by them do not have to wait.  The frame lag is the
+    // number of frames a distribution may overlap, each needs its own notification buffer.
+    m_bPipelined = EnvironmentManager::getInstance().Variables().GetAsBool( "Framework::Pipelined", False );
+    m_MaxFrameLag = EnvironmentManager::getInstance().Variables().GetAsInt( "Framework::MaxFrameLag", 1 );
+    m_MaxFrameLag = std::min( std::max( m_MaxFrameLag, 1u ), ChangeManager::MaxBuffers - 1 );
+    Bool bReportLatency = EnvironmentManager::getInstance().Variables().GetAsBool( "Framework::ReportLatency", False );
+
+    if ( m_bPipelined )
+    {
+        m_pObjectCCM->SetBufferCount( m_MaxFrameLag + 1 );
+        m_pSceneCCM->SetBufferCount( 2 );
+    }
+
     // Set the runtime status to running.
     EnvironmentManager::getInstance().Runtime().SetStatus( IEnvironment::IRuntime::Status::Running );
 
     // Run through the main game loop.
     u32 StopAfterNFrames = EnvironmentManager::getInstance().Variables().GetAsInt( "StopAfterNFrames", 0 );
+    if ( m_pBenchmark != nullptr )
+    {
+        StopAfterNFrames = m_pBenchmark->GetFrames();
+    }
     u32 FrameCount = 0;
 
-    // Initialize resources necessary for parallel change distribution.
-    TaskManager::getInstance().PerThreadCallback( m_pObjectCCM->InitThreadLocalData, m_pObjectCCM );    
-    TaskManager::getInstance().PerThreadCallback( m_pSceneCCM->InitThreadLocalData, m_pSceneCCM ); 
+    // Variables can be retuned while running by editing the watched file.
+    auto& Variables = EnvironmentManager::getInstance().Variables();
+    std::string sWatchFile = Variables.GetAsString( "Environment::WatchFile", "" );
+    if ( !sWatchFile.empty() )
+    {
+        Variables.Watch( sWatchFile.c_str() );
+    }
+
+    TimePoint LoopStart = std::chrono::high_resolution_clock::now();
+    u32 ExecutedFrames = 0;
 
     while ( m_bExecuteLoop )
     {
+        TimePoint FrameStart = std::chrono::high_resolution_clock::now();
+
         // Call the scheduler to have the systems internally update themselves.
-        m_pScheduler->Execute();
+        Bool bExecuted = m_pScheduler->Execute();
+
+        if ( !m_bPipelined )
+        {
+            // Set any properties that may have been issued for change.  Any propeties that correlate
+            // to system change notifications will be added to the change controller by the system.
+            // NOTE: This is still untested as noone is using it.
+            IssuePendingSystemPropertyChanges();
+
+            // Distribute changes for object and scene CCMs.  The UObject propagates some object
+            // messages up to the scene CCM so it needs to go first.
+            m_pObjectCCM->DistributeQueuedChanges();
+            m_pSceneCCM->DistributeQueuedChanges();
+
+            if ( bExecuted )
+            {
+                RecordLatency( std::chrono::duration<f32, std::ratio<1>>(
+                    std::chrono::high_resolution_clock::now() - FrameStart ).count() );
+            }
+        }
+        else if ( bExecuted )
+        {
+            // Setting properties touches the systems directly, so the distributions of the
+            // earlier frames have to be finished first.
+            if ( HasPendingSystemPropertyChanges() )
+            {
+                WaitForDistributions( 0 );
+            }
+            IssuePendingSystemPropertyChanges();
+
+            // Make room for this frame's distribution and start it once the scene changes are
+            // out of the way.  The scene changes the UObject propagates during the distribution
+            // arrive with a later frame.
+            WaitForDistributions( m_MaxFrameLag - 1 );
+            DistributeSceneChanges();
+            QueueDistribution( FrameStart );
+        }
+
+        if ( bExecuted )
+        {
+            ExecutedFrames++;
 
-        // Set any properties that may have been issued for change.  Any propeties that correlate
-        // to system change notifications will be added to the change controller by the system.
-        // NOTE: This is still untested as noone is using it.
-        IssuePendingSystemPropertyChanges();
+            if ( m_pBenchmark != nullptr )
+            {
+                m_pBenchmark->RecordFrame( FrameStart, std::chrono::high_resolution_clock::now(), m_pScheduler );
+            }
+
+            // The memory the systems took from the frame arenas two frames ago can be reused.
+            FrameArena::getInstance().EndFrame();
+        }
 
-        // Distribute changes for object and scene CCMs.  The UObject propagates some object
-        // messages up to the scene CCM so it needs to go first.
-        m_pObjectCCM->DistributeQueuedChanges();
-        m_pSceneCCM->DistributeQueuedChanges();
+        // Republish the watched variables between frames, after the background distributions
+        // stopped reading them.
+        if ( Variables.IsWatchedFileChanged() )
+        {
+            WaitForDistributions( 0 );
+            Variables.ReloadWatchedFile();
+        }
 
         // Check with the environment manager if there is a change in the runtime status to quit.
         if ( EnvironmentManager::getInstance().Runtime().GetStatus() ==
@@ -225,10 +405,154 @@ Framework::Execute( void)
         }
     }
 
+    // Deliver whatever is still in flight before the scene goes away.
+    WaitForDistributions( 0 );
+
+    if ( bReportLatency )
+    {
+        ReportLatency( ExecutedFrames, std::chrono::duration<f32, std::ratio<1>>(
+            std::chrono::high_resolution_clock::now() - LoopStart ).count() );
+    }
+
+    if ( m_pBenchmark != nullptr )
+    {
+        m_pBenchmark->WriteReport( m_sGDF.c_str() );
+    }
+
     return Errors::Success;
 }
 
 
+void
+Framework::QueueDistribution( TimePoint FrameStart )
+{
+    System::Types::BitMask Systems;
+    System::Changes::BitMask Changes;
+    u32 Buffer = m_pObjectCCM->SwapBuffers( Systems, Changes );
+
+    if ( Changes == System::Changes::None )
+    {
+        RecordLatency( std::chrono::duration<f32, std::ratio<1>>(
+            std::chrono::high_resolution_clock::now() - FrameStart ).count() );
+        return;
+    }
+
+    // The observers may post changes in turn which are delivered along with the others.
+    Systems = m_pScheduler->GetAffectedSystems( Systems );
+
+    u32 Slot = (m_DistributionHead + m_DistributionCount) % ChangeManager::MaxBuffers;
+    Distribution* pDistribution = &m_aDistributions[ Slot ];
+    pDistribution->FrameStart = FrameStart;
+
+    // The scheduler holds the systems back from the moment the distribution can start.
+    m_pScheduler->AddPendingDistribution( Systems, pDistribution->pGroup );
+
+    ChangeManager* pObjectCCM = m_pObjectCCM;
+    Scheduler* pScheduler = m_pScheduler;
+    auto Distribute = [=] ()
+    {
+        pObjectCCM->DistributeBufferedChanges( Buffer );
+
+        pDistribution->Latency = std::chrono::duration<f32, std::ratio<1>>(
+            std::chrono::high_resolution_clock::now() - pDistribution->FrameStart ).count();
+
+        pScheduler->FinishDistribution( pDistribution->pGroup );
+    };
+
+    // Buffers have to be distributed in order, so chain to the previous distribution.  A
+    // thread helping out within it may pick this one up, so it must not wait for it.
+    if ( m_DistributionCount > 0 )
+    {
+        TaskGroup* pPrevious = m_aDistributions[ (Slot + ChangeManager::MaxBuffers - 1) % ChangeManager::MaxBuffers ].pGroup;
+        TaskManager::getInstance().AddTaskAfter( *pDistribution->pGroup, *pPrevious, Distribute );
+    }
+    else
+    {
+        TaskManager::getInstance().AddTask( *pDistribution->pGroup, Distribute );
+    }
+
+    m_DistributionCount++;
+}
+
+
+void
+Framework::DistributeSceneChanges( void )
+{
+    // The background distributions post the changes the UObjects propagate to the scene CCM,
+    // so it can only be swapped once none of them is running.  Retire the ones that are done
+    // and hold the scene changes back for no more frames than the allowed lag.
+    while ( m_DistributionCount > 0 && m_aDistributions[ m_DistributionHead ].pGroup->IsDone() )
+    {
+        WaitForDistributions( m_DistributionCount - 1 );
+    }
+    if ( m_DistributionCount > 0 && ++m_SceneFramesDeferred < m_MaxFrameLag )
+    {
+        return;
+    }
+    WaitForDistributions( 0 );
+    m_SceneFramesDeferred = 0;
+
+    System::Types::BitMask Systems;
+    System::Changes::BitMask Changes;
+    u32 Buffer = m_pSceneCCM->SwapBuffers( Systems, Changes );
+
+    m_pSceneCCM->DistributeBufferedChanges( Buffer );
+}
+
+
+void
+Framework::WaitForDistributions( u32 MaxPending )
+{
+    while ( m_DistributionCount > MaxPending )
+    {
+        Distribution& Oldest = m_aDistributions[ m_DistributionHead ];
+        TaskManager::getInstance().WaitForTaskGroup( *Oldest.pGroup );
+        RecordLatency( Oldest.Latency );
+
+        m_DistributionHead = (m_DistributionHead + 1) % ChangeManager::MaxBuffers;
+        m_DistributionCount--;
+    }
+}
+
+
+void
+Framework::RecordLatency( f32 Latency )
+{
+    u32 Bucket = 0;
+    while ( Bucket < LatencyBuckets - 1 && Latency * 1000.0f >= (f32)(1 << Bucket) )
+    {
+        Bucket++;
+    }
+
+    m_aLatencyHistogram[ Bucket ]++;
+    m_LatencyTotal += Latency;
+    m_LatencyFrames++;
+}
+
+
+void
+Framework::ReportLatency( u32 Frames, f32 Seconds ) const
+{
+    std::clog << "Frame latency, " << (m_bPipelined ? "pipelined" : "not pipelined")
+              << ", " << Frames << " frames in " << Seconds << "s ("
+              << (Seconds > 0.0f ? Frames / Seconds : 0.0f) << " frames/s), average "
+              << (m_LatencyFrames ? m_LatencyTotal * 1000.0f / m_LatencyFrames : 0.0f) << "ms" << std::endl;
+
+    for ( u32 i = 0; i < LatencyBuckets; i++ )
+    {
+        if ( i < LatencyBuckets - 1 )
+        {
+            std::clog << "  < " << (1 << i) << "ms: ";
+        }
+        else
+        {
+            std::clog << " >= " << (1 << (i - 1)) << "ms: ";
+        }
+        std::clog << m_aLatencyHistogram[ i ] << std::endl;
+    }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // IService::ISystemAccess Implementations.
 
@@ -333,7 +657,7 @@ Framework::GetSystemObject( System::Type Type, pcstr pszName)
 void
 Framework::GetSystemProperty( Handle hSystem, InOut Properties::Property& Property)
 {
-    std::string sPropertyName = Property.GetName();
+    Base::StringId PropertyId = Property.GetNameId();
 
     // Reinterpret the handle as an ISystem.
     if ( hSystem == nullptr)
@@ -349,7 +673,7 @@ Framework::GetSystemProperty( Handle hSystem, InOut Properties::Property& Proper
     bool bFound = false;
     for (auto & aPropertie : aProperties)
     {
-        if ( sPropertyName == aPropertie.GetName() )
+        if ( PropertyId == aPropertie.GetNameId() )
         {
             Property = aPropertie;
             bFound = true;
@@ -381,10 +705,7 @@ Framework::SetSystemProperty(
     //GetSystemProperty( hSystem, TempProperty );
 #endif
 
-    PropertyIssue pi = { System::System, pSystem->GetSystemType(), hSystem, Property };
-
-    std::lock_guard<std::mutex> lock(m_PropertyIssuesMutex);
-    m_PropertyIssues.push_back( pi );
+    m_PropertyQueue.Push( System::System, pSystem->GetSystemType(), hSystem, Property );
 }
 
 
@@ -394,7 +715,7 @@ Framework::GetSceneProperty(
     InOut Properties::Property& Property
     )
 {
-    std::string sPropertyName = Property.GetName();
+    Base::StringId PropertyId = Property.GetNameId();
 
     // Reinterpret the handle as an ISystem.
     if ( hScene == nullptr)
@@ -410,7 +731,7 @@ Framework::GetSceneProperty(
     Bool bFound = False;
     for (auto & aPropertie : aProperties)
     {
-        if ( sPropertyName == aPropertie.GetName() )
+        if ( PropertyId == aPropertie.GetNameId() )
         {
             Property = aPropertie;
             bFound = True;
@@ -443,11 +764,7 @@ Framework::SetSceneProperty(
     //GetSceneProperty( hScene, TempProperty );
 #endif
 
-    PropertyIssue pi = { System::Scene, pSystemScene->GetSystemType(),
-                         hScene, Property };
-
-    std::lock_guard<std::mutex> lock(m_PropertyIssuesMutex);
-    m_PropertyIssues.push_back( pi );
+    m_PropertyQueue.Push( System::Scene, pSystemScene->GetSystemType(), hScene, Property );
 }
 
 
@@ -457,7 +774,7 @@ Framework::GetObjectProperty(
     InOut Properties::Property& Property
     )
 {
-    std::string sPropertyName = Property.GetName();
+    Base::StringId PropertyId = Property.GetNameId();
 
     // Reinterpret the handle as an ISystemScene.
     if ( hObject == nullptr)
@@ -475,7 +792,7 @@ Framework::GetObjectProperty(
     Bool bFound = False;
     for (auto & aPropertie : aProperties)
     {
-        if ( sPropertyName == aPropertie.GetName() )
+        if ( PropertyId == aPropertie.GetNameId() )
         {
             Property = aPropertie;
             bFound = True;
@@ -507,11 +824,7 @@ Framework::SetObjectProperty(
     //GetObjectProperty( hObject, TempProperty );
 #endif
 
-    PropertyIssue pi = { System::Object, pSystemObject->GetSystemType(),
-                         hObject, Property };
-
-    std::lock_guard<std::mutex> lock(m_PropertyIssuesMutex);
-    m_PropertyIssues.push_back( pi );
+    m_PropertyQueue.Push( System::Object, pSystemObject->GetSystemType(), hObject, Property );
 }
 
 
@@ -521,67 +834,485 @@ Framework::IssuePendingSystemPropertyChanges(
     )
 {
     //
-    // Create an array used for setting the property.
+    // Background distributions may still queue new changes, those are issued the next time.
     //
-    Properties::Array aProperties( 1 );
+    m_PropertyQueue.Issue( SystemTypes );
+}
+
+
+Bool
+Framework::HasPendingSystemPropertyChanges(
+    void
+    )
+{
+    return !m_PropertyQueue.IsEmpty();
+}
 
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Framework::GDFParser Implementations.
+Framework::GDFParser::GDFParser(
+    UScene* pScene,
+    std::string sOldpath,
+    SceneCache* pCache
+    )
+    : m_pScene( pScene ),
+      m_sOldpath( sOldpath ),
+      m_pCache( pCache )
+{
+}
+
+
+Bool
+Framework::GDFParser::IsRecording( void ) const
+{
+    return m_pCache != nullptr && !m_pCache->IsLoaded();
+}
+
+
+void
+Framework::GDFParser::RecordSource( pcstr pszFile )
+{
+    if ( IsRecording() )
+    {
+        m_pCache->AddSource( pszFile );
+    }
+}
+
+
+void
+Framework::GDFParser::LoadSystem( pcstr pszType, pcstr pszLib )
+{
     //
-    // Iterate through all the properties to issue.
+    // Load the system library, or stand in for it when running headless.
     //
-    for (auto & pi : m_PropertyIssues)
+    if ( Benchmark::IsNullSystem( pszType ) )
     {
-        //
-        // Get the property to issue.
-        //
+        SystemManager::getInstance().CreateNullSystem( pszType, &m_pSystem );
+    }
+    else
+    {
+        SystemManager::getInstance().LoadSystemLibrary( std::string( pszLib ), m_sOldpath, &m_pSystem );
+    }
+}
+
+
+void
+Framework::GDFParser::ExtendScenes( void )
+{
+    //
+    // Create the initial scene for each system.
+    //
+    ISystem* pSystem = SystemManager::getInstance().GetFirst();
+
+    while ( pSystem != nullptr )
+    {
+        m_pScene->Extend( pSystem );
+
+        pSystem = SystemManager::getInstance().GetNext();
+    }
+
+    //
+    // Remove all the object properties.
+    //
+    m_AllObjectProperties.clear();
+}
+
+
+void
+Framework::GDFParser::SetSceneStatus( ISystemScene::GlobalSceneStatus Status )
+{
+    const UScene::SystemScenes Scenes = m_pScene->GetSystemScenes();
+    for (auto & Scene : Scenes)
+    {
+        Scene.second->GlobalSceneStatusChanged( Status );
+    }
+}
+
+
+void
+Framework::GDFParser::CreateObject( void )
+{
+    m_pszObjectName = nullptr;
+
+    //
+    // Create the object and add the required geometry extension.
+    //
+    m_pUObject = m_pScene->CreateObject();
+    if (m_pUObject == nullptr)
+    {
+        std::cerr << "m_pUObject == NULL" << std::endl;
+    }
+
+    auto it = m_pScene->GetSystemScenes().find( System::Types::Geometry );
         
+    if (it == m_pScene->GetSystemScenes().end())
+    {
+        std::cerr << "The geometry system has to have already been loaded." << std::endl;
+    }
+
+    ISystemScene* pGeometryScene = it->second;
+    if (pGeometryScene == nullptr)
+    {
+        std::cerr << "pGeometryScene == NULL" << std::endl;
+    }
+
+    ExtendObject( pGeometryScene, nullptr );
+
+    //
+    // Ready the propeties map for setting the properties.
+    //
+    m_SetPropertiesMap.clear();
+
+    m_SetPropertiesMap[ System::Types::Geometry ] = Properties::Array();
+}
+
+
+ISystemObject*
+Framework::GDFParser::ExtendObject( ISystemScene* pSystemScene, pcstr pszType )
+{
+    ISystemObject* pSystemObject = m_pUObject->Extend( pSystemScene, pszType );
+
+    if ( pSystemObject != nullptr && pSystemScene->IsObjectInitializeThreadSafe( pszType ) )
+    {
+        m_ConcurrentObjects.insert( pSystemObject );
+    }
+
+    return pSystemObject;
+}
+
+
+void
+Framework::GDFParser::CreateLinks( void )
+{
+    for ( const auto& Entry : m_Links )
+    {
+        if ( Entry.pSystemSubject != nullptr )
+        {
+            m_pScene->CreateObjectLink( Entry.pSystemSubject, Entry.pSystemObserver );
+        }
+        else
+        {
+            m_pScene->CreateObjectLink( Entry.pSubject, Entry.pSystemObserver );
+        }
+    }
+    m_Links.clear();
+}
+
+
+void
+Framework::GDFParser::InitializeObjects( void )
+{
+    auto Start = std::chrono::high_resolution_clock::now();
+
+    //
+    // Sort the extensions into those that can be initialized concurrently and the others.
+    //
+    typedef std::pair<ISystemObject*, Properties::Array*> Initialization;
+    std::vector<Initialization> aConcurrent;
+    std::vector<Initialization> aSerial;
+
+    for (auto & elem : m_AllObjectProperties)
+    {
+        UObject* pUObject = elem.first;
+
+        for (auto & _it : elem.second)
+        {
+            //
+            // Get the extension.
+            //
+            ISystemObject* pObject = pUObject->GetExtension( _it.first );
+            if ( pObject == nullptr)
+            {
+                std::cerr << "pObject == NULL" << std::endl;
+            }
+            else if ( m_ConcurrentObjects.count( pObject ) != 0 )
+            {
+                aConcurrent.push_back( Initialization( pObject, &_it.second ) );
+            }
+            else
+            {
+                aSerial.push_back( Initialization( pObject, &_it.second ) );
+            }
+        }
+    }
+
+    //
+    // Hand the concurrent extensions to the task manager in a few chunks per thread and
+    //  initialize the others on this thread meanwhile.
+    //
+    TaskManager& Tasks = TaskManager::getInstance();
+    TaskGroup Group;
+
+    u32 Chunks = std::max<u32>( Tasks.GetNumberOfThreads(), 1 ) * 4;
+    u32 ChunkSize = std::max<u32>( ((u32)aConcurrent.size() + Chunks - 1) / Chunks, 1 );
+    const Initialization* pConcurrent = aConcurrent.data();
+
+    for ( u32 Begin = 0; Begin < (u32)aConcurrent.size(); Begin += ChunkSize )
+    {
+        u32 End = std::min<u32>( Begin + ChunkSize, (u32)aConcurrent.size() );
+
+        Tasks.AddTask( Group, [pConcurrent, Begin, End] ()
+        {
+            for ( u32 i = Begin; i < End; i++ )
+            {
+                pConcurrent[ i ].first->Initialize( *pConcurrent[ i ].second );
+            }
+        });
+    }
+
+    for ( const auto& Entry : aSerial )
+    {
+        Entry.first->Initialize( *Entry.second );
+    }
+
+    Tasks.WaitForTaskGroup( Group );
+
+    std::clog << "Parser initialized " << aConcurrent.size() + aSerial.size() << " object extensions ("
+              << aConcurrent.size() << " concurrently) in "
+              << std::chrono::duration<f32, std::milli>( std::chrono::high_resolution_clock::now() - Start ).count()
+              << "ms" << std::endl;
+
+    m_AllObjectProperties.clear();
+    m_ConcurrentObjects.clear();
+}
+
+
+void
+Framework::GDFParser::Replay( const SceneCache::Operation* pOperations, u32 Count )
+{
+    Properties::Array GetProperties;
+
+    for ( u32 i = 0; i < Count; i++ )
+    {
+        const SceneCache::Operation& Operation = pOperations[ i ];
+        const u32* Args = Operation.Args;
+
+        switch ( Operation.Code )
+        {
+        case SceneCache::Operation::SetVariable:
+            EnvironmentManager::getInstance().Variables().Add(
+                m_pCache->GetString( Args[ 0 ] ), m_pCache->GetString( Args[ 1 ] ) );
+            break;
+
+        case SceneCache::Operation::LoadSystem:
+            LoadSystem( m_pCache->GetString( Args[ 0 ] ), m_pCache->GetString( Args[ 1 ] ) );
+            if ( m_pSystem == nullptr )
+            {
+                std::cerr << "Parser could not load the system " << m_pCache->GetString( Args[ 1 ] ) << "." << std::endl;
+            }
+            break;
+
+        case SceneCache::Operation::InitializeSystem:
+            if ( m_pSystem != nullptr )
+            {
+                Properties::Array SetProperties;
+                GetProperties.clear();
+                m_pSystem->GetProperties( GetProperties );
+                GetCachedProperties( Args[ 0 ], Args[ 1 ], GetProperties, SetProperties );
+                m_pSystem->Initialize( SetProperties );
+            }
+            break;
+
+        case SceneCache::Operation::SetNextScene:
+            m_sNextScene = m_pCache->GetString( Args[ 0 ] );
+            break;
+
+        case SceneCache::Operation::ExtendScenes:
+            ExtendScenes();
+            break;
+
+        case SceneCache::Operation::InitializeScene:
+        {
+            auto it = m_pScene->GetSystemScenes().find( Args[ 0 ] );
+            if ( it == m_pScene->GetSystemScenes().end() )
+            {
+                std::cerr << "Parser was unable to find a scene for system type " << Args[ 0 ] << "." << std::endl;
+            }
+            else
+            {
+                Properties::Array SetProperties;
+                GetProperties.clear();
+                it->second->GetProperties( GetProperties );
+                GetCachedProperties( Args[ 1 ], Args[ 2 ], GetProperties, SetProperties );
+                it->second->Initialize( SetProperties );
+            }
+            break;
+        }
+
+        case SceneCache::Operation::PreLoadingObjects:
+            SetSceneStatus( ISystemScene::GlobalSceneStatus::PreLoadingObjects );
+            break;
+
+        case SceneCache::Operation::CreateObject:
+            CreateObject();
+            break;
+
+        case SceneCache::Operation::SetObjectName:
+            m_pUObject->SetName( m_pCache->GetString( Args[ 0 ] ) );
+            break;
+
+        case SceneCache::Operation::ExtendObject:
+        {
+            auto it = m_pScene->GetSystemScenes().find( Args[ 0 ] );
+            if ( it == m_pScene->GetSystemScenes().end() )
+            {
+                std::cerr << "Parser was unable to find a scene for system type " << Args[ 0 ] << "." << std::endl;
+            }
+            else
+            {
+                pcstr pszType = Args[ 1 ] != SceneCache::NoString ? m_pCache->GetString( Args[ 1 ] ) : nullptr;
+                if ( ExtendObject( it->second, pszType ) == nullptr )
+                {
+                    std::cerr << "m_pSystemObject == NULL" << std::endl;
+                }
+            }
+            break;
+        }
+
+        case SceneCache::Operation::SetObjectProperties:
+        {
+            Properties::Array& SetProperties = m_AllObjectProperties[ m_pUObject ][ Args[ 0 ] ];
+            ISystemObject* pObject = m_pUObject->GetExtension( Args[ 0 ] );
+            if ( pObject != nullptr )
+            {
+                GetProperties.clear();
+                pObject->GetProperties( GetProperties );
+                GetCachedProperties( Args[ 1 ], Args[ 2 ], GetProperties, SetProperties );
+            }
+            break;
+        }
+
+        case SceneCache::Operation::CreateLink:
+        {
+            UObject* pSubject = m_pScene->FindObject( m_pCache->GetString( Args[ 0 ] ) );
+            UObject* pObserver = m_pScene->FindObject( m_pCache->GetString( Args[ 1 ] ) );
+            ISystemObject* pSystemObserver = pObserver != nullptr ? pObserver->GetExtension( Args[ 3 ] ) : nullptr;
+
+            if ( pSubject == nullptr || pSystemObserver == nullptr )
+            {
+                std::cerr << "Parser could not link " << m_pCache->GetString( Args[ 0 ] ) << " to "
+                          << m_pCache->GetString( Args[ 1 ] ) << "." << std::endl;
+            }
+            else
+            {
+                Link Entry = { pSubject, Args[ 2 ] != System::Types::Null ? pSubject->GetExtension( Args[ 2 ] ) : nullptr, pSystemObserver };
+                m_Links.push_back( Entry );
+            }
+            break;
+        }
+
+        case SceneCache::Operation::PostLoadingObjects:
+            CreateLinks();
+            InitializeObjects();
+            SetSceneStatus( ISystemScene::GlobalSceneStatus::PostLoadingObjects );
+            break;
+
+        default:
+            std::cerr << "Parser found an unknown operation " << Operation.Code << " in the compiled GDF." << std::endl;
+            break;
+        }
+    }
+
+    CreateLinks();
+}
+
+
+void
+Framework::GDFParser::GetCachedProperties(
+    u32 First,
+    u32 Count,
+    const Properties::Array& GetProperties,
+    Properties::Array& SetProperties
+    ) const
+{
+    for ( u32 i = First; i < First + Count; i++ )
+    {
+        const SceneCache::Property& Cached = m_pCache->GetProperty( i );
+        pcstr pszName = m_pCache->GetString( Cached.Name );
+        Base::StringId NameId = Base::InternString( pszName );
 
         //
-        // Check if the schuler will allow issuing the property change.
+        // Search for the name in the property array, the values were converted when compiling.
         //
-        if ( pi.SystemType & SystemTypes )
+        Properties::ConstIterator it;
+        for ( it=GetProperties.begin(); it != GetProperties.end(); it++ )
+        {
+            if ( it->GetNameId() == NameId )
+            {
+                break;
+            }
+        }
+
+        if ( it == GetProperties.end() )
+        {
+            std::cerr << "Parser did not find the compiled property " << pszName << "." << std::endl;
+            continue;
+        }
+
+        u32 Type = 0;
+        for ( u32 iValue=0; iValue < Properties::Values::Count; iValue++ )
         {
-            aProperties[ 0 ] = pi.Property;
+            Type |= it->GetValueType( iValue ) << (iValue * 8);
+        }
+
+        if ( Type != Cached.Type )
+        {
+            std::cerr << "Parser found the compiled property " << pszName << " to have changed its type." << std::endl;
+            continue;
+        }
 
-            switch ( pi.SystemComponent )
+        SetProperties.push_back( *it );
+        Properties::Property& Property = SetProperties.back();
+
+        for ( u32 iValue=0; iValue < Properties::Values::Count; iValue++ )
+        {
+            switch ( Property.GetValueType( iValue ) )
             {
-            case System::System:
-                reinterpret_cast<ISystem*>(pi.hItem)->SetProperties( aProperties );
+            case Properties::Values::None:
                 break;
 
-            case System::Scene:
-                reinterpret_cast<ISystemScene*>(pi.hItem)->SetProperties( aProperties );
+            case Properties::Values::Boolean:
+            case Properties::Values::Enum:
+            case Properties::Values::Int32:
+                Property.SetValue( iValue, (i32)Cached.Values[ iValue ] );
                 break;
 
-            case System::Object:
-                reinterpret_cast<ISystemObject*>(pi.hItem)->SetProperties( aProperties );
+            case Properties::Values::String:
+            case Properties::Values::Path:
+                Property.SetValue( iValue, std::string( m_pCache->GetString( Cached.Values[ iValue ] ) ) );
                 break;
 
             default:
-                std::cerr << "Unhandled case." << std::endl;
+            {
+                f32 Value;
+                memcpy( &Value, &Cached.Values[ iValue ], sizeof Value );
+                Property.SetValue( iValue, Value );
                 break;
-            };
+            }
+            }
         }
     }
-
-    m_PropertyIssues.clear();
-}
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// Framework::GDFParser Implementations.
-Framework::GDFParser::GDFParser(
-    UScene* pScene,
-    std::string sOldpath
-    )
-    : m_pScene( pScene ),
-      m_sOldpath( sOldpath )
-{
 }
 
 
 void
 Framework::GDFParser::ParseEnvironment( std::string sGDF)
 {
+    if ( m_pCache != nullptr && m_pCache->IsLoaded() )
+    {
+        u32 Count;
+        const SceneCache::Operation* pOperations =
+            m_pCache->GetOperations( SceneCache::Environment, nullptr, Count );
+        Replay( pOperations, Count );
+        return;
+    }
+
+    if ( IsRecording() )
+    {
+        m_pCache->BeginSection( SceneCache::Environment );
+    }
+
     // Load the gdf xml file.
     TiXmlDocument   XmlDoc( sGDF.c_str() );
 
@@ -589,6 +1320,7 @@ Framework::GDFParser::ParseEnvironment( std::string sGDF)
     {
         std::cerr << "Parser was unable to load GDF file " << sGDF.c_str() << "." << std::endl;
     }
+    RecordSource( sGDF.c_str() );
 
     // Find the "environment" element.
     TiXmlElement* pElement = XmlDoc.FirstChildElement();
@@ -621,6 +1353,39 @@ Framework::GDFParser::ParseEnvironment( std::string sGDF)
 const std::string 
 Framework::GDFParser::Parse( std::string sGDF)
 {
+    if ( m_pCache != nullptr && m_pCache->IsLoaded() )
+    {
+        u32 Count;
+        const SceneCache::Operation* pOperations =
+            m_pCache->GetOperations( SceneCache::Systems, nullptr, Count );
+
+        // The systems replaced for benchmarking have to be the same as when compiling.
+        Bool bNullSystemsMatch = True;
+        for ( u32 i = 0; i < Count; i++ )
+        {
+            if ( pOperations[ i ].Code == SceneCache::Operation::LoadSystem &&
+                 pOperations[ i ].Args[ 2 ] != Benchmark::IsNullSystem( m_pCache->GetString( pOperations[ i ].Args[ 0 ] ) ) )
+            {
+                bNullSystemsMatch = False;
+            }
+        }
+
+        if ( bNullSystemsMatch )
+        {
+            Replay( pOperations, Count );
+            return m_sNextScene;
+        }
+
+        std::clog << "Parser ignores the compiled GDF, it was compiled with different null systems." << std::endl;
+        m_pCache->Unload();
+        m_pCache = nullptr;
+    }
+
+    if ( IsRecording() )
+    {
+        m_pCache->BeginSection( SceneCache::Systems );
+    }
+
     // Load the gdf xml file.
     TiXmlDocument   XmlDoc( sGDF.c_str() );
 
@@ -653,6 +1418,25 @@ Framework::GDFParser::ParseScene( std::string sGDF, std::string sScene)
         std::cerr << "Parser does not have a scene to parse." << std::endl;
     }
 
+    if ( m_pCache != nullptr && m_pCache->IsLoaded() )
+    {
+        u32 Count;
+        const SceneCache::Operation* pOperations =
+            m_pCache->GetOperations( SceneCache::Scene, sScene.c_str(), Count );
+
+        // Scenes which were not compiled are read from the XML.
+        if ( pOperations != nullptr )
+        {
+            Replay( pOperations, Count );
+            return m_sNextScene;
+        }
+    }
+
+    if ( IsRecording() )
+    {
+        m_pCache->BeginSection( SceneCache::Scene, sScene.c_str() );
+    }
+
     // Load the gdf xml file.
     TiXmlDocument   XmlDoc( sGDF.c_str() );
 
@@ -873,22 +1657,12 @@ Framework::GDFParser::BeginElement( void* pElement)
 
         if ( m_SceneLevel == 0 )
         {
-            //
-            // Create the initial scene for each system.
-            //
-            ISystem* pSystem = SystemManager::getInstance().GetFirst();
+            ExtendScenes();
 
-            while ( pSystem != nullptr )
+            if ( IsRecording() )
             {
-                m_pScene->Extend( pSystem );
-
-                pSystem = SystemManager::getInstance().GetNext();
+                m_pCache->AddOperation( SceneCache::Operation::ExtendScenes );
             }
-
-            //
-            // Remove all the object properties.
-            //
-            m_AllObjectProperties.clear();
         }
 
         m_GdfMarker = GDFM_Scene;
@@ -914,12 +1688,11 @@ Framework::GDFParser::BeginElement( void* pElement)
         {
             m_FirstObjectsMarker = False;
 
-            const UScene::SystemScenes Scenes = m_pScene->GetSystemScenes();
-            for (auto & Scene : Scenes)
+            SetSceneStatus( ISystemScene::GlobalSceneStatus::PreLoadingObjects );
+
+            if ( IsRecording() )
             {
-                Scene.second->GlobalSceneStatusChanged(
-                    ISystemScene::GlobalSceneStatus::PreLoadingObjects
-                    );
+                m_pCache->AddOperation( SceneCache::Operation::PreLoadingObjects );
             }
         }
     }
@@ -936,38 +1709,12 @@ Framework::GDFParser::BeginElement( void* pElement)
         {
             if ( m_ObjectLevel == 0 )
             {
-                m_pszObjectName = nullptr;
+                CreateObject();
 
-                //
-                // Create the object and add the required geometry extension.
-                //
-                m_pUObject = m_pScene->CreateObject();
-                if (m_pUObject == nullptr)
-                {
-                    std::cerr << "m_pUObject == NULL" << std::endl;
-                }
-
-                auto it = m_pScene->GetSystemScenes().find( System::Types::Geometry );
-                    
-                if (it == m_pScene->GetSystemScenes().end())
+                if ( IsRecording() )
                 {
-                    std::cerr << "The geometry system has to have already been loaded." << std::endl;
+                    m_pCache->AddOperation( SceneCache::Operation::CreateObject );
                 }
-
-                ISystemScene* pGeometryScene = it->second;
-                if (pGeometryScene == nullptr)
-                {
-                    std::cerr << "pGeometryScene == NULL" << std::endl;
-                }
-
-                m_pUObject->Extend( pGeometryScene, nullptr );
-
-                //
-                // Ready the propeties map for setting the properties.
-                //
-                m_SetPropertiesMap.clear();
-
-                m_SetPropertiesMap[ System::Types::Geometry ] = Properties::Array();
             }
 
             m_GdfMarker = GDFM_Object;
@@ -1179,6 +1926,13 @@ Framework::GDFParser::EndElement(
         {
             if ( m_SystemLevel == 0 )
             {
+                if ( IsRecording() )
+                {
+                    m_pCache->AddOperation( SceneCache::Operation::InitializeSystem,
+                                            m_pCache->AddProperties( m_SetProperties ),
+                                            (u32)m_SetProperties.size() );
+                }
+
                 m_pSystem->Initialize( m_SetProperties );
                 m_GetProperties.clear();
                 m_SetProperties.clear();
@@ -1218,6 +1972,12 @@ Framework::GDFParser::EndElement(
 
             m_GdfMarker = GDFM_Scenes;
 
+            //
+            // Register the links once all the objects they refer to exist.  Registering with the
+            // change manager is not thread safe, so this is done before the objects are initialized.
+            //
+            CreateLinks();
+
             //
             // Initialize all the objects and Send "post-loading objects" message to the scene extensions.
             //
@@ -1225,46 +1985,12 @@ Framework::GDFParser::EndElement(
             {
                 m_FirstObjectsMarker = True;
 
-                //
-                // Initialize all the objects at once.
-                //
-                for (auto & elem : m_AllObjectProperties)
-                {
-                    UObject* pUObject = elem.first;
-
-                    for (auto & _it : elem.second)
-                    {
-                        //
-                        // Get the extension.
-                        //
-                        ISystemObject* pObject = pUObject->GetExtension( _it.first );
-                        if ( pObject == nullptr)
-                        {
-                            std::cerr << "pObject == NULL" << std::endl;
-                        }
-
-                        //
-                        // Initialize the extension.
-                        //
-                        if ( pObject != nullptr )
-                        {
-                            pObject->Initialize( _it.second );
-                        }
+                InitializeObjects();
+                SetSceneStatus( ISystemScene::GlobalSceneStatus::PostLoadingObjects );
 
-                        //
-                        // Remove all the properties.
-                        //
-                        _it.second.clear();
-                    }
-                }
-                m_AllObjectProperties.clear();
-
-                const UScene::SystemScenes Scenes = m_pScene->GetSystemScenes();
-                for (auto & Scene : Scenes)
+                if ( IsRecording() )
                 {
-                    Scene.second->GlobalSceneStatusChanged(
-                        ISystemScene::GlobalSceneStatus::PostLoadingObjects
-                        );
+                    m_pCache->AddOperation( SceneCache::Operation::PostLoadingObjects );
                 }
             }
         }
@@ -1318,6 +2044,16 @@ Framework::GDFParser::EndElement(
                     std::cerr << "A UObject should have already been created by this point." << std::endl;
                 }
 
+                if ( IsRecording() )
+                {
+                    for ( const auto& it : m_SetPropertiesMap )
+                    {
+                        m_pCache->AddOperation( SceneCache::Operation::SetObjectProperties, it.first,
+                                                m_pCache->AddProperties( it.second ),
+                                                (u32)it.second.size() );
+                    }
+                }
+
                 //
                 // Add this object's properties to the global collection.
                 //
@@ -1366,6 +2102,14 @@ Framework::GDFParser::EndElement(
                     }
                     else
                     {
+                        if ( IsRecording() )
+                        {
+                            m_pCache->AddOperation( SceneCache::Operation::InitializeScene,
+                                                    m_pSystemScene->GetSystemType(),
+                                                    m_pCache->AddProperties( m_SetProperties ),
+                                                    (u32)m_SetProperties.size() );
+                        }
+
                         m_pSystemScene->Initialize( m_SetProperties );
                         m_GetProperties.clear();
                         m_SetProperties.clear();
@@ -1499,10 +2243,15 @@ Framework::GDFParser::ReadAttributes(
             }
             else if ( strcmp( pszName, "Lib" ) == 0 )
             {
-                //
-                // Load the system library.
-                //
-                SystemManager::getInstance().LoadSystemLibrary(std::string(pXmlAttrib->Value()), m_sOldpath, &m_pSystem);
+                LoadSystem( m_pszSystemType, pXmlAttrib->Value() );
+
+                if ( IsRecording() )
+                {
+                    m_pCache->AddOperation( SceneCache::Operation::LoadSystem,
+                                            m_pCache->AddString( m_pszSystemType ),
+                                            m_pCache->AddString( pXmlAttrib->Value() ),
+                                            Benchmark::IsNullSystem( m_pszSystemType ) );
+                }
                     
                 if (m_pSystem == nullptr)
                 {
@@ -1546,6 +2295,7 @@ Framework::GDFParser::ReadAttributes(
                 {
                     std::cerr << "Parser failed to load the SDF file" << pszSDF << "." << std::endl;
                 }
+                RecordSource( pszSDF );
 
                 //
                 // Parse the sdf.
@@ -1615,6 +2365,13 @@ Framework::GDFParser::ReadAttributes(
         }
 
         EnvironmentManager::getInstance().Variables().Add( pszVariableName, pszVariableValue );
+
+        if ( IsRecording() )
+        {
+            m_pCache->AddOperation( SceneCache::Operation::SetVariable,
+                                    m_pCache->AddString( pszVariableName ),
+                                    m_pCache->AddString( pszVariableValue ) );
+        }
     }
     else if ( m_GdfMarker == GDFM_SystemProperty )
     {
@@ -1639,6 +2396,12 @@ Framework::GDFParser::ReadAttributes(
             if ( strcmp( pszName, "Startup" ) == 0 )
             {
                 m_sNextScene = pXmlAttrib->Value();
+
+                if ( IsRecording() )
+                {
+                    m_pCache->AddOperation( SceneCache::Operation::SetNextScene,
+                                            m_pCache->AddString( pXmlAttrib->Value() ) );
+                }
             }
             else
             {
@@ -1708,6 +2471,8 @@ Framework::GDFParser::ReadAttributes(
                     }
                     else
                     {
+                        RecordSource( pszCDF );
+
                         //
                         // Parse the sdf.
                         //
@@ -1732,6 +2497,11 @@ Framework::GDFParser::ReadAttributes(
                 }
 
                 m_sNextScene = pszValue;
+
+                if ( IsRecording() )
+                {
+                    m_pCache->AddOperation( SceneCache::Operation::SetNextScene, m_pCache->AddString( pszValue ) );
+                }
             }
             else
             {
@@ -1834,6 +2604,12 @@ Framework::GDFParser::ReadAttributes(
                     if ( m_pszObjectName != nullptr )
                     {
                         m_pUObject->SetName( m_pszObjectName );
+
+                        if ( IsRecording() )
+                        {
+                            m_pCache->AddOperation( SceneCache::Operation::SetObjectName,
+                                                    m_pCache->AddString( m_pszObjectName ) );
+                        }
                     }
                 }
             }
@@ -1854,6 +2630,8 @@ Framework::GDFParser::ReadAttributes(
                 }
                 else
                 {
+                    RecordSource( pszODF );
+
                     //
                     // Parse the sdf.
                     //
@@ -1950,13 +2728,20 @@ Framework::GDFParser::ReadAttributes(
                 }
                 else
                 {
-                    m_pSystemObject = m_pUObject->Extend( it->second, m_pszObjectType );
+                    m_pSystemObject = ExtendObject( it->second, m_pszObjectType );
                     if ( m_pSystemObject == nullptr )
                     {
                         std::cerr << "m_pSystemObject == NULL" << std::endl;
                     }
                     else
                     {
+                        if ( IsRecording() )
+                        {
+                            m_pCache->AddOperation( SceneCache::Operation::ExtendObject, m_pSystem->GetSystemType(),
+                                                    m_pszObjectType != nullptr ?
+                                                        m_pCache->AddString( m_pszObjectType ) : SceneCache::NoString );
+                        }
+
                         m_pSystemObject->GetProperties( m_GetProperties );
 
                         //
@@ -2009,6 +2794,8 @@ Framework::GDFParser::ReadAttributes(
     {
         UObject* pSubject = nullptr;
         UObject* pObserver = nullptr;
+        pcstr pszSubject = nullptr;
+        pcstr pszObserver = nullptr;
         std::string sSystemSubject;
         std::string sSystemObserver;
 
@@ -2020,10 +2807,12 @@ Framework::GDFParser::ReadAttributes(
             if ( strcmp( pszName, "Subject" ) == 0 )
             {
                 pSubject = m_pScene->FindObject( pszValue );
+                pszSubject = pszValue;
             }
             else if ( strcmp( pszName, "Observer" ) == 0 )
             {
                 pObserver = m_pScene->FindObject( pszValue );
+                pszObserver = pszValue;
             }
             else if ( strcmp( pszName, "SubjectSystem" ) == 0 )
             {
@@ -2121,15 +2910,19 @@ Framework::GDFParser::ReadAttributes(
                 else
                 {
                     //
-                    // Call the scene to register the links.
+                    // The links are registered once all the objects are read.
                     //
-                    if ( pSystemSubject != nullptr )
-                    {
-                        m_pScene->CreateObjectLink( pSystemSubject, pSystemObserver );
-                    }
-                    else
+                    Link Entry = { pSubject, pSystemSubject, pSystemObserver };
+                    m_Links.push_back( Entry );
+
+                    if ( IsRecording() )
                     {
-                        m_pScene->CreateObjectLink( pSubject, pSystemObserver );
+                        m_pCache->AddOperation( SceneCache::Operation::CreateLink,
+                                                m_pCache->AddString( pszSubject ),
+                                                m_pCache->AddString( pszObserver ),
+                                                pSystemSubject != nullptr ?
+                                                    pSystemSubject->GetSystemType() : System::Types::Null,
+                                                pSystem->GetSystemType() );
                     }
                 }
             }
@@ -2159,6 +2952,8 @@ Framework::GDFParser::ReadAttributes(
                 }
                 else
                 {
+                    RecordSource( pszCDF );
+
                     //
                     // Parse the sdf.
                     //
@@ -2216,10 +3011,11 @@ Framework::GDFParser::ReadPropertyAttributes(
             // Search for the name in the property array.
             //
             pcstr pszValue = pXmlAttrib->Value();
+            Base::StringId ValueId = Base::InternString( pszValue );
 
             for ( Properties::ConstIterator it=GetProperties.begin(); it != GetProperties.end(); it++ )
             {
-                if ( strcmp( it->GetName(), pszValue ) == 0 )
+                if ( it->GetNameId() == ValueId )
                 {
                     SetProperties.push_back( *it );
                     iProp = SetProperties.size() - 1;
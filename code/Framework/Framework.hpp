@@ -16,7 +16,9 @@
 
 #include "Framework/FrameworkAPI.hpp"
 
+#include <chrono>
 #include <mutex>
+#include <set>
 
 /*******************************************************************************
 * CLASS: Framework
@@ -27,7 +29,9 @@
 *******************************************************************************/
 
 class Scheduler;
+class Benchmark;
 class ChangeManager;
+class TaskGroup;
 class UScene;
 class UObject;
 
@@ -130,31 +134,81 @@ protected:
     ///  changes.</param>
     void IssuePendingSystemPropertyChanges( System::Types::BitMask SystemTypes=System::Types::All );
 
+    /// <summary>
+    ///   Checks if there are property changes waiting to be issued.
+    /// </summary>
+    Bool HasPendingSystemPropertyChanges( void );
+
 
 protected:
 
-    struct PropertyIssue
-    {
-        System::Components      SystemComponent;
-        System::Type            SystemType;
-        Handle                  hItem;
-        Properties::Property    Property;
-    };
-    typedef std::vector<PropertyIssue>      PropertyIssues;
-    typedef PropertyIssues::iterator        PropertyIssuesIt;
+    typedef std::chrono::high_resolution_clock::time_point TimePoint;
+
+    /// <summary>
+    ///   Closes the object changes of the frame that just finished and distributes them in the
+    ///    background.  The systems they touch are held back until they are delivered.
+    /// </summary>
+    /// <param name="FrameStart">The time the frame started.</param>
+    void QueueDistribution( TimePoint FrameStart );
+
+    /// <summary>
+    ///   Distributes the scene changes.  The background distributions post to the scene CCM, so
+    ///    they are finished first.  While they still run the scene changes are held back for up
+    ///    to the maximum frame lag.
+    /// </summary>
+    void DistributeSceneChanges( void );
+
+    /// <summary>
+    ///   Waits until no more than the given number of background distributions are running.
+    /// </summary>
+    void WaitForDistributions( u32 MaxPending );
+
+    /// <summary>
+    ///   Adds the time from the start of a frame until its changes were delivered to the histogram.
+    /// </summary>
+    void RecordLatency( f32 Latency );
 
-    PropertyIssues                          m_PropertyIssues;
-    std::mutex                              m_PropertyIssuesMutex;
+    /// <summary>
+    ///   Prints the latency histogram and the frame rate.
+    /// </summary>
+    void ReportLatency( u32 Frames, f32 Seconds ) const;
+
+
+protected:
+
+    PropertyQueue                           m_PropertyQueue;
 
 
 protected:
 
     Scheduler*                              m_pScheduler;
+    Benchmark*                              m_pBenchmark;
     ChangeManager*                          m_pSceneCCM;
     ChangeManager*                          m_pObjectCCM;
     UScene*                                 m_pScene;
 
     Bool                                    m_bExecuteLoop;
+
+    // Pipelined frames distribute the object changes while the next frame executes.
+    struct Distribution
+    {
+        TaskGroup*                          pGroup;
+        TimePoint                           FrameStart;
+        f32                                 Latency;
+    };
+
+    Bool                                    m_bPipelined;
+    u32                                     m_MaxFrameLag;
+    Distribution*                           m_aDistributions;
+    u32                                     m_DistributionHead;
+    u32                                     m_DistributionCount;
+    u32                                     m_SceneFramesDeferred;
+
+    // Frame latency histogram, bucket i counts latencies below 2^i milliseconds.
+    static const u32                        LatencyBuckets = 8;
+    u32                                     m_aLatencyHistogram[ LatencyBuckets ];
+    f32                                     m_LatencyTotal;
+    u32                                     m_LatencyFrames;
     
 private:
 
@@ -165,7 +219,13 @@ private:
     {
     public:
 
-        GDFParser( UScene* pScene, std::string sOldpath);
+        /// <summary>
+        ///   Constructor.
+        /// </summary>
+        /// <param name="pScene">The universal scene to create the scenes and objects in.</param>
+        /// <param name="sOldpath">The directory the system libraries are loaded from.</param>
+        /// <param name="pCache">The compiled GDF to replay if it is loaded, or to record into if not.</param>
+        GDFParser( UScene* pScene, std::string sOldpath, SceneCache* pCache = nullptr );
 
         void ParseEnvironment( std::string sGDF );
 
@@ -193,6 +253,58 @@ private:
                 std::vector<Properties::Property>& SetProperties
                 ) const;
 
+        /// <summary>
+        ///   Returns True if the parsed GDF is being compiled.
+        /// </summary>
+        Bool IsRecording( void ) const;
+
+        /// <summary>
+        ///   Adds a file the compiled GDF depends on.
+        /// </summary>
+        void RecordSource( pcstr pszFile );
+
+        void LoadSystem( pcstr pszType, pcstr pszLib );
+
+        void ExtendScenes( void );
+
+        void SetSceneStatus( ISystemScene::GlobalSceneStatus Status );
+
+        void CreateObject( void );
+
+        /// <summary>
+        ///   Extends the current object and notes if the extension can be initialized concurrently.
+        /// </summary>
+        ISystemObject* ExtendObject( ISystemScene* pSystemScene, pcstr pszType );
+
+        /// <summary>
+        ///   Registers the links read so far in the order they were read.
+        /// </summary>
+        void CreateLinks( void );
+
+        /// <summary>
+        ///   Initializes all the objects read, the extensions of types which allow it are
+        ///   initialized concurrently by the task manager.
+        /// </summary>
+        void InitializeObjects( void );
+
+        /// <summary>
+        ///   Performs the operations of a section of the compiled GDF.
+        /// </summary>
+        void Replay( const SceneCache::Operation* pOperations, u32 Count );
+
+        /// <summary>
+        ///   Fills in the properties to set from the compiled property table.
+        /// </summary>
+        /// <param name="First">The index of the first compiled property.</param>
+        /// <param name="Count">The number of compiled properties.</param>
+        /// <param name="GetProperties">The properties of the system, scene or object.</param>
+        /// <param name="SetProperties">Receives the properties to set.</param>
+        void GetCachedProperties(
+                u32 First, u32 Count,
+                const Properties::Array& GetProperties,
+                Properties::Array& SetProperties
+                ) const;
+
 
     protected:
 
@@ -202,6 +314,8 @@ private:
         
         std::string                                     m_sOldpath;
 
+        SceneCache*                                     m_pCache;
+
         enum GdfMarkers
         {
             GDFM_None, GDFM_Gdf,
@@ -236,5 +350,16 @@ private:
 
         std::map<u32,Properties::Array>                 m_SetPropertiesMap;
         std::map<UObject*,std::map<u32,Properties::Array> >  m_AllObjectProperties;
+
+        // Extensions whose scene allows initializing them concurrently.
+        std::set<ISystemObject*>                        m_ConcurrentObjects;
+
+        struct Link
+        {
+            UObject*                                    pSubject;
+            ISystemObject*                              pSystemSubject;
+            ISystemObject*                              pSystemObserver;
+        };
+        std::vector<Link>                               m_Links;
     };
 };
@@ -17,3 +17,11 @@
 //  pszGDF - file containing all the definitions of what to execute
 //
 extern void EngineExecuteGDF( const char* pszGDF /*global definition file*/ );
+
+//
+// Sets an environment variable before the GDF is executed, it takes precedence over
+//  the one in the GDF.
+//  pszName - name of the variable, e.g. Benchmark::Frames
+//  pszValue - value of the variable
+//
+extern void EngineSetVariable( const char* pszName, const char* pszValue );
@@ -0,0 +1,337 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+//core
+#include "Base/Compat.hpp"
+#include "Base/Platform.hpp"
+//interface
+#include "Interfaces/Interface.hpp"
+//stdlib
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <unordered_map>
+//external
+#if defined(USE_ITTNOTIFY)
+    #include <ittnotify.h>
+#endif
+//framework
+#include "Framework/EnvironmentManager.hpp"
+#include "Framework/Instrumentation.hpp"
+
+std::once_flag
+Instrumentation::only_one;
+std::shared_ptr<Instrumentation>
+Instrumentation::instance_ = nullptr;
+
+std::atomic<bool>
+Instrumentation::sm_bEnabled( false );
+__thread_local Instrumentation::ThreadBuffer*
+Instrumentation::sm_pThreadBuffer = nullptr;
+
+#if defined(USE_ITTNOTIFY)
+static __itt_domain* s_pDomain = nullptr;
+#endif
+
+// Events nested deeper than this are not recorded.
+static const u32 MaxDepth = 32;
+
+struct Instrumentation::ThreadBuffer
+{
+    struct Event
+    {
+        pcstr                           pszName;
+        pcstr                           pszCategory;
+        u64                             Start;
+        u64                             End;
+    };
+
+    u32                                 Index;
+    std::unique_ptr<Event[]>            pEvents;
+    // Number of events ever recorded, the ring holds the last m_BufferSize of them.
+    std::atomic<u64>                    Recorded;
+
+    // Events which have begun but not ended yet.
+    Event                               Open[ MaxDepth ];
+    u32                                 Depth;
+
+#if defined(USE_ITTNOTIFY)
+    std::unordered_map<pcstr, __itt_string_handle*> Handles;
+#endif
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Instrumentation - Default constructor
+Instrumentation::Instrumentation(
+    void
+    )
+    : m_bCapture( False )
+    , m_BufferSize( 0 )
+    , m_Origin( Clock::now() )
+{
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ~Instrumentation - Default destructor
+Instrumentation::~Instrumentation(
+    void
+    )
+{
+    sm_bEnabled.store( false );
+
+    for ( auto pBuffer : m_Buffers )
+    {
+        delete pBuffer;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Initialize - Read the settings and start capturing
+void
+Instrumentation::Initialize(
+    void
+    )
+{
+    IEnvironment::IVariables& Variables = EnvironmentManager::getInstance().Variables();
+    m_bCapture = Variables.GetAsBool( "Instrumentation::Capture", False );
+    m_BufferSize = std::max( Variables.GetAsInt( "Instrumentation::BufferSize", 65536 ), 1 );
+    m_sTraceFile = Variables.GetAsString( "Instrumentation::TraceFile", "trace.json" );
+    m_Origin = Clock::now();
+
+    Bool bEnabled = m_bCapture;
+
+#if defined(USE_ITTNOTIFY)
+    // The domain is only enabled while a collector such as VTune is attached.
+    s_pDomain = __itt_domain_create( "Smoke" );
+    if ( s_pDomain != nullptr && s_pDomain->flags )
+    {
+        bEnabled = True;
+    }
+#endif
+
+    sm_bEnabled.store( bEnabled != False );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Shutdown - Stop capturing and write the trace
+void
+Instrumentation::Shutdown(
+    void
+    )
+{
+    sm_bEnabled.store( false );
+
+    if ( m_bCapture )
+    {
+        WriteTrace( m_sTraceFile.c_str() );
+        m_bCapture = False;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// IsCapturing - Check if events are being recorded
+Bool
+Instrumentation::IsCapturing(
+    void
+    )
+{
+    return IsEnabled();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// BeginEvent - Start an event on the calling thread
+void
+Instrumentation::BeginEvent(
+    pcstr pszName,
+    pcstr pszCategory
+    )
+{
+    ThreadBuffer* pBuffer = GetThreadBuffer();
+
+    if ( pBuffer->Depth < MaxDepth )
+    {
+        ThreadBuffer::Event& Entry = pBuffer->Open[ pBuffer->Depth ];
+        Entry.pszName = pszName;
+        Entry.pszCategory = pszCategory;
+        Entry.Start = Now();
+    }
+    pBuffer->Depth++;
+
+#if defined(USE_ITTNOTIFY)
+    if ( s_pDomain != nullptr && s_pDomain->flags )
+    {
+        __itt_string_handle*& pHandle = pBuffer->Handles[ pszName ];
+        if ( pHandle == nullptr )
+        {
+            pHandle = __itt_string_handle_create( pszName );
+        }
+        __itt_task_begin( s_pDomain, __itt_null, __itt_null, pHandle );
+    }
+#endif
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// EndEvent - End the last event begun on the calling thread
+void
+Instrumentation::EndEvent(
+    void
+    )
+{
+    ThreadBuffer* pBuffer = GetThreadBuffer();
+
+    if ( pBuffer->Depth == 0 )
+    {
+        // Capture was turned on inside the event.
+        return;
+    }
+    pBuffer->Depth--;
+
+#if defined(USE_ITTNOTIFY)
+    if ( s_pDomain != nullptr && s_pDomain->flags )
+    {
+        __itt_task_end( s_pDomain );
+    }
+#endif
+
+    if ( m_bCapture && pBuffer->pEvents && pBuffer->Depth < MaxDepth )
+    {
+        // Only this thread writes to its ring, the writer of the trace reads up to the
+        // published count.
+        u64 Recorded = pBuffer->Recorded.load( std::memory_order_relaxed );
+        ThreadBuffer::Event& Entry = pBuffer->pEvents[ Recorded % m_BufferSize ];
+        Entry = pBuffer->Open[ pBuffer->Depth ];
+        Entry.End = Now();
+        pBuffer->Recorded.store( Recorded + 1, std::memory_order_release );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GetThreadBuffer - Get the buffer of the calling thread
+Instrumentation::ThreadBuffer*
+Instrumentation::GetThreadBuffer(
+    void
+    )
+{
+    ThreadBuffer* pBuffer = sm_pThreadBuffer;
+
+    if ( pBuffer == nullptr )
+    {
+        pBuffer = new ThreadBuffer;
+
+        // The ring is only needed for the Chrome trace, ITT alone keeps no events.
+        if ( m_bCapture )
+        {
+            pBuffer->pEvents.reset( new ThreadBuffer::Event[ m_BufferSize ] );
+        }
+        pBuffer->Recorded.store( 0, std::memory_order_relaxed );
+        pBuffer->Depth = 0;
+
+        {
+            std::lock_guard<std::mutex> lock( m_BuffersMutex );
+            pBuffer->Index = (u32)m_Buffers.size();
+            m_Buffers.push_back( pBuffer );
+        }
+
+        sm_pThreadBuffer = pBuffer;
+    }
+
+    return pBuffer;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// WriteString - Write a JSON string
+static void
+WriteString(
+    FILE* pFile,
+    pcstr pszString
+    )
+{
+    fputc( '"', pFile );
+    for ( ; *pszString; pszString++ )
+    {
+        if ( *pszString == '"' || *pszString == '\\' )
+        {
+            fputc( '\\', pFile );
+        }
+        if ( (unsigned char)*pszString >= ' ' )
+        {
+            fputc( *pszString, pFile );
+        }
+    }
+    fputc( '"', pFile );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// WriteTrace - Write the recorded events as Chrome trace JSON
+Error
+Instrumentation::WriteTrace(
+    pcstr pszFile
+    )
+{
+    FILE* pFile = fopen( pszFile, "w" );
+    if ( pFile == nullptr )
+    {
+        std::cerr << "Instrumentation could not open the trace file " << pszFile << "." << std::endl;
+        return Errors::File::NotFound;
+    }
+
+    std::lock_guard<std::mutex> lock( m_BuffersMutex );
+
+    u64 Events = 0;
+    fputs( "{\"traceEvents\":[", pFile );
+    pcstr pszSeparator = "\n";
+
+    for ( auto pBuffer : m_Buffers )
+    {
+        fprintf( pFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,"
+                 "\"args\":{\"name\":\"Thread %u\"}}", pszSeparator, pBuffer->Index, pBuffer->Index );
+        pszSeparator = ",\n";
+
+        // Events before the last m_BufferSize were overwritten.
+        u64 Recorded = pBuffer->Recorded.load( std::memory_order_acquire );
+        u64 First = Recorded > m_BufferSize ? Recorded - m_BufferSize : 0;
+
+        for ( u64 i = First; i < Recorded; i++ )
+        {
+            const ThreadBuffer::Event& Entry = pBuffer->pEvents[ i % m_BufferSize ];
+
+            fputs( pszSeparator, pFile );
+            fputs( "{\"name\":", pFile );
+            WriteString( pFile, Entry.pszName );
+            fputs( ",\"cat\":", pFile );
+            WriteString( pFile, Entry.pszCategory );
+            fprintf( pFile, ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     pBuffer->Index, (double)Entry.Start / 1000.0, (double)(Entry.End - Entry.Start) / 1000.0 );
+        }
+        Events += Recorded - First;
+    }
+
+    fputs( "\n]}\n", pFile );
+    fclose( pFile );
+
+    std::clog << "Instrumentation wrote " << Events << " events of " << m_Buffers.size()
+              << " threads to " << pszFile << std::endl;
+
+    return Errors::Success;
+}
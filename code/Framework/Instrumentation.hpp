@@ -0,0 +1,173 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// <summary>
+///   Records timed events of the framework and the systems and writes them out as a
+///   Chrome trace (chrome://tracing).
+/// </summary>
+/// <remarks>
+///   Capture is turned on with Instrumentation::Capture.  Each thread records into its own
+///   ring buffer of Instrumentation::BufferSize events, the oldest are overwritten.  The
+///   trace is written to Instrumentation::TraceFile on shutdown.  When built with
+///   USE_ITTNOTIFY the events are also emitted as ITT tasks while VTune is attached, the
+///   rings are only allocated when capturing.  When neither is active an event costs a single load.
+/// </remarks>
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class Instrumentation : public IService::IInstrumentation
+{
+private:
+    // Singleton
+    static std::shared_ptr<Instrumentation> instance_;
+    static std::once_flag                   only_one;
+
+    Instrumentation(const Instrumentation& rs) {
+        instance_  = rs.instance_;
+    }
+
+    Instrumentation& operator = (const Instrumentation& rs)
+    {
+        if (this != &rs) {
+            instance_  = rs.instance_;
+        }
+
+        return *this;
+    }
+
+    Instrumentation();
+
+public:
+
+    static Instrumentation& getInstance()
+    {
+        std::call_once( Instrumentation::only_one, [] ()
+        {
+            Instrumentation::instance_.reset(
+                new Instrumentation());
+        });
+
+        return *Instrumentation::instance_;
+    }
+
+    ~Instrumentation();
+
+    /// <summary>
+    ///   Returns True if events are being recorded.
+    /// </summary>
+    static Bool IsEnabled( void )
+    {
+        return sm_bEnabled.load( std::memory_order_relaxed );
+    }
+
+    /// <summary>
+    ///   Records an event for the lifetime of the object.
+    /// </summary>
+    class Scope
+    {
+    public:
+        Scope( pcstr pszName, pcstr pszCategory )
+            : m_bActive( IsEnabled() )
+        {
+            if ( m_bActive )
+            {
+                getInstance().BeginEvent( pszName, pszCategory );
+            }
+        }
+
+        ~Scope( void )
+        {
+            if ( m_bActive )
+            {
+                getInstance().EndEvent();
+            }
+        }
+
+    private:
+        Bool                            m_bActive;
+    };
+
+    /// <summary>
+    ///   Reads the settings from the environment and starts capturing if requested.
+    /// </summary>
+    void Initialize( void );
+
+    /// <summary>
+    ///   Stops capturing and writes the trace if one was captured.
+    /// </summary>
+    void Shutdown( void );
+
+    /// <summary>
+    ///   Writes the recorded events as Chrome trace JSON.
+    /// </summary>
+    /// <param name="pszFile">The file to write to.</param>
+    /// <returns>An error code.</returns>
+    Error WriteTrace( pcstr pszFile );
+
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // IService::IInstrumentation Implementations.
+
+    /// <summary cref="IService::IInstrumentation::IsCapturing">
+    ///   Implementation of IService::IInstrumentation::IsCapturing.
+    /// </summary>
+    virtual Bool IsCapturing( void );
+
+    /// <summary cref="IService::IInstrumentation::BeginEvent">
+    ///   Implementation of IService::IInstrumentation::BeginEvent.
+    /// </summary>
+    virtual void BeginEvent( pcstr pszName, pcstr pszCategory );
+
+    /// <summary cref="IService::IInstrumentation::EndEvent">
+    ///   Implementation of IService::IInstrumentation::EndEvent.
+    /// </summary>
+    virtual void EndEvent( void );
+
+
+protected:
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct ThreadBuffer;
+
+    /// <summary>
+    ///   Gets the buffer of the calling thread, creating it on first use.
+    /// </summary>
+    ThreadBuffer* GetThreadBuffer( void );
+
+    u64 Now( void )
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - m_Origin ).count();
+    }
+
+    static std::atomic<bool>            sm_bEnabled;
+    static __thread_local ThreadBuffer* sm_pThreadBuffer;
+
+    Bool                                m_bCapture;
+    u32                                 m_BufferSize;
+    std::string                         m_sTraceFile;
+    Clock::time_point                   m_Origin;
+
+    std::mutex                          m_BuffersMutex;
+    std::vector<ThreadBuffer*>          m_Buffers;
+};
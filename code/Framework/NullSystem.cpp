@@ -0,0 +1,364 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+//core
+#include "Base/Compat.hpp"
+#include "Base/Platform.hpp"
+//interface
+#include "Interfaces/Interface.hpp"
+//stdlib
+#include <cstring>
+//framework
+#include "Framework/NullSystem.hpp"
+
+
+System::Type
+NullSystem::GetTypeByName(
+    pcstr pszName
+    )
+{
+    static const struct
+    {
+        pcstr                           pszName;
+        System::Type                    Type;
+    } Systems[] =
+    {
+        { System::Names::Geometry,          System::Types::Geometry },
+        { System::Names::Graphics,          System::Types::Graphics },
+        { System::Names::PhysicsCollision,  System::Types::PhysicsCollision },
+        { System::Names::Audio,             System::Types::Audio },
+        { System::Names::Input,             System::Types::Input },
+        { System::Names::AI,                System::Types::AI },
+        { System::Names::Animation,         System::Types::Animation },
+        { System::Names::Scripting,         System::Types::Scripting },
+        { System::Names::Explosion,         System::Types::Explosion },
+        { System::Names::Water,             System::Types::Water },
+    };
+
+    for ( const auto& System : Systems )
+    {
+        if ( strcmp( System.pszName, pszName ) == 0 )
+        {
+            return System.Type;
+        }
+    }
+
+    return System::Types::Null;
+}
+
+
+NullSystem::NullSystem(
+    pcstr pszName,
+    System::Type Type
+    )
+    : ISystem()
+    , m_sName( pszName )
+    , m_Type( Type )
+{
+}
+
+
+NullSystem::~NullSystem(
+    void
+    )
+{
+}
+
+
+pcstr
+NullSystem::GetName(
+    void
+    )
+{
+    return m_sName.c_str();
+}
+
+
+System::Type
+NullSystem::GetSystemType(
+    void
+    )
+{
+    return m_Type;
+}
+
+
+Error
+NullSystem::Initialize(
+    Properties::Array Properties
+    )
+{
+    UNREFERENCED_PARAM( Properties );
+
+    m_bInitialized = True;
+
+    return Errors::Success;
+}
+
+
+void
+NullSystem::GetProperties(
+    Properties::Array& Properties
+    )
+{
+    UNREFERENCED_PARAM( Properties );
+}
+
+
+void
+NullSystem::SetProperties(
+    Properties::Array Properties
+    )
+{
+    UNREFERENCED_PARAM( Properties );
+}
+
+
+ISystemScene*
+NullSystem::CreateScene(
+    void
+    )
+{
+    return new NullScene( this );
+}
+
+
+Error
+NullSystem::DestroyScene(
+    ISystemScene* pSystemScene
+    )
+{
+    NullScene* pScene = static_cast<NullScene*>(pSystemScene);
+    SAFE_DELETE( pScene );
+
+    return Errors::Success;
+}
+
+
+NullScene::NullScene(
+    ISystem* pSystem
+    )
+    : ISystemScene( pSystem )
+{
+}
+
+
+NullScene::~NullScene(
+    void
+    )
+{
+    //
+    // Free all the remaining objects.
+    //
+    for ( auto pObject : m_Objects )
+    {
+        delete pObject;
+    }
+
+    m_Objects.clear();
+}
+
+
+System::Type
+NullScene::GetSystemType(
+    void
+    )
+{
+    return m_pSystem->GetSystemType();
+}
+
+
+Error
+NullScene::Initialize(
+    Properties::Array Properties
+    )
+{
+    UNREFERENCED_PARAM( Properties );
+
+    m_bInitialized = True;
+
+    return Errors::Success;
+}
+
+
+void
+NullScene::GetProperties(
+    Properties::Array& Properties
+    )
+{
+    UNREFERENCED_PARAM( Properties );
+}
+
+
+void
+NullScene::SetProperties(
+    Properties::Array Properties
+    )
+{
+    UNREFERENCED_PARAM( Properties );
+}
+
+
+pcstr*
+NullScene::GetObjectTypes(
+    void
+    )
+{
+    return nullptr;
+}
+
+
+ISystemObject*
+NullScene::CreateObject(
+    pcstr pszName,
+    pcstr pszType
+    )
+{
+    UNREFERENCED_PARAM( pszType );
+
+    NullObject* pObject = new NullObject( this, pszName );
+    m_Objects.push_back( pObject );
+
+    return pObject;
+}
+
+
+Bool
+NullScene::IsObjectInitializeThreadSafe(
+    pcstr pszType
+    )
+{
+    UNREFERENCED_PARAM( pszType );
+
+    return True;
+}
+
+
+Error
+NullScene::DestroyObject(
+    ISystemObject* pSystemObject
+    )
+{
+    NullObject* pObject = static_cast<NullObject*>(pSystemObject);
+    m_Objects.remove( pObject );
+    delete pObject;
+
+    return Errors::Success;
+}
+
+
+ISystemTask*
+NullScene::GetSystemTask(
+    void
+    )
+{
+    // Nothing to schedule.
+    return nullptr;
+}
+
+
+System::Changes::BitMask
+NullScene::GetPotentialSystemChanges(
+    void
+    )
+{
+    return System::Changes::None;
+}
+
+
+NullObject::NullObject(
+    ISystemScene* pSystemScene,
+    pcstr pszName
+    )
+    : ISystemObject( pSystemScene, pszName )
+{
+}
+
+
+NullObject::~NullObject(
+    void
+    )
+{
+}
+
+
+System::Type
+NullObject::GetSystemType(
+    void
+    )
+{
+    return m_pSystemScene->GetSystemType();
+}
+
+
+Error
+NullObject::Initialize(
+    Properties::Array Properties
+    )
+{
+    UNREFERENCED_PARAM( Properties );
+
+    m_bInitialized = True;
+
+    return Errors::Success;
+}
+
+
+void
+NullObject::GetProperties(
+    Properties::Array& Properties
+    )
+{
+    UNREFERENCED_PARAM( Properties );
+}
+
+
+void
+NullObject::SetProperties(
+    Properties::Array Properties
+    )
+{
+    UNREFERENCED_PARAM( Properties );
+}
+
+
+System::Changes::BitMask
+NullObject::GetDesiredSystemChanges(
+    void
+    )
+{
+    return System::Changes::None;
+}
+
+
+System::Changes::BitMask
+NullObject::GetPotentialSystemChanges(
+    void
+    )
+{
+    return System::Changes::None;
+}
+
+
+Error
+NullObject::ChangeOccurred(
+    ISubject* pSubject,
+    System::Changes::BitMask ChangeType
+    )
+{
+    UNREFERENCED_PARAM( pSubject );
+    UNREFERENCED_PARAM( ChangeType );
+
+    return Errors::Success;
+}
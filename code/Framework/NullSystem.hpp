@@ -0,0 +1,120 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+#pragma once
+
+#include <list>
+#include <string>
+
+class NullScene;
+class NullObject;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// <summary>
+///   Stand-in for a system which is not loaded, e.g. graphics, input and audio when running
+///   headless.  It accepts all properties and objects, but has no task and posts no changes.
+/// </summary>
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class NullSystem : public ISystem
+{
+public:
+
+    /// <summary>
+    ///   Gets the type of a predefined system by its name.
+    /// </summary>
+    /// <param name="pszName">The name of the system.</param>
+    /// <returns>The type of the system or System::Types::Null if there is none.</returns>
+    static System::Type GetTypeByName( pcstr pszName );
+
+    NullSystem( pcstr pszName, System::Type Type );
+    virtual ~NullSystem( void );
+
+    virtual pcstr GetName( void );
+    virtual System::Type GetSystemType( void );
+
+    virtual Error Initialize( Properties::Array Properties );
+    virtual void GetProperties( Properties::Array& Properties );
+    virtual void SetProperties( Properties::Array Properties );
+
+    virtual ISystemScene* CreateScene( void );
+    virtual Error DestroyScene( ISystemScene* pSystemScene );
+
+
+protected:
+
+    std::string                         m_sName;
+    System::Type                        m_Type;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// <summary>
+///   Scene of a NullSystem.
+/// </summary>
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class NullScene : public ISystemScene
+{
+public:
+
+    NullScene( ISystem* pSystem );
+    ~NullScene( void );
+
+    virtual System::Type GetSystemType( void );
+
+    virtual Error Initialize( Properties::Array Properties );
+    virtual void GetProperties( Properties::Array& Properties );
+    virtual void SetProperties( Properties::Array Properties );
+
+    virtual pcstr* GetObjectTypes( void );
+    virtual ISystemObject* CreateObject( pcstr pszName, pcstr pszType );
+    virtual Bool IsObjectInitializeThreadSafe( pcstr pszType );
+    virtual Error DestroyObject( ISystemObject* pSystemObject );
+
+    virtual ISystemTask* GetSystemTask( void );
+
+    virtual System::Changes::BitMask GetPotentialSystemChanges( void );
+
+
+protected:
+
+    std::list<NullObject*>              m_Objects;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// <summary>
+///   Object of a NullScene.
+/// </summary>
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class NullObject : public ISystemObject
+{
+public:
+
+    NullObject( ISystemScene* pSystemScene, pcstr pszName );
+    ~NullObject( void );
+
+    virtual System::Type GetSystemType( void );
+
+    virtual Error Initialize( Properties::Array Properties );
+    virtual void GetProperties( Properties::Array& Properties );
+    virtual void SetProperties( Properties::Array Properties );
+
+    virtual System::Changes::BitMask GetDesiredSystemChanges( void );
+    virtual System::Changes::BitMask GetPotentialSystemChanges( void );
+
+    virtual Error ChangeOccurred( ISubject* pSubject, System::Changes::BitMask ChangeType );
+};
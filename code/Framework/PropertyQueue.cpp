@@ -0,0 +1,272 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+//core
+#include "Base/Compat.hpp"
+#include "Base/Platform.hpp"
+//interface
+#include "Interfaces/Interface.hpp"
+//stdlib
+#include <algorithm>
+#include <iostream>
+//framework
+#include "Framework/PropertyQueue.hpp"
+
+
+struct PropertyQueue::Record
+{
+    Record*                             pNext;
+
+    System::Components                  Component;
+    System::Type                        SystemType;
+    Handle                              hItem;
+
+    // The caller's property, assigning into it reuses the storage of its string values.
+    Properties::Property                Property;
+};
+
+
+__thread_local PropertyQueue::ThreadRecords
+PropertyQueue::sm_ThreadRecords = { 0, nullptr, nullptr, 0 };
+
+std::atomic<u32>
+PropertyQueue::sm_NextGeneration( 1 );
+
+
+///////////////////////////////////////////////////////////////////////////////
+// PropertyQueue - Default constructor
+PropertyQueue::PropertyQueue(
+    void
+    )
+    : m_Generation( sm_NextGeneration.fetch_add( 1 ) )
+    , m_pHead( nullptr )
+    , m_pRecycled( nullptr )
+{
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ~PropertyQueue - Default destructor
+PropertyQueue::~PropertyQueue(
+    void
+    )
+{
+    for ( auto pChunk : m_aChunks )
+    {
+        delete [] pChunk;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AllocateRecord - Take a record from the records of the calling thread
+PropertyQueue::Record*
+PropertyQueue::AllocateRecord(
+    void
+    )
+{
+    ThreadRecords& Records = sm_ThreadRecords;
+    if ( Records.Generation != m_Generation )
+    {
+        Records.Generation = m_Generation;
+        Records.pFree = nullptr;
+        Records.pChunk = nullptr;
+        Records.ChunkLeft = 0;
+    }
+
+    //
+    // Reuse the issued records first, the thread takes all of them at once.
+    //
+    if ( Records.pFree == nullptr )
+    {
+        Records.pFree = m_pRecycled.exchange( nullptr, std::memory_order_acquire );
+    }
+
+    if ( Records.pFree != nullptr )
+    {
+        Record* pRecord = Records.pFree;
+        Records.pFree = pRecord->pNext;
+        return pRecord;
+    }
+
+    if ( Records.ChunkLeft == 0 )
+    {
+        Record* pChunk = new Record[ RecordsPerChunk ];
+        {
+            std::lock_guard<std::mutex> lock( m_ChunksMutex );
+            m_aChunks.push_back( pChunk );
+        }
+        Records.pChunk = pChunk;
+        Records.ChunkLeft = RecordsPerChunk;
+    }
+
+    Records.ChunkLeft--;
+    return Records.pChunk++;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Push - Queue a property change
+void
+PropertyQueue::Push(
+    System::Components Component,
+    System::Type SystemType,
+    Handle hItem,
+    const Properties::Property& Property
+    )
+{
+    Record* pRecord = AllocateRecord();
+    pRecord->Component = Component;
+    pRecord->SystemType = SystemType;
+    pRecord->hItem = hItem;
+    pRecord->Property = Property;
+
+    Record* pHead = m_pHead.load( std::memory_order_relaxed );
+    do
+    {
+        pRecord->pNext = pHead;
+    } while ( !m_pHead.compare_exchange_weak( pHead, pRecord, std::memory_order_release,
+                                              std::memory_order_relaxed ) );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Issue - Set the queued properties on their targets
+void
+PropertyQueue::Issue(
+    System::Types::BitMask SystemTypes
+    )
+{
+    //
+    // Take the queued changes and put them back into the order they were pushed in.
+    //
+    Record* pRecord = m_pHead.exchange( nullptr, std::memory_order_acquire );
+    if ( pRecord == nullptr )
+    {
+        return;
+    }
+
+    m_aRecords.clear();
+    for ( ; pRecord != nullptr; pRecord = pRecord->pNext )
+    {
+        m_aRecords.push_back( pRecord );
+    }
+    std::reverse( m_aRecords.begin(), m_aRecords.end() );
+
+    //
+    // Group the changes by target, keeping the order of the changes of each target.
+    //
+    std::stable_sort( m_aRecords.begin(), m_aRecords.end(),
+        [] ( const Record* pA, const Record* pB )
+        {
+            if ( pA->hItem != pB->hItem )
+            {
+                return reinterpret_cast<uptr>(pA->hItem) < reinterpret_cast<uptr>(pB->hItem);
+            }
+            return pA->Component < pB->Component;
+        }
+    );
+
+    for ( auto itFirst = m_aRecords.begin(); itFirst != m_aRecords.end(); )
+    {
+        auto itLast = itFirst;
+        while ( itLast != m_aRecords.end() && (*itLast)->hItem == (*itFirst)->hItem &&
+                (*itLast)->Component == (*itFirst)->Component )
+        {
+            itLast++;
+        }
+
+        //
+        // Check if the scheduler will allow issuing the property changes.
+        //
+        if ( (*itFirst)->SystemType & SystemTypes )
+        {
+            m_aProperties.clear();
+
+            for ( auto it = itFirst; it != itLast; it++ )
+            {
+                const Properties::Property& Change = (*it)->Property;
+
+                //
+                // The last value of a property replaces the earlier ones.
+                //
+                Properties::Iterator itProperty = m_aProperties.begin();
+                while ( itProperty != m_aProperties.end() && itProperty->GetNameId() != Change.GetNameId() )
+                {
+                    itProperty++;
+                }
+
+                if ( itProperty != m_aProperties.end() )
+                {
+                    *itProperty = Change;
+                }
+                else
+                {
+                    m_aProperties.push_back( Change );
+                }
+            }
+
+            SetProperties( *itFirst, m_aProperties );
+        }
+
+        itFirst = itLast;
+    }
+
+    //
+    // Hand the records back to the pushing threads.
+    //
+    for ( size_t i=1; i < m_aRecords.size(); i++ )
+    {
+        m_aRecords[ i - 1 ]->pNext = m_aRecords[ i ];
+    }
+
+    Record* pFirst = m_aRecords.front();
+    Record* pLast = m_aRecords.back();
+    Record* pRecycled = m_pRecycled.load( std::memory_order_relaxed );
+    do
+    {
+        pLast->pNext = pRecycled;
+    } while ( !m_pRecycled.compare_exchange_weak( pRecycled, pFirst, std::memory_order_release,
+                                                  std::memory_order_relaxed ) );
+    m_aRecords.clear();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SetProperties - Set the properties on a target
+void
+PropertyQueue::SetProperties(
+    const Record* pRecord,
+    Properties::Array& aProperties
+    )
+{
+    switch ( pRecord->Component )
+    {
+    case System::System:
+        reinterpret_cast<ISystem*>(pRecord->hItem)->SetProperties( aProperties );
+        break;
+
+    case System::Scene:
+        reinterpret_cast<ISystemScene*>(pRecord->hItem)->SetProperties( aProperties );
+        break;
+
+    case System::Object:
+        reinterpret_cast<ISystemObject*>(pRecord->hItem)->SetProperties( aProperties );
+        break;
+
+    default:
+        std::cerr << "Unhandled case." << std::endl;
+        break;
+    };
+}
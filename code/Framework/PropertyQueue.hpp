@@ -0,0 +1,120 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// <summary>
+///   Collects the property changes issued through the system access service until the framework
+///    sets them on the systems, scenes and objects.
+/// </summary>
+/// <remarks>
+///   Any thread can push a change without taking a lock.  A change is stored as the target and a
+///    copy of the caller's property, so the target does not have to list the property in its
+///    GetProperties.  The records come from chunks handed out per thread and are recycled once
+///    issued, after a few frames pushing does not allocate any more.  When issued the changes
+///    are sorted by target so every target receives all of its properties in a single
+///    SetProperties call, and the last value set for a property wins.
+/// </remarks>
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class PropertyQueue
+{
+public:
+
+    /// <summary>
+    ///   Constructor.
+    /// </summary>
+    PropertyQueue( void );
+
+    /// <summary>
+    ///   Destructor, drops the changes that were not issued.
+    /// </summary>
+    ~PropertyQueue( void );
+
+    /// <summary>
+    ///   Queues a property change.  Lock free, can be called from any thread.
+    /// </summary>
+    /// <param name="Component">The kind of the target, a system, scene or object.</param>
+    /// <param name="SystemType">The type of the system the target belongs to.</param>
+    /// <param name="hItem">The handle of the target.</param>
+    /// <param name="Property">The property to set.</param>
+    void Push( System::Components Component, System::Type SystemType, Handle hItem,
+               const Properties::Property& Property );
+
+    /// <summary>
+    ///   Checks if there are changes waiting to be issued.
+    /// </summary>
+    Bool IsEmpty( void ) const
+    {
+        return m_pHead.load( std::memory_order_acquire ) == nullptr;
+    }
+
+    /// <summary>
+    ///   Sets the queued properties on their targets.  Changes queued while issuing are issued
+    ///    the next time.
+    /// </summary>
+    /// <param name="SystemTypes">The system types that can accept property changes, the changes
+    ///  for other systems are dropped.</param>
+    void Issue( System::Types::BitMask SystemTypes );
+
+
+protected:
+
+    struct Record;
+
+    // The records a thread can take without touching the queue.
+    struct ThreadRecords
+    {
+        u32                             Generation;
+        Record*                         pFree;
+        Record*                         pChunk;
+        u32                             ChunkLeft;
+    };
+
+    static const u32                    RecordsPerChunk = 64;
+
+    /// <summary>
+    ///   Takes a record from the records of the calling thread.
+    /// </summary>
+    Record* AllocateRecord( void );
+
+    /// <summary>
+    ///   Sets the properties on a target.
+    /// </summary>
+    static void SetProperties( const Record* pRecord, Properties::Array& aProperties );
+
+    static __thread_local ThreadRecords sm_ThreadRecords;
+    static std::atomic<u32>             sm_NextGeneration;
+
+    // Tells the records a thread kept for this queue from the ones of an earlier queue.
+    u32                                 m_Generation;
+
+    // The changes in reverse order of pushing.
+    std::atomic<Record*>                m_pHead;
+
+    // The issued records, taken as a whole by the first thread running out of records.
+    std::atomic<Record*>                m_pRecycled;
+
+    std::mutex                          m_ChunksMutex;
+    std::vector<Record*>                m_aChunks;
+
+    // Reused by Issue.
+    std::vector<Record*>                m_aRecords;
+    Properties::Array                   m_aProperties;
+};
@@ -0,0 +1,573 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+//core
+#include "Base/Compat.hpp"
+#include "Base/Platform.hpp"
+#include "Base/MappedFile.hpp"
+//interface
+#include "Interfaces/Interface.hpp"
+//stdlib
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+//framework
+#include "Framework/SceneCache.hpp"
+
+static const char Magic[ 8 ] = { 'S', 'M', 'O', 'K', 'E', 'G', 'D', 'F' };
+
+
+////////////////////////////////////////////////////////////////////////////////
+// SceneCache - Default constructor
+SceneCache::SceneCache(
+    void
+    )
+    : m_pData( nullptr )
+    , m_Size( 0 )
+    , m_pHeader( nullptr )
+    , m_pScenes( nullptr )
+    , m_pProperties( nullptr )
+    , m_pOperations( nullptr )
+    , m_pszStrings( nullptr )
+    , m_Section( Environment )
+    , m_SectionName( NoString )
+    , m_SectionStart( 0 )
+{
+    memset( m_aSections, 0, sizeof m_aSections );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ~SceneCache - Default destructor
+SceneCache::~SceneCache(
+    void
+    )
+{
+    Unload();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// GetCacheFile - Get the name of the compiled file for a GDF
+std::string
+SceneCache::GetCacheFile(
+    pcstr pszGDF
+    )
+{
+    return std::string( pszGDF ) + ".cache";
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HashFile - Get the size and the FNV-1a hash of a file
+Bool
+SceneCache::HashFile(
+    pcstr pszFile,
+    u64& Size,
+    u64& Hash
+    )
+{
+    size_t FileSize;
+    const void* pData = Base::MapFile( pszFile, FileSize );
+    if ( pData == nullptr )
+    {
+        return False;
+    }
+
+    const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+    Hash = 0xcbf29ce484222325ULL;
+    for ( size_t i = 0; i < FileSize; i++ )
+    {
+        Hash = (Hash ^ pBytes[ i ]) * 0x100000001b3ULL;
+    }
+    Size = FileSize;
+
+    Base::UnmapFile( pData, FileSize );
+
+    return True;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Load - Map a compiled file and check that it is up to date
+Error
+SceneCache::Load(
+    pcstr pszFile
+    )
+{
+    Unload();
+
+    size_t Size;
+    const void* pData = Base::MapFile( pszFile, Size );
+    if ( pData == nullptr )
+    {
+        return Errors::File::NotFound;
+    }
+
+    // Check that the tables fit into the file before looking at them.
+    const Header* pHeader = static_cast<const Header*>(pData);
+    const char* pBytes = static_cast<const char*>(pData);
+    u64 Offset = sizeof (Header);
+    Bool bValid = Size >= sizeof (Header) &&
+                  memcmp( pHeader->Magic, Magic, sizeof Magic ) == 0 &&
+                  pHeader->Version == Version &&
+                  pHeader->Size == Size;
+    if ( bValid )
+    {
+        Offset += (u64)pHeader->SourceCount * sizeof (Source) +
+                  (u64)pHeader->SceneCount * sizeof (SceneEntry) +
+                  (u64)pHeader->PropertyCount * sizeof (Property) +
+                  (u64)pHeader->OperationCount * sizeof (Operation);
+        bValid = pHeader->StringsSize > 0 && Offset + pHeader->StringsSize == Size &&
+                 pBytes[ Size - 1 ] == '\0';
+    }
+    if ( !bValid )
+    {
+        std::cerr << "SceneCache ignores " << pszFile << ", it was not written by this version." << std::endl;
+        Base::UnmapFile( pData, Size );
+        return Errors::File::InvalidFormat;
+    }
+
+    // A damaged file can still have a matching header, it is read from the XML instead.
+    const Source* pSources = reinterpret_cast<const Source*>(pBytes + sizeof (Header));
+    if ( !CheckTables( *pHeader, pSources ) )
+    {
+        std::cerr << "SceneCache ignores " << pszFile << ", it is damaged." << std::endl;
+        Base::UnmapFile( pData, Size );
+        return Errors::File::InvalidFormat;
+    }
+
+    // The sources must not have changed since the file was compiled.
+    pcstr pszStrings = pBytes + Offset;
+    for ( u32 i = 0; i < pHeader->SourceCount; i++ )
+    {
+        u64 SourceSize;
+        u64 SourceHash;
+        pcstr pszSource = pszStrings + pSources[ i ].Path;
+        if ( !HashFile( pszSource, SourceSize, SourceHash ) ||
+             SourceSize != pSources[ i ].Size || SourceHash != pSources[ i ].Hash )
+        {
+            std::clog << "SceneCache ignores " << pszFile << ", " << pszSource << " changed since it was compiled." << std::endl;
+            Base::UnmapFile( pData, Size );
+            return Errors::File::ErrorLoading;
+        }
+    }
+
+    m_pData = pData;
+    m_Size = Size;
+    m_pHeader = pHeader;
+    m_pScenes = reinterpret_cast<const SceneEntry*>(pSources + pHeader->SourceCount);
+    m_pProperties = reinterpret_cast<const Property*>(m_pScenes + pHeader->SceneCount);
+    m_pOperations = reinterpret_cast<const Operation*>(m_pProperties + pHeader->PropertyCount);
+    m_pszStrings = pszStrings;
+
+    return Errors::Success;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CheckTables - Check the ranges and offsets in the tables of a mapped file
+Bool
+SceneCache::CheckTables(
+    const Header& Header,
+    const Source* pSources
+    )
+{
+    // The strings table ends with a terminator, any offset into it is a valid string.
+    auto IsString = [&Header] ( u32 Offset ) { return Offset < Header.StringsSize; };
+    auto IsRange = [] ( u32 First, u32 Count, u32 Size ) { return (u64)First + Count <= Size; };
+
+    for ( u32 i = 0; i < Header.SourceCount; i++ )
+    {
+        if ( !IsString( pSources[ i ].Path ) )
+        {
+            return False;
+        }
+    }
+
+    for ( u32 i = 0; i < 2; i++ )
+    {
+        if ( !IsRange( Header.Sections[ i ][ 0 ], Header.Sections[ i ][ 1 ], Header.OperationCount ) )
+        {
+            return False;
+        }
+    }
+
+    const SceneEntry* pScenes = reinterpret_cast<const SceneEntry*>(pSources + Header.SourceCount);
+    for ( u32 i = 0; i < Header.SceneCount; i++ )
+    {
+        if ( !IsString( pScenes[ i ].Name ) ||
+             !IsRange( pScenes[ i ].First, pScenes[ i ].Count, Header.OperationCount ) )
+        {
+            return False;
+        }
+    }
+
+    const Property* pProperties = reinterpret_cast<const Property*>(pScenes + Header.SceneCount);
+    for ( u32 i = 0; i < Header.PropertyCount; i++ )
+    {
+        if ( !IsString( pProperties[ i ].Name ) )
+        {
+            return False;
+        }
+
+        for ( u32 iValue=0; iValue < Properties::Values::Count; iValue++ )
+        {
+            u32 Type = (pProperties[ i ].Type >> (iValue * 8)) & 0xFF;
+            if ( (Type == Properties::Values::String || Type == Properties::Values::Path) &&
+                 !IsString( pProperties[ i ].Values[ iValue ] ) )
+            {
+                return False;
+            }
+        }
+    }
+
+    const Operation* pOperations = reinterpret_cast<const Operation*>(pProperties + Header.PropertyCount);
+    for ( u32 i = 0; i < Header.OperationCount; i++ )
+    {
+        const u32* Args = pOperations[ i ].Args;
+        Bool bValid;
+        switch ( pOperations[ i ].Code )
+        {
+        case Operation::SetVariable:
+        case Operation::LoadSystem:
+        case Operation::CreateLink:
+            bValid = IsString( Args[ 0 ] ) && IsString( Args[ 1 ] );
+            break;
+
+        case Operation::SetNextScene:
+        case Operation::SetObjectName:
+            bValid = IsString( Args[ 0 ] );
+            break;
+
+        case Operation::ExtendObject:
+            bValid = Args[ 1 ] == NoString || IsString( Args[ 1 ] );
+            break;
+
+        case Operation::InitializeSystem:
+            bValid = IsRange( Args[ 0 ], Args[ 1 ], Header.PropertyCount );
+            break;
+
+        case Operation::InitializeScene:
+        case Operation::SetObjectProperties:
+            bValid = IsRange( Args[ 1 ], Args[ 2 ], Header.PropertyCount );
+            break;
+
+        case Operation::ExtendScenes:
+        case Operation::PreLoadingObjects:
+        case Operation::CreateObject:
+        case Operation::PostLoadingObjects:
+            bValid = True;
+            break;
+
+        default:
+            bValid = False;
+            break;
+        }
+
+        if ( !bValid )
+        {
+            return False;
+        }
+    }
+
+    return True;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Unload - Unmap the loaded file
+void
+SceneCache::Unload(
+    void
+    )
+{
+    if ( m_pData != nullptr )
+    {
+        Base::UnmapFile( m_pData, m_Size );
+        m_pData = nullptr;
+        m_Size = 0;
+        m_pHeader = nullptr;
+        m_pScenes = nullptr;
+        m_pProperties = nullptr;
+        m_pOperations = nullptr;
+        m_pszStrings = nullptr;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// GetOperations - Get the operations of a section of the loaded file
+const SceneCache::Operation*
+SceneCache::GetOperations(
+    Section Section,
+    pcstr pszScene,
+    u32& Count
+    ) const
+{
+    Count = 0;
+
+    if ( m_pHeader == nullptr )
+    {
+        return nullptr;
+    }
+
+    if ( Section != Scene )
+    {
+        Count = m_pHeader->Sections[ Section ][ 1 ];
+        return m_pOperations + m_pHeader->Sections[ Section ][ 0 ];
+    }
+
+    for ( u32 i = 0; i < m_pHeader->SceneCount; i++ )
+    {
+        if ( strcmp( GetString( m_pScenes[ i ].Name ), pszScene ) == 0 )
+        {
+            Count = m_pScenes[ i ].Count;
+            return m_pOperations + m_pScenes[ i ].First;
+        }
+    }
+
+    return nullptr;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// AddSource - Add a file the GDF was compiled from
+void
+SceneCache::AddSource(
+    pcstr pszFile
+    )
+{
+    for ( const auto& sSource : m_Sources )
+    {
+        if ( sSource == pszFile )
+        {
+            return;
+        }
+    }
+
+    m_Sources.push_back( pszFile );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// BeginSection - Start a section
+void
+SceneCache::BeginSection(
+    Section Section,
+    pcstr pszScene
+    )
+{
+    EndSection();
+
+    m_Section = Section;
+    m_SectionName = AddString( pszScene );
+    m_SectionStart = (u32)m_Operations.size();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// EndSection - Finish the current section
+void
+SceneCache::EndSection(
+    void
+    )
+{
+    u32 Count = (u32)m_Operations.size() - m_SectionStart;
+
+    if ( m_Section != Scene )
+    {
+        m_aSections[ m_Section ][ 0 ] = m_SectionStart;
+        m_aSections[ m_Section ][ 1 ] = Count;
+    }
+    else if ( m_SectionName != NoString )
+    {
+        SceneEntry Entry = { m_SectionName, m_SectionStart, Count };
+        m_Scenes.push_back( Entry );
+    }
+
+    // Operations after the end are not part of any section.
+    m_Section = Scene;
+    m_SectionName = NoString;
+    m_SectionStart = (u32)m_Operations.size();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// AddOperation - Add an operation to the current section
+void
+SceneCache::AddOperation(
+    Operation::Codes Code,
+    u32 Arg0,
+    u32 Arg1,
+    u32 Arg2,
+    u32 Arg3
+    )
+{
+    Operation Op = { (u32)Code, { Arg0, Arg1, Arg2, Arg3 } };
+    m_Operations.push_back( Op );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// AddString - Add a string to the string table
+u32
+SceneCache::AddString(
+    pcstr pszString
+    )
+{
+    if ( pszString == nullptr )
+    {
+        return NoString;
+    }
+
+    auto it = m_StringOffsets.find( pszString );
+    if ( it != m_StringOffsets.end() )
+    {
+        return it->second;
+    }
+
+    u32 Offset = (u32)m_Strings.size();
+    m_Strings.append( pszString );
+    m_Strings.push_back( '\0' );
+    m_StringOffsets[ pszString ] = Offset;
+
+    return Offset;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// AddProperties - Add the values of properties to the property table
+u32
+SceneCache::AddProperties(
+    const Properties::Array& Properties
+    )
+{
+    u32 First = (u32)m_Properties.size();
+
+    for ( const auto& Prop : Properties )
+    {
+        Property Entry;
+        Entry.Name = AddString( Prop.GetName() );
+        Entry.Type = 0;
+
+        for ( u32 i = 0; i < Properties::Values::Count; i++ )
+        {
+            u32 ValueType = Prop.GetValueType( i );
+            Entry.Type |= ValueType << (i * 8);
+            Entry.Values[ i ] = 0;
+
+            switch ( ValueType )
+            {
+            case Properties::Values::None:
+                break;
+
+            case Properties::Values::Boolean:
+            case Properties::Values::Enum:
+            case Properties::Values::Int32:
+                Entry.Values[ i ] = (u32)Prop.GetInt32( i );
+                break;
+
+            case Properties::Values::String:
+            case Properties::Values::Path:
+                Entry.Values[ i ] = AddString( Prop.GetStringPtr( i ) );
+                break;
+
+            default:
+            {
+                // Floats, angles and the components of vectors and colors.
+                f32 Value = Prop.GetFloat32( i );
+                memcpy( &Entry.Values[ i ], &Value, sizeof Value );
+                break;
+            }
+            }
+        }
+
+        m_Properties.push_back( Entry );
+    }
+
+    return First;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Write - Write out the compiled file
+Error
+SceneCache::Write(
+    pcstr pszFile
+    )
+{
+    EndSection();
+
+    std::vector<Source> aSources;
+    for ( const auto& sSource : m_Sources )
+    {
+        Source Entry = { AddString( sSource.c_str() ), 0, 0, 0 };
+        if ( !HashFile( sSource.c_str(), Entry.Size, Entry.Hash ) )
+        {
+            std::cerr << "SceneCache could not read " << sSource << "." << std::endl;
+            return Errors::File::NotFound;
+        }
+        aSources.push_back( Entry );
+    }
+
+    Header Head;
+    memcpy( Head.Magic, Magic, sizeof Magic );
+    Head.Version = Version;
+    Head.SourceCount = (u32)aSources.size();
+    Head.SceneCount = (u32)m_Scenes.size();
+    Head.PropertyCount = (u32)m_Properties.size();
+    Head.OperationCount = (u32)m_Operations.size();
+    if ( m_Strings.empty() )
+    {
+        m_Strings.push_back( '\0' );
+    }
+    Head.StringsSize = (u32)m_Strings.size();
+    memcpy( Head.Sections, m_aSections, sizeof Head.Sections );
+    Head.Reserved = 0;
+    Head.Size = (u32)(sizeof Head + aSources.size() * sizeof (Source) +
+                      m_Scenes.size() * sizeof (SceneEntry) +
+                      m_Properties.size() * sizeof (Property) +
+                      m_Operations.size() * sizeof (Operation) +
+                      m_Strings.size());
+
+    FILE* pFile = fopen( pszFile, "wb" );
+    if ( pFile == nullptr )
+    {
+        std::cerr << "SceneCache could not open " << pszFile << " for writing." << std::endl;
+        return Errors::File::NotFound;
+    }
+
+    fwrite( &Head, sizeof Head, 1, pFile );
+    fwrite( aSources.data(), sizeof (Source), aSources.size(), pFile );
+    fwrite( m_Scenes.data(), sizeof (SceneEntry), m_Scenes.size(), pFile );
+    fwrite( m_Properties.data(), sizeof (Property), m_Properties.size(), pFile );
+    fwrite( m_Operations.data(), sizeof (Operation), m_Operations.size(), pFile );
+    fwrite( m_Strings.data(), 1, m_Strings.size(), pFile );
+    Bool bWritten = ferror( pFile ) == 0;
+    bWritten &= fclose( pFile ) == 0;
+
+    if ( !bWritten )
+    {
+        std::cerr << "SceneCache could not write " << pszFile << "." << std::endl;
+        remove( pszFile );
+        return Errors::Failure;
+    }
+
+    std::clog << "SceneCache compiled " << m_Sources.size() << " files into " << pszFile
+              << " (" << m_Operations.size() << " operations, " << m_Properties.size()
+              << " properties, " << Head.Size << " bytes)" << std::endl;
+
+    return Errors::Success;
+}
@@ -0,0 +1,236 @@
+// Copyright  2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// <summary>
+///   A GDF compiled together with all the files it references into a single binary file.
+/// </summary>
+/// <remarks>
+///   The file holds what the GDF parser did while reading the XML, as a list of operations
+///   on the systems, scenes and objects.  Names are stored once in a string table and the
+///   property values are stored already converted to their types.  The file is mapped into
+///   memory and replayed without any parsing.  It records the size and hash of every file it
+///   was compiled from and is not used when any of them changed.
+/// </remarks>
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class SceneCache
+{
+public:
+
+    static const u32 Version = 1;
+
+    /// <summary>
+    ///   The parts of the GDF, each is replayed by the parser function of the same name.
+    /// </summary>
+    enum Section
+    {
+        Environment, Systems, Scene
+    };
+
+    /// <summary>
+    ///   An action of the parser, the arguments depend on the code.
+    /// </summary>
+    struct Operation
+    {
+        enum Codes
+        {
+            SetVariable,            // Name, Value
+            LoadSystem,             // Type, Lib, replaced by a NullSystem
+            InitializeSystem,       // First property, property count
+            SetNextScene,           // Name
+            ExtendScenes,           //
+            InitializeScene,        // System type, first property, property count
+            PreLoadingObjects,      //
+            CreateObject,           //
+            SetObjectName,          // Name
+            ExtendObject,           // System type, object type or NoString
+            SetObjectProperties,    // System type, first property, property count
+            CreateLink,             // Subject, observer, subject system type or Null, observer system type
+            PostLoadingObjects,     //
+        };
+
+        u32                             Code;
+        u32                             Args[ 4 ];
+    };
+
+    /// <summary>
+    ///   A property with its values, strings are offsets into the string table.
+    /// </summary>
+    struct Property
+    {
+        u32                             Name;
+        u32                             Type;
+        u32                             Values[ Properties::Values::Count ];
+    };
+
+    static const u32 NoString = static_cast<u32>(-1);
+
+    SceneCache( void );
+
+    ~SceneCache( void );
+
+    /// <summary>
+    ///   Gets the name of the compiled file for a GDF.
+    /// </summary>
+    static std::string GetCacheFile( pcstr pszGDF );
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Loading.
+
+    /// <summary>
+    ///   Maps a compiled file and checks that it is complete and up to date.
+    /// </summary>
+    /// <param name="pszFile">The compiled file.</param>
+    /// <returns>An error code, nothing is loaded unless it is Errors::Success.</returns>
+    Error Load( pcstr pszFile );
+
+    /// <summary>
+    ///   Unmaps the loaded file.
+    /// </summary>
+    void Unload( void );
+
+    Bool IsLoaded( void ) const
+    {
+        return m_pData != nullptr;
+    }
+
+    /// <summary>
+    ///   Gets the operations of a section of the loaded file.
+    /// </summary>
+    /// <param name="Section">The section.</param>
+    /// <param name="pszScene">The name of the scene for the Scene section.</param>
+    /// <param name="Count">Receives the number of operations.</param>
+    /// <returns>The first operation, or null if the section is not in the file.</returns>
+    const Operation* GetOperations( Section Section, pcstr pszScene, u32& Count ) const;
+
+    const Property& GetProperty( u32 Index ) const
+    {
+        return m_pProperties[ Index ];
+    }
+
+    pcstr GetString( u32 Offset ) const
+    {
+        return Offset != NoString ? m_pszStrings + Offset : nullptr;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Compiling.
+
+    /// <summary>
+    ///   Adds a file the GDF was compiled from.
+    /// </summary>
+    void AddSource( pcstr pszFile );
+
+    /// <summary>
+    ///   Starts a section, the following operations belong to it.
+    /// </summary>
+    void BeginSection( Section Section, pcstr pszScene = nullptr );
+
+    void AddOperation( Operation::Codes Code, u32 Arg0 = 0, u32 Arg1 = 0, u32 Arg2 = 0, u32 Arg3 = 0 );
+
+    /// <summary>
+    ///   Adds a string to the string table unless it is there already.
+    /// </summary>
+    /// <returns>The offset of the string, NoString for null.</returns>
+    u32 AddString( pcstr pszString );
+
+    /// <summary>
+    ///   Adds the values of properties to the property table.
+    /// </summary>
+    /// <returns>The index of the first property.</returns>
+    u32 AddProperties( const Properties::Array& Properties );
+
+    /// <summary>
+    ///   Writes out the compiled file.
+    /// </summary>
+    Error Write( pcstr pszFile );
+
+
+protected:
+
+    /// <summary>
+    ///   The layout of the file.  The header is followed by the sources, the scenes, the
+    ///   properties, the operations and the strings.
+    /// </summary>
+    struct Header
+    {
+        char                            Magic[ 8 ];
+        u32                             Version;
+        u32                             Size;
+        u32                             SourceCount;
+        u32                             SceneCount;
+        u32                             PropertyCount;
+        u32                             OperationCount;
+        u32                             StringsSize;
+        // First operation and count of the Environment and Systems sections.
+        u32                             Sections[ 2 ][ 2 ];
+        u32                             Reserved;
+    };
+
+    struct Source
+    {
+        u32                             Path;
+        u32                             Reserved;
+        u64                             Size;
+        u64                             Hash;
+    };
+
+    struct SceneEntry
+    {
+        u32                             Name;
+        u32                             First;
+        u32                             Count;
+    };
+
+    /// <summary>
+    ///   Gets the size and hash of the contents of a file.
+    /// </summary>
+    static Bool HashFile( pcstr pszFile, u64& Size, u64& Hash );
+
+    /// <summary>
+    ///   Checks that every range and offset in the tables of a mapped file stays inside
+    ///   its tables, so a damaged file is never read past its end.
+    /// </summary>
+    static Bool CheckTables( const Header& Header, const Source* pSources );
+
+    void EndSection( void );
+
+    // The mapped file.
+    const void*                         m_pData;
+    size_t                              m_Size;
+    const Header*                       m_pHeader;
+    const SceneEntry*                   m_pScenes;
+    const Property*                     m_pProperties;
+    const Operation*                    m_pOperations;
+    pcstr                               m_pszStrings;
+
+    // The file being compiled.
+    std::vector<std::string>            m_Sources;
+    std::string                         m_Strings;
+    std::unordered_map<std::string, u32> m_StringOffsets;
+    std::vector<Property>               m_Properties;
+    std::vector<Operation>              m_Operations;
+    std::vector<SceneEntry>             m_Scenes;
+    u32                                 m_aSections[ 2 ][ 2 ];
+    Section                             m_Section;
+    u32                                 m_SectionName;
+    u32                                 m_SectionStart;
+};
@@ -18,19 +18,45 @@
 //interface
 #include "Interfaces/Interface.hpp"
 //stdlib
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <thread>
 //framework
 #include "Framework/EnvironmentManager.hpp"
 #include "Framework/ServiceManager.hpp"
 #include "Framework/Universal.hpp"
+#include "Framework/ChangeControlManager.hpp"
 #include "Framework/TaskManager.hpp"
+#include "Framework/Instrumentation.hpp"
 #include "Framework/Scheduler.hpp"
 
-Scheduler::Scheduler()
+// Changes handled by the framework itself do not order the systems.
+static const System::Changes::BitMask FrameworkChanges =
+    System::Changes::Generic::All | System::Changes::Link | System::Changes::ParentLink;
+
+Scheduler::Scheduler( ChangeManager* pObjectCCM )
+    : m_Akkumulator( 0.0f )
+    , m_pObjectCCM( pObjectCCM )
+    , m_Remaining( 0 )
+    , m_DeltaTime( 0.0f )
+    , m_FixedDeltaTime( 0.0f )
+    , m_GraphSystems( System::Types::All )
+    , m_Graph( 0 )
+    , m_DroppedSteps( 0 )
+    , m_PresentationSystems( System::Types::Null )
+    , m_CriticalPathLength( 0.0f )
 {
 
     m_bBenchmarkingEnabled = EnvironmentManager::getInstance().Variables().GetAsBool( "Scheduler::Benchmarking", False );
     m_bThreadingEnabled = EnvironmentManager::getInstance().Variables().GetAsBool( "Scheduler::Parallel", False );
+    m_bReportCriticalPath = EnvironmentManager::getInstance().Variables().GetAsBool( "Scheduler::ReportCriticalPath", False );
+
+    m_FixedTimeStep = EnvironmentManager::getInstance().Variables().GetAsFloat( "Scheduler::FixedTimeStep", 0.0f );
+    m_MaxSubsteps = std::max( EnvironmentManager::getInstance().Variables().GetAsInt( "Scheduler::MaxSubsteps", 5 ), 1 );
+    m_sPresentationSystems = EnvironmentManager::getInstance().Variables().GetAsString(
+        "Scheduler::PresentationSystems", "Graphics Input Audio" );
+    std::replace( m_sPresentationSystems.begin(), m_sPresentationSystems.end(), ',', ' ' );
 }
 
 void
@@ -44,7 +70,7 @@ Scheduler::SetScene(
     std::vector <ISystemTask*> aScenesToWaitFor;
     for (const auto &it : m_SceneExecs)
     {
-        ISystemScene* pSystemScene = it.second;        
+        ISystemScene* pSystemScene = it.second;
         aScenesToWaitFor.push_back(pSystemScene->GetSystemTask());
     }
     m_SceneExecs.clear();
@@ -66,29 +92,273 @@ Scheduler::SetScene(
             m_SceneExecs[ SystemScene.first ] = SystemScene.second;
         }
     }
-    
+
+    BuildGraph( pScene );
+
     m_OldTime = std::chrono::high_resolution_clock::now();
 }
 
 
 void
+Scheduler::BuildGraph(
+    const UScene* pScene
+    )
+{
+    m_Nodes.clear();
+    m_PresentationSystems = System::Types::Null;
+
+    std::vector<System::Changes::BitMask> aPotential;
+    std::vector<System::Changes::BitMask> aDesired;
+
+    for (const auto &it : m_SceneExecs)
+    {
+        Node node;
+        node.pScene = it.second;
+        node.pTask = it.second->GetSystemTask();
+        node.Type = it.first;
+        node.pszName = it.second->GetSystem()->GetName();
+        node.Graph = 0;
+        node.Time = 0.0f;
+        m_Nodes.push_back( node );
+
+        // The presentation systems are listed by name separated by spaces or commas.
+        std::istringstream Stream( m_sPresentationSystems );
+        std::string sSystem;
+        while ( Stream >> sSystem )
+        {
+            if ( sSystem == node.pszName )
+            {
+                m_PresentationSystems |= node.Type;
+            }
+        }
+
+        // The scene masks alone are too coarse, combine them with those of the scene's objects.
+        System::Changes::BitMask Potential = it.second->GetPotentialSystemChanges();
+        System::Changes::BitMask Desired = it.second->GetDesiredSystemChanges();
+        for (const auto &pObject : pScene->GetObjects())
+        {
+            ISystemObject* pSystemObject = pObject->GetExtension( it.first );
+            if ( pSystemObject != nullptr )
+            {
+                Potential |= pSystemObject->GetPotentialSystemChanges();
+                Desired |= pSystemObject->GetDesiredSystemChanges();
+            }
+        }
+        m_Nodes.back().Potential = Potential;
+        m_Nodes.back().Desired = Desired;
+        aPotential.push_back( Potential & ~FrameworkChanges );
+        aDesired.push_back( Desired & ~FrameworkChanges );
+    }
+
+    // Add an edge from every producer to every consumer of its changes.  Edges which would close
+    // a cycle are dropped, these changes are delivered at the end of the frame as before.
+    u32 uNodes = (u32)m_Nodes.size();
+    for ( u32 i = 0; i < uNodes; i++ )
+    {
+        for ( u32 j = 0; j < uNodes; j++ )
+        {
+            if ( i != j && (aPotential[ i ] & aDesired[ j ]) && !IsReachable( j, i ) )
+            {
+                m_Nodes[ i ].Successors.push_back( j );
+                m_Nodes[ j ].Predecessors.push_back( i );
+            }
+        }
+    }
+
+    m_aPending.reset( new std::atomic<u32>[ uNodes ] );
+}
+
+
+bool
+Scheduler::IsReachable(
+    u32 Source,
+    u32 Target
+    ) const
+{
+    if ( Source == Target )
+    {
+        return true;
+    }
+
+    std::vector<bool> abVisited( m_Nodes.size(), false );
+    std::vector<u32> aStack( 1, Source );
+    abVisited[ Source ] = true;
+
+    while ( !aStack.empty() )
+    {
+        u32 uNode = aStack.back();
+        aStack.pop_back();
+
+        for ( u32 uSuccessor : m_Nodes[ uNode ].Successors )
+        {
+            if ( uSuccessor == Target )
+            {
+                return true;
+            }
+            if ( !abVisited[ uSuccessor ] )
+            {
+                abVisited[ uSuccessor ] = true;
+                aStack.push_back( uSuccessor );
+            }
+        }
+    }
+
+    return false;
+}
+
+
+System::Types::BitMask
+Scheduler::GetAffectedSystems(
+    System::Types::BitMask Systems
+    ) const
+{
+    // Follow the changes from producers to consumers until no more systems are added.
+    Bool bAdded = True;
+    while ( bAdded )
+    {
+        bAdded = False;
+        for ( const Node& producer : m_Nodes )
+        {
+            if ( (Systems & producer.Type) == 0 )
+            {
+                continue;
+            }
+
+            for ( const Node& consumer : m_Nodes )
+            {
+                if ( (Systems & consumer.Type) == 0 && (producer.Potential & consumer.Desired) )
+                {
+                    Systems |= consumer.Type;
+                    bAdded = True;
+                }
+            }
+        }
+    }
+
+    return Systems;
+}
+
+
+void
+Scheduler::AddPendingDistribution(
+    System::Types::BitMask Systems,
+    TaskGroup* pGroup
+    )
+{
+    std::lock_guard<std::mutex> lock( m_DistributionMutex );
+
+    // Forget about the distributions which are done, their groups may be reused.
+    m_PendingDistributions.erase(
+        std::remove_if( m_PendingDistributions.begin(), m_PendingDistributions.end(),
+                        [] ( const PendingDistribution& Pending ) { return Pending.pGroup->IsDone(); } ),
+        m_PendingDistributions.end() );
+
+    if ( Systems != System::Types::Null )
+    {
+        PendingDistribution Pending = { Systems, pGroup, False };
+        m_PendingDistributions.push_back( Pending );
+    }
+}
+
+
+void
+Scheduler::FinishDistribution(
+    TaskGroup* pGroup
+    )
+{
+    std::vector<u32> aReady;
+    {
+        std::lock_guard<std::mutex> lock( m_DistributionMutex );
+
+        for ( PendingDistribution& Pending : m_PendingDistributions )
+        {
+            if ( Pending.pGroup == pGroup )
+            {
+                Pending.bFinished = True;
+            }
+        }
+
+        auto it = std::partition( m_DeferredNodes.begin(), m_DeferredNodes.end(),
+                                  [this] ( u32 uNode ) { return IsHeldBack( m_Nodes[ uNode ].Type ); } );
+        aReady.assign( it, m_DeferredNodes.end() );
+        m_DeferredNodes.erase( it, m_DeferredNodes.end() );
+    }
+
+    for ( u32 uNode : aReady )
+    {
+        TaskManager::getInstance().AddTask( [this, uNode] () { RunNode( uNode ); } );
+    }
+}
+
+
+Bool
+Scheduler::IsHeldBack(
+    System::Type Type
+    ) const
+{
+    for ( const PendingDistribution& Pending : m_PendingDistributions )
+    {
+        if ( (Pending.Systems & Type) && !Pending.bFinished )
+        {
+            return True;
+        }
+    }
+    return False;
+}
+
+
+void
+Scheduler::WaitForPendingDistributions(
+    System::Type Type
+    )
+{
+    std::vector<TaskGroup*> aGroups;
+    {
+        std::lock_guard<std::mutex> lock( m_DistributionMutex );
+        for ( const PendingDistribution& Pending : m_PendingDistributions )
+        {
+            if ( (Pending.Systems & Type) && !Pending.bFinished )
+            {
+                aGroups.push_back( Pending.pGroup );
+            }
+        }
+    }
+
+    for ( TaskGroup* pGroup : aGroups )
+    {
+        TaskManager::getInstance().WaitForTaskGroup( *pGroup );
+    }
+}
+
+
+Bool
 Scheduler::Execute(
     void
     )
 {
     m_NewTime = std::chrono::high_resolution_clock::now();
-    
+
     // Ticks per second;
     auto DeltaTime =std::chrono::duration<float, std::ratio<1>>(m_NewTime - m_OldTime).count();
-    m_OldTime = m_NewTime;  
-    
-    // Force 120hz      
+    m_OldTime = m_NewTime;
+
+    if ( m_FixedDeltaTime > 0.0f )
+    {
+        DeltaTime = m_FixedDeltaTime;
+    }
+
+    if ( m_FixedTimeStep > 0.0f )
+    {
+        return ExecuteFixedSteps( DeltaTime );
+    }
+
+    // Force 120hz
     if (!m_bBenchmarkingEnabled)
     {
         m_Akkumulator += DeltaTime;
         if( m_Akkumulator < (1.0f / 120.0f))
         {
-            return;
+            return False;
         }
         else
         {
@@ -96,48 +366,354 @@ Scheduler::Execute(
             m_Akkumulator = 0.0f;
         }
     }
-    
-    
+
+
     // Check if the execution is paused, and set delta time to 0 if so.
     if ( EnvironmentManager::getInstance().Runtime().GetStatus() ==
          IEnvironment::IRuntime::Status::Paused )
     {
         DeltaTime = 0.0f;
     }
-    
+
+    m_FrameStart = std::chrono::high_resolution_clock::now();
+    Instrumentation::Scope FrameScope( "Frame", "Frame" );
+
+    for ( Node& node : m_Nodes )
+    {
+        node.Time = 0.0f;
+    }
+    ExecuteGraph( System::Types::All, DeltaTime );
+
+    UpdateCriticalPath();
+
+    return True;
+}
+
+
+Bool
+Scheduler::ExecuteFixedSteps(
+    f32 DeltaTime
+    )
+{
+    u32 Steps;
+    f32 StepTime = m_FixedTimeStep;
+    f32 Interpolation = 1.0f;
+
+    if ( EnvironmentManager::getInstance().Runtime().GetStatus() ==
+         IEnvironment::IRuntime::Status::Paused )
+    {
+        // Keep the systems updating without advancing them.
+        m_Akkumulator = 0.0f;
+        Steps = 1;
+        StepTime = 0.0f;
+        DeltaTime = 0.0f;
+    }
+    else
+    {
+        m_Akkumulator += DeltaTime;
+        Steps = (u32)(m_Akkumulator / m_FixedTimeStep);
+        m_Akkumulator = std::max( m_Akkumulator - Steps * m_FixedTimeStep, 0.0f );
+
+        // Catching up on a long frame would make the next one even longer, so the steps over
+        // the limit are dropped and the simulation falls behind instead.
+        if ( Steps > m_MaxSubsteps )
+        {
+            m_DroppedSteps += Steps - m_MaxSubsteps;
+            Steps = m_MaxSubsteps;
+        }
+
+        Interpolation = std::min( m_Akkumulator / m_FixedTimeStep, 1.0f );
+    }
+
+    if ( Steps == 0 && m_PresentationSystems == System::Types::Null )
+    {
+        return False;
+    }
+
+    m_FrameStart = std::chrono::high_resolution_clock::now();
+    Instrumentation::Scope FrameScope( "Frame", "Frame" );
+
+    for ( Node& node : m_Nodes )
+    {
+        node.Time = 0.0f;
+    }
+
+    // The changes of the presentation systems, such as the input, reach the simulation
+    // with the next frame.
+    for ( u32 i = 0; i < Steps; i++ )
+    {
+        Instrumentation::Scope StepScope( "Step", "Frame" );
+        ExecuteGraph( ~m_PresentationSystems, StepTime );
+    }
+
+    if ( m_PresentationSystems != System::Types::Null )
+    {
+        EnvironmentManager::getInstance().Runtime().SetInterpolation( Interpolation );
+        ExecuteGraph( m_PresentationSystems, DeltaTime );
+    }
+
+    UpdateCriticalPath();
+
+    return True;
+}
+
+
+void
+Scheduler::ExecuteGraph(
+    System::Types::BitMask Systems,
+    f32 DeltaTime
+    )
+{
+    m_GraphSystems = Systems;
+    m_DeltaTime = DeltaTime;
+    m_Graph++;
+
+    // Only the dependencies between the systems being updated count, start with the nodes
+    // that have none.
+    u32 uNodes = (u32)m_Nodes.size();
+    u32 uCount = 0;
+    std::vector<u32> aReady;
+    for ( u32 i = uNodes; i-- > 0; )
+    {
+        if ( (m_Nodes[ i ].Type & Systems) == 0 )
+        {
+            continue;
+        }
+
+        u32 uPending = 0;
+        for ( u32 uPredecessor : m_Nodes[ i ].Predecessors )
+        {
+            if ( m_Nodes[ uPredecessor ].Type & Systems )
+            {
+                uPending++;
+            }
+        }
+        m_aPending[ i ].store( uPending, std::memory_order_relaxed );
+        uCount++;
+
+        if ( uPending == 0 )
+        {
+            aReady.push_back( i );
+        }
+    }
+
     if ( m_bThreadingEnabled )
     {
-        // Schedule the scenes that are ready for execution.
-        std::vector<ISystemTask*> aScenesToExecute;
+        m_Remaining.store( uCount, std::memory_order_release );
 
-        for (const auto &it : m_SceneExecs)
+        for ( auto it = aReady.rbegin(); it != aReady.rend(); ++it )
         {
-            ISystemScene* pSystemScene = it.second;
-            ISystemTask*  pSystemTask = pSystemScene->GetSystemTask();
-            aScenesToExecute.push_back(pSystemTask);
+            Launch( *it );
         }
 
-        TaskManager::getInstance().EnqueueTasks( aScenesToExecute, DeltaTime );
+        // Run the nodes which have to stay on this thread and help out with the others.
+        while ( m_Remaining.load( std::memory_order_acquire ) != 0 )
+        {
+            u32 uNode = (u32)-1;
+            {
+                std::lock_guard<std::mutex> lock( m_PrimaryMutex );
+                if ( !m_PrimaryReady.empty() )
+                {
+                    uNode = m_PrimaryReady.back();
+                    m_PrimaryReady.pop_back();
+                }
+            }
+
+            if ( uNode != (u32)-1 )
+            {
+                RunNode( uNode );
+            }
+            else if ( !TaskManager::getInstance().HelpOnce() )
+            {
+                std::this_thread::yield();
+            }
+        }
 
-#if 0
-        // Wait for the scenes that will be completing execution in this frame.
-        std::vector<ISystemTask*>  aScenesToWaitFor;
-        for (const auto &it : m_SceneExecs)
+        // The systems issue their work through ParallelFor which joins by itself, so there is
+        // nothing left to wait for.  Distributions of earlier frames may still be running.
+    }
+    else
+    {
+        // Walk the graph in dependency order so the systems receive their changes
+        // the same way as when running in parallel.
+        while ( !aReady.empty() )
         {
-            ISystemScene* pSystemScene = it->second;
-            aScenesToWaitFor.push_back(pSystemScene->GetSystemTask());
+            u32 uNode = aReady.back();
+            aReady.pop_back();
+
+            Node& node = m_Nodes[ uNode ];
+            node.Start = std::chrono::high_resolution_clock::now();
+            node.Graph = m_Graph;
+            WaitForPendingDistributions( node.Type );
+            m_pObjectCCM->DistributeQueuedChangesToSystem( node.Type );
+            {
+                Instrumentation::Scope UpdateScope( node.pszName, "System" );
+                node.pTask->Update( m_DeltaTime );
+            }
+            node.End = std::chrono::high_resolution_clock::now();
+            node.Time += std::chrono::duration<f32, std::ratio<1>>( node.End - node.Start ).count();
+
+            for ( auto it = node.Successors.rbegin(); it != node.Successors.rend(); ++it )
+            {
+                if ( (m_Nodes[ *it ].Type & Systems) &&
+                     m_aPending[ *it ].fetch_sub( 1, std::memory_order_relaxed ) == 1 )
+                {
+                    aReady.push_back( *it );
+                }
+            }
         }
+    }
+}
 
-        TaskManager::getInstance().WaitForTasks( aScenesToWaitFor );
-#endif /* 0 */
-        TaskManager::getInstance().WaitForAllTasks();
+
+void
+Scheduler::Launch(
+    u32 uNode
+    )
+{
+    if ( m_Nodes[ uNode ].pTask->IsThreadSafe() )
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_DistributionMutex );
+            if ( IsHeldBack( m_Nodes[ uNode ].Type ) )
+            {
+                m_DeferredNodes.push_back( uNode );
+                return;
+            }
+        }
+        TaskManager::getInstance().AddTask( [this, uNode] () { RunNode( uNode ); } );
     }
     else
     {
-        for (const auto &it : m_SceneExecs)
+        std::lock_guard<std::mutex> lock( m_PrimaryMutex );
+        m_PrimaryReady.push_back( uNode );
+    }
+}
+
+
+void
+Scheduler::RunNode(
+    u32 uNode
+    )
+{
+    Node& node = m_Nodes[ uNode ];
+    node.Start = std::chrono::high_resolution_clock::now();
+    node.Graph = m_Graph;
+
+    // All the systems this one depends on are done, hand it their changes.
+    WaitForPendingDistributions( node.Type );
+    m_pObjectCCM->DistributeQueuedChangesToSystem( node.Type );
+
+    {
+        Instrumentation::Scope UpdateScope( node.pszName, "System" );
+        node.pTask->Update( m_DeltaTime );
+    }
+    node.End = std::chrono::high_resolution_clock::now();
+    node.Time += std::chrono::duration<f32, std::ratio<1>>( node.End - node.Start ).count();
+
+    for ( u32 uSuccessor : node.Successors )
+    {
+        if ( (m_Nodes[ uSuccessor ].Type & m_GraphSystems) &&
+             m_aPending[ uSuccessor ].fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+        {
+            Launch( uSuccessor );
+        }
+    }
+
+    m_Remaining.fetch_sub( 1, std::memory_order_release );
+}
+
+
+void
+Scheduler::UpdateCriticalPath(
+    void
+    )
+{
+    m_CriticalPath.clear();
+    m_CriticalPathLength = 0.0f;
+
+    if ( m_Nodes.empty() )
+    {
+        return;
+    }
+
+    // Start with the node that finished last and follow the predecessor that finished last.
+    // Nodes left out of the frame or of the graph of their successor did not hold it back.
+    u32 uNode = (u32)-1;
+    for ( u32 i = 0; i < (u32)m_Nodes.size(); i++ )
+    {
+        if ( m_Nodes[ i ].End >= m_FrameStart &&
+             ( uNode == (u32)-1 || m_Nodes[ i ].End > m_Nodes[ uNode ].End ) )
+        {
+            uNode = i;
+        }
+    }
+    if ( uNode == (u32)-1 )
+    {
+        return;
+    }
+    m_CriticalPathLength = std::chrono::duration<float, std::ratio<1>>( m_Nodes[ uNode ].End - m_FrameStart ).count();
+
+    for (;;)
+    {
+        m_CriticalPath.push_back( uNode );
+
+        const Node& node = m_Nodes[ uNode ];
+        u32 uLast = (u32)-1;
+        for ( u32 uPredecessor : node.Predecessors )
+        {
+            const Node& predecessor = m_Nodes[ uPredecessor ];
+            if ( predecessor.Graph == node.Graph &&
+                 ( uLast == (u32)-1 || predecessor.End > m_Nodes[ uLast ].End ) )
+            {
+                uLast = uPredecessor;
+            }
+        }
+        if ( uLast == (u32)-1 )
+        {
+            break;
+        }
+        uNode = uLast;
+    }
+    std::reverse( m_CriticalPath.begin(), m_CriticalPath.end() );
+
+    if ( m_bReportCriticalPath )
+    {
+        std::clog << "Scheduler critical path " << m_CriticalPathLength * 1000.0f << "ms:";
+        for ( u32 uPathNode : m_CriticalPath )
         {
-            ISystemScene* pSystemScene = it.second;
-            pSystemScene->GetSystemTask()->Update( DeltaTime );
+            const Node& node = m_Nodes[ uPathNode ];
+            std::clog << " " << node.pScene->GetSystem()->GetName() << " ("
+                      << std::chrono::duration<float, std::milli>( node.End - node.Start ).count() << "ms)";
         }
+        std::clog << std::endl;
+    }
+}
+
+
+f32
+Scheduler::GetCriticalPath(
+    std::vector<System::Type>& Systems
+    ) const
+{
+    Systems.clear();
+    for ( u32 uNode : m_CriticalPath )
+    {
+        Systems.push_back( m_Nodes[ uNode ].Type );
+    }
+    return m_CriticalPathLength;
+}
+
+
+void
+Scheduler::GetSystemTimes(
+    std::vector<SystemTime>& Times
+    ) const
+{
+    Times.clear();
+    for ( const Node& node : m_Nodes )
+    {
+        SystemTime Time = { node.Type, node.pszName, node.Time };
+        Times.push_back( Time );
     }
 }
@@ -14,12 +14,29 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ChangeManager;
+class TaskGroup;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 /// <summary>
 ///   Handles scheduling of all task execution.
 /// </summary>
+/// <remarks>
+///   The system tasks are executed as a dependency graph.  A system depends on every system
+///   that can post changes it desires.  Before a system is updated it receives the queued
+///   changes of the systems it depends on, while unrelated systems keep running.
+///   With Scheduler::FixedTimeStep set the simulation systems advance in steps of constant
+///   time, as many per frame as the elapsed time covers, followed by a single update of the
+///   presentation systems (Scheduler::PresentationSystems) with the elapsed time.
+/// </remarks>
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 class Scheduler
@@ -29,8 +46,8 @@ public:
     /// <summary>
     ///   Constructor.
     /// </summary>
-    /// <param name="pTaskManager">A pointer to the task manager.</param>
-    Scheduler();
+    /// <param name="pObjectCCM">A pointer to the object change manager.</param>
+    Scheduler( ChangeManager* pObjectCCM );
 
     /// <summary>
     ///   Destructor.
@@ -45,6 +62,15 @@ public:
         m_bBenchmarkingEnabled = bEnable;
     }
 
+    /// <summary>
+    ///   Advances every frame by the given time instead of the measured one, zero turns it off.
+    ///   With fixed steps this is the time the steps are taken from.
+    /// </summary>
+    void SetFixedDeltaTime( f32 DeltaTime )
+    {
+        m_FixedDeltaTime = DeltaTime;
+    }
+
     /// <summary>
     ///   Sets the UScene to schedule execution of.
     /// </summary>
@@ -54,20 +80,191 @@ public:
     /// <summary>
     ///   Execute the set UScene.
     /// </summary>
-    void Execute( void );
+    /// <returns>True if the systems were updated, false if it was too early for a frame.</returns>
+    Bool Execute( void );
+
+    /// <summary>
+    ///   Holds back the given systems until the group of tasks distributing changes to them is
+    ///   done.  Other systems go on with the next frame meanwhile.
+    /// </summary>
+    /// <remarks>Must be called between frames.  The group may not be reused before it is done.</remarks>
+    /// <param name="Systems">The systems touched by the distribution.</param>
+    /// <param name="pGroup">The tasks distributing the changes.</param>
+    void AddPendingDistribution( System::Types::BitMask Systems, TaskGroup* pGroup );
+
+    /// <summary>
+    ///   Called by a distribution as its last step.  Launches the nodes it held back.
+    /// </summary>
+    /// <param name="pGroup">The group passed to <c>AddPendingDistribution</c>.</param>
+    void FinishDistribution( TaskGroup* pGroup );
+
+    /// <summary>
+    ///   Adds the systems which may receive changes posted by the given systems in response
+    ///   to their notifications.
+    /// </summary>
+    /// <param name="Systems">The systems receiving notifications.</param>
+    /// <returns>The systems including all those that may be notified in turn.</returns>
+    System::Types::BitMask GetAffectedSystems( System::Types::BitMask Systems ) const;
+
+    /// <summary>
+    ///   Gets the critical path of the last executed frame.
+    /// </summary>
+    /// <param name="Systems">Receives the system types along the path in execution order.</param>
+    /// <returns>The length of the path in seconds.</returns>
+    f32 GetCriticalPath( std::vector<System::Type>& Systems ) const;
+
+    /// <summary>
+    ///   The time a system took in the last executed frame.
+    /// </summary>
+    struct SystemTime
+    {
+        System::Type                    Type;
+        pcstr                           pszName;
+        f32                             Time;
+    };
+
+    /// <summary>
+    ///   Gets the time each system took in the last executed frame, including the delivery
+    ///   of its changes.  With fixed steps the time of all the steps is added up.
+    /// </summary>
+    /// <param name="Times">Receives the times in seconds.</param>
+    void GetSystemTimes( std::vector<SystemTime>& Times ) const;
+
+    /// <summary>
+    ///   Gets the number of fixed steps skipped because a frame would have needed more than
+    ///   Scheduler::MaxSubsteps of them to catch up.
+    /// </summary>
+    u64 GetDroppedSteps( void ) const
+    {
+        return m_DroppedSteps;
+    }
 
 
 protected:
 
+    typedef std::chrono::high_resolution_clock::time_point TimePoint;
+
+    /// <summary>
+    ///   A system task in the frame graph.
+    /// </summary>
+    struct Node
+    {
+        ISystemScene*                   pScene;
+        ISystemTask*                    pTask;
+        System::Type                    Type;
+        pcstr                           pszName;
+        System::Changes::BitMask        Potential;
+        System::Changes::BitMask        Desired;
+        std::vector<u32>                Predecessors;
+        std::vector<u32>                Successors;
+        TimePoint                       Start;
+        TimePoint                       End;
+        // The ExecuteGraph the node was last updated by.
+        u32                             Graph;
+        // Time spent in all the updates of the frame.
+        f32                             Time;
+    };
+
+    /// <summary>
+    ///   Builds the edges of the frame graph from the potential and desired changes
+    ///   of the system scenes and their objects.
+    /// </summary>
+    void BuildGraph( const UScene* pScene );
+
+    /// <summary>
+    ///   Returns true if Target can be reached from Source following the edges.
+    /// </summary>
+    bool IsReachable( u32 Source, u32 Target ) const;
+
+    /// <summary>
+    ///   Updates the given systems in dependency order, the others are left out.
+    /// </summary>
+    /// <param name="Systems">The systems to update.</param>
+    /// <param name="DeltaTime">The time to advance them by.</param>
+    void ExecuteGraph( System::Types::BitMask Systems, f32 DeltaTime );
+
+    /// <summary>
+    ///   Runs the fixed simulation steps covered by the elapsed time and then the
+    ///   presentation systems.
+    /// </summary>
+    /// <returns>True if any system was updated.</returns>
+    Bool ExecuteFixedSteps( f32 DeltaTime );
+
+    /// <summary>
+    ///   Makes a node ready to run, either as a task or on the primary thread.  A task held
+    ///   back by a distribution is launched once it finished, as a thread helping out inside
+    ///   the distribution could pick it up and would wait for itself.
+    /// </summary>
+    void Launch( u32 Node );
+
+    /// <summary>
+    ///   Delivers the changes for a node, updates it and launches the successors.
+    /// </summary>
+    void RunNode( u32 Node );
+
+    /// <summary>
+    ///   Waits for the distributions holding back the given system, helping out meanwhile.
+    /// </summary>
+    void WaitForPendingDistributions( System::Type Type );
+
+    /// <summary>
+    ///   Determines the critical path of the frame that just finished.
+    /// </summary>
+    void UpdateCriticalPath( void );
+
     std::chrono::high_resolution_clock::time_point m_OldTime;
     std::chrono::high_resolution_clock::time_point m_NewTime;
     float                           m_Akkumulator;
 
     Bool                            m_bBenchmarkingEnabled;
     Bool                            m_bThreadingEnabled;
+    Bool                            m_bReportCriticalPath;
 
     typedef std::map<System::Type, ISystemScene*>   SceneExecs;
     typedef SceneExecs::iterator                    SceneExecsIt;
 
     SceneExecs                      m_SceneExecs;
+
+    ChangeManager*                  m_pObjectCCM;
+
+    // The frame graph, nodes are ordered by system type.
+    std::vector<Node>               m_Nodes;
+    std::unique_ptr<std::atomic<u32>[]> m_aPending;
+    std::atomic<u32>                m_Remaining;
+    f32                             m_DeltaTime;
+    f32                             m_FixedDeltaTime;
+
+    // The systems updated by the running ExecuteGraph and how many ran before it.
+    System::Types::BitMask          m_GraphSystems;
+    u32                             m_Graph;
+
+    // Fixed steps of the simulation systems.
+    f32                             m_FixedTimeStep;
+    u32                             m_MaxSubsteps;
+    u64                             m_DroppedSteps;
+    std::string                     m_sPresentationSystems;
+    System::Types::BitMask          m_PresentationSystems;
+
+    // Nodes which are not thread safe and wait for the primary thread.
+    std::mutex                      m_PrimaryMutex;
+    std::vector<u32>                m_PrimaryReady;
+
+    // Change distributions still running from earlier frames and the systems they hold back,
+    // and the nodes waiting for them to finish.
+    struct PendingDistribution
+    {
+        System::Types::BitMask      Systems;
+        TaskGroup*                  pGroup;
+        Bool                        bFinished;
+    };
+    std::mutex                      m_DistributionMutex;
+    std::vector<PendingDistribution> m_PendingDistributions;
+    std::vector<u32>                m_DeferredNodes;
+
+    Bool IsHeldBack( System::Type Type ) const;
+
+    // Critical path of the last frame.
+    TimePoint                       m_FrameStart;
+    std::vector<u32>                m_CriticalPath;
+    f32                             m_CriticalPathLength;
 };
@@ -22,6 +22,8 @@
 //framework
 #include "Framework/SystemManager.hpp"
 #include "Framework/ServiceManager.hpp"
+#include "Framework/Instrumentation.hpp"
+#include "Framework/FrameArena.hpp"
 
 std::once_flag                   
 ServiceManager::only_one;
@@ -87,6 +89,15 @@ ServiceManager::Collision(
 }
 
 
+Bool
+ServiceManager::HasCollisionProvider(
+    void
+    )
+{
+    return m_pCollision != nullptr;
+}
+
+
 void
 ServiceManager::RegisterCollisionProvider(
     ICollision* pCollision
@@ -115,3 +126,21 @@ ServiceManager::UnregisterCollisionProvider(
         std::cerr << "You are not the registered collision provider." << std::endl;
     }
 }
+
+
+IService::IInstrumentation&
+ServiceManager::Instrumentation(
+    void
+    )
+{
+    return ::Instrumentation::getInstance();
+}
+
+
+IService::IFrameArena&
+ServiceManager::FrameArena(
+    void
+    )
+{
+    return ::FrameArena::getInstance();
+}
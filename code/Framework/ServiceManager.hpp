@@ -78,6 +78,11 @@ public:
     /// </summary>
     virtual IService::ICollision& Collision();
 
+    /// <summary cref="IService::HasCollisionProvider">
+    ///   Implementation of IService::HasCollisionProvider.
+    /// </summary>
+    virtual Bool HasCollisionProvider();
+
     /// <summary cref="IService::RegisterCollisionProvider">
     ///   Implementation of IService::RegisterCollisionProvider.
     /// </summary>
@@ -88,6 +93,16 @@ public:
     /// </summary>
     virtual void UnregisterCollisionProvider( ICollision* pCollision );
 
+    /// <summary cref="IService::Instrumentation">
+    ///   Implementation of IService::Instrumentation.
+    /// </summary>
+    virtual IService::IInstrumentation& Instrumentation();
+
+    /// <summary cref="IService::FrameArena">
+    ///   Implementation of IService::FrameArena.
+    /// </summary>
+    virtual IService::IFrameArena& FrameArena();
+
 
 
 
@@ -18,6 +18,7 @@
 #include "Interfaces/Interface.hpp"
 #include "Framework/PlatformManager.hpp"
 #include "Framework/SystemManager.hpp"
+#include "Framework/NullSystem.hpp"
 #include "Framework/EnvironmentManager.hpp"
 #include "Framework/ServiceManager.hpp"
 #include "Framework/TaskManager.hpp"
@@ -38,6 +39,13 @@ SystemManager::~SystemManager()
     // Iterate through all the loaded libraries.
     for ( auto it : m_SystemLibs)
     {
+        if ( it.hLib == nullptr )
+        {
+            // Stand-ins are owned by the framework.
+            delete static_cast<NullSystem*>( it.pSystem );
+            continue;
+        }
+
         struct SystemFuncs *pSystemFuncs = reinterpret_cast<SystemFuncs*>(Base::GetSymbol(it.hLib, it.strSysLib.c_str() ));
         // System creation/destruction need to happen on the same thread
         pSystemFuncs->DestroySystem(it.pSystem);
@@ -96,6 +104,36 @@ SystemManager::LoadSystemLibrary(
 }
 
 
+Error
+SystemManager::CreateNullSystem(
+    pcstr pszName,
+    ISystem** ppSystem
+    )
+{
+    System::Type SystemType = NullSystem::GetTypeByName( pszName );
+    if ( SystemType == System::Types::Null )
+    {
+        std::cerr << "There is no predefined system " << pszName << " to stand in for." << std::endl;
+        return Errors::Failure;
+    }
+
+    if ( this->Get( SystemType ) != nullptr )
+    {
+        return Errors::Failure;
+    }
+
+    ISystem* pSystem = new NullSystem( pszName, SystemType );
+    this->Add( pSystem );
+
+    SystemLib sl = { nullptr, pSystem, pszName };
+    m_SystemLibs.push_back( sl );
+
+    *ppSystem = pSystem;
+
+    return Errors::Success;
+}
+
+
 
 Error
 SystemManager::Add(
@@ -64,6 +64,9 @@ public:
                                 const std::string strSysLibPath,
                                 ISystem** ppSystem);
 
+    // Creates a NullSystem standing in for a system which is not loaded.
+    Error CreateNullSystem( pcstr pszName, ISystem** ppSystem );
+
     // Adds a new system to the collection.  
     // Called by the ISystem constructor.
     Error Add( ISystem* pSystem );
@@ -18,94 +18,510 @@
 #include "Framework/EnvironmentManager.hpp"
 #include "Framework/ServiceManager.hpp"
 #include "Framework/TaskManager.hpp"
+#include "Framework/Instrumentation.hpp"
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
+#include <sstream>
+#if defined(PLATFORM_OS_LINUX)
+#include <fstream>
+#include <map>
+#include <pthread.h>
+#include <sched.h>
+#endif
 
-std::once_flag                   
+std::once_flag
 TaskManager::only_one;
-std::shared_ptr<TaskManager> 
+std::shared_ptr<TaskManager>
 TaskManager::instance_ = nullptr;
 
-void Worker::operator()()
+__thread_local std::int32_t
+TaskManager::workerIndex = -1;
+__thread_local std::uint32_t
+TaskManager::helperSeed = 0x9E3779B9u;
+__thread_local std::uint64_t
+TaskManager::waitTime = 0;
+
+// ParallelFor call sites whose cost is tracked, calls from further sites are split by the default grain
+static const std::uint32_t GrainSiteCount = 256;
+
+///////////////////////////////////////////////////////////////////////////////
+// CpuTopology - processors, cores and nodes the workers are placed on
+
+#if defined(PLATFORM_OS_LINUX)
+static bool ReadLine( const std::string& file, std::string& line )
 {
-    std::function<void()> task = nullptr;
-    while(true)
-    {       
-        {   // acquire lock
-            std::unique_lock<std::mutex> lock(this->pool.queue_mutex);
-                       
-            auto thisThreadId = std::this_thread::get_id();
-            // check if we already executed the callback on this thread
-            bool callbackExecuted = false;
-            for(const auto &threadid : this->pool.callbackDone)
+    std::ifstream stream( file.c_str() );
+    return std::getline( stream, line ) && !line.empty();
+}
+
+/* Parses a list such as 0-3,8-11.*/
+static std::vector<std::uint32_t> ParseCpuList( const std::string& list )
+{
+    std::vector<std::uint32_t> cpus;
+    std::istringstream stream( list );
+    std::string range;
+    while( std::getline( stream, range, ',' ) )
+    {
+        unsigned first, last;
+        int fields = sscanf( range.c_str(), "%u-%u", &first, &last );
+        if( fields == 1 )
+        {
+            last = first;
+        }
+        else if( fields != 2 )
+        {
+            continue;
+        }
+        for( unsigned cpu = first; cpu <= last; cpu++ )
+        {
+            cpus.push_back( cpu );
+        }
+    }
+    return cpus;
+}
+#endif
+
+CpuTopology::CpuTopology()
+    : cores( 0 )
+    , nodes( 1 )
+    , known( false )
+{
+    this->Read();
+
+    if( this->processors.empty() )
+    {
+        // unknown, every logical processor is a core of its own
+        std::uint32_t count = std::max( std::thread::hardware_concurrency(), 1u );
+        for( std::uint32_t i = 0; i < count; i++ )
+        {
+            Processor processor = { i, i, 0, 0 };
+            this->processors.push_back( processor );
+        }
+        this->cores = count;
+        this->nodes = 1;
+        this->known = false;
+    }
+}
+
+void CpuTopology::Read()
+{
+#if defined(PLATFORM_OS_LINUX)
+    const std::string root = "/sys/devices/system/";
+    std::string line;
+    if( !ReadLine( root + "cpu/online", line ) )
+    {
+        return;
+    }
+    std::vector<std::uint32_t> online = ParseCpuList( line );
+
+    // only the processors the process may run on
+    cpu_set_t allowed;
+    CPU_ZERO( &allowed );
+    bool bAffinity = sched_getaffinity( 0, sizeof( allowed ), &allowed ) == 0;
+
+    // node of every processor, numbered densely
+    std::map<std::uint32_t, std::uint32_t> cpuNodes;
+    std::uint32_t nodeCount = 0;
+    if( ReadLine( root + "node/online", line ) )
+    {
+        for( std::uint32_t node : ParseCpuList( line ) )
+        {
+            std::ostringstream file;
+            file << root << "node/node" << node << "/cpulist";
+            if( ReadLine( file.str(), line ) )
             {
-                if (threadid == thisThreadId)
+                for( std::uint32_t cpu : ParseCpuList( line ) )
                 {
-                    callbackExecuted = true;
+                    cpuNodes[ cpu ] = nodeCount;
                 }
+                nodeCount++;
             }
-            
-            if (callbackExecuted == false && this->pool.callback)
+        }
+    }
+
+    // cores are identified by package and core id, numbered densely
+    std::map< std::pair<int, int>, std::uint32_t > coreIds;
+    std::vector<std::uint32_t> coreThreads;
+    std::vector<bool> usedNodes( std::max( nodeCount, 1u ), false );
+
+    for( std::uint32_t cpu : online )
+    {
+        if( bAffinity && (cpu >= CPU_SETSIZE || !CPU_ISSET( cpu, &allowed )) )
+        {
+            continue;
+        }
+
+        std::ostringstream topology;
+        topology << root << "cpu/cpu" << cpu << "/topology/";
+        int package = 0;
+        int core = -1 - (int)cpu;
+        if( ReadLine( topology.str() + "physical_package_id", line ) )
+        {
+            package = atoi( line.c_str() );
+        }
+        if( ReadLine( topology.str() + "core_id", line ) )
+        {
+            core = atoi( line.c_str() );
+        }
+
+        auto it = coreIds.insert( std::make_pair( std::make_pair( package, core ), (std::uint32_t)coreIds.size() ) ).first;
+        if( it->second == coreThreads.size() )
+        {
+            coreThreads.push_back( 0 );
+        }
+
+        Processor processor;
+        processor.cpu = cpu;
+        processor.core = it->second;
+        processor.node = cpuNodes.count( cpu ) ? cpuNodes[ cpu ] : 0;
+        processor.thread = coreThreads[ processor.core ]++;
+        usedNodes[ processor.node ] = true;
+        this->processors.push_back( processor );
+    }
+
+    // the first thread of every core before the siblings, each group by node
+    std::stable_sort( this->processors.begin(), this->processors.end(),
+        [] ( const Processor& a, const Processor& b )
+        {
+            if( a.thread != b.thread )
             {
-                // excute callback
-                this->pool.callback();
-                // add this thread to called back list
-                this->pool.callbackDone.push_back(thisThreadId);
+                return a.thread < b.thread;
+            }
+            return a.node < b.node;
+        });
+
+    this->cores = (std::uint32_t)coreThreads.size();
+    this->nodes = std::max( (std::uint32_t)std::count( usedNodes.begin(), usedNodes.end(), true ), 1u );
+    this->known = !this->processors.empty();
+#endif
+}
+
+bool CpuTopology::Pin( std::thread& thread, std::uint32_t cpu )
+{
+#if defined(PLATFORM_OS_LINUX)
+    if( cpu >= CPU_SETSIZE )
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    CPU_SET( cpu, &set );
+    return pthread_setaffinity_np( thread.native_handle(), sizeof( set ), &set ) == 0;
+#else
+    UNREFERENCED_PARAM( thread );
+    UNREFERENCED_PARAM( cpu );
+    return false;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// WorkStealingDeque - Chase-Lev deque, one per worker
+
+WorkStealingDeque::WorkStealingDeque( std::uint32_t capacity )
+    : top( 0 )
+    , bottom( 0 )
+    , mask( capacity - 1 )
+    , buffer( new std::atomic<Task*>[ capacity ] )
+{
+    ASSERT( (capacity & (capacity - 1)) == 0 );
+}
+
+bool WorkStealingDeque::Push( Task* pTask )
+{
+    std::int64_t b = this->bottom.load( std::memory_order_relaxed );
+    std::int64_t t = this->top.load( std::memory_order_acquire );
+    if( b - t > this->mask )
+    {
+        return false;
+    }
+    this->buffer[ b & this->mask ].store( pTask, std::memory_order_relaxed );
+    this->bottom.store( b + 1, std::memory_order_release );
+    return true;
+}
+
+Task* WorkStealingDeque::Pop()
+{
+    std::int64_t b = this->bottom.load( std::memory_order_relaxed ) - 1;
+    this->bottom.store( b, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    std::int64_t t = this->top.load( std::memory_order_relaxed );
+
+    if( t > b )
+    {
+        // empty
+        this->bottom.store( b + 1, std::memory_order_relaxed );
+        return nullptr;
+    }
+
+    Task* pTask = this->buffer[ b & this->mask ].load( std::memory_order_relaxed );
+    if( t == b )
+    {
+        // last element, race against the thieves
+        if( !this->top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+        {
+            pTask = nullptr;
+        }
+        this->bottom.store( b + 1, std::memory_order_relaxed );
+    }
+    return pTask;
+}
+
+Task* WorkStealingDeque::Steal()
+{
+    std::int64_t t = this->top.load( std::memory_order_acquire );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    std::int64_t b = this->bottom.load( std::memory_order_acquire );
+
+    if( t >= b )
+    {
+        return nullptr;
+    }
+
+    Task* pTask = this->buffer[ t & this->mask ].load( std::memory_order_relaxed );
+    if( !this->top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+    {
+        // lost the race
+        return nullptr;
+    }
+    return pTask;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// InjectionQueue - bounded MPMC queue for tasks from foreign threads
+
+InjectionQueue::InjectionQueue( std::uint32_t capacity )
+    : mask( capacity - 1 )
+    , cells( new Cell[ capacity ] )
+    , enqueuePos( 0 )
+    , dequeuePos( 0 )
+{
+    ASSERT( (capacity & (capacity - 1)) == 0 );
+    for( std::size_t i = 0; i < capacity; i++ )
+    {
+        this->cells[ i ].sequence.store( i, std::memory_order_relaxed );
+        this->cells[ i ].pTask = nullptr;
+    }
+}
+
+bool InjectionQueue::Push( Task* pTask )
+{
+    Cell* pCell;
+    std::size_t pos = this->enqueuePos.load( std::memory_order_relaxed );
+    for(;;)
+    {
+        pCell = &this->cells[ pos & this->mask ];
+        std::size_t seq = pCell->sequence.load( std::memory_order_acquire );
+        std::intptr_t diff = (std::intptr_t)seq - (std::intptr_t)pos;
+        if( diff == 0 )
+        {
+            if( this->enqueuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+            {
+                break;
             }
-            
-            // look for a work item
-            while(!this->pool.stop && this->pool.tasks.empty() && (this->pool.workers.size() == this->pool.callbackDone.size())  )
-            { 
-                // if there are none wait for notification
-                std::this_thread::yield();
-                this->pool.condition.wait_for(lock, std::chrono::duration<int, std::milli>(5));
+        }
+        else if( diff < 0 )
+        {
+            // full
+            return false;
+        }
+        else
+        {
+            pos = this->enqueuePos.load( std::memory_order_relaxed );
+        }
+    }
+    pCell->pTask = pTask;
+    pCell->sequence.store( pos + 1, std::memory_order_release );
+    return true;
+}
+
+Task* InjectionQueue::Pop()
+{
+    Cell* pCell;
+    std::size_t pos = this->dequeuePos.load( std::memory_order_relaxed );
+    for(;;)
+    {
+        pCell = &this->cells[ pos & this->mask ];
+        std::size_t seq = pCell->sequence.load( std::memory_order_acquire );
+        std::intptr_t diff = (std::intptr_t)seq - (std::intptr_t)(pos + 1);
+        if( diff == 0 )
+        {
+            if( this->dequeuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+            {
+                break;
             }
-            
-            // exit if the pool is stopped
-            if(this->pool.stop) 
-                return;
+        }
+        else if( diff < 0 )
+        {
+            // empty
+            return nullptr;
+        }
+        else
+        {
+            pos = this->dequeuePos.load( std::memory_order_relaxed );
+        }
+    }
+    Task* pTask = pCell->pTask;
+    pCell->sequence.store( pos + this->mask + 1, std::memory_order_release );
+    return pTask;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Worker - runs tasks, steals when idle and parks when there is nothing to steal
+
+void Worker::operator()()
+{
+    TaskManager::workerIndex = this->index;
 
-            // get the task from the queue
-            if (!this->pool.tasks.empty())
+    // seed for the victim selection
+    std::uint32_t seed = this->index * 2654435761u + 1;
+    std::uint32_t callbackGeneration = 0;
+
+    while(true)
+    {
+        // execute the per thread callback once per generation
+        std::uint32_t generation = this->pool.callbackGeneration.load( std::memory_order_acquire );
+        if( generation != callbackGeneration )
+        {
+            callbackGeneration = generation;
             {
-                task = std::move(this->pool.tasks.front());
-                this->pool.tasks.pop_front();
+                std::unique_lock<std::mutex> lock(this->pool.callback_mutex);
+                this->pool.callback();
             }
-        }   // release lock
- 
-        // execute the task
-        if (task != nullptr)
+            this->pool.callbackDone.fetch_add( 1, std::memory_order_release );
+        }
+
+        Task* pTask = this->pool.FindTask( this->index, seed );
+        if( pTask != nullptr )
         {
-            task();
+            this->pool.Execute( pTask );
+            continue;
         }
+
+        // nothing found, announce that we are going to sleep and look again
+        std::uint32_t key = this->pool.epoch.load( std::memory_order_seq_cst );
+        this->pool.sleepers.fetch_add( 1, std::memory_order_seq_cst );
+
+        pTask = this->pool.FindTask( this->index, seed );
+        if( pTask != nullptr )
+        {
+            this->pool.sleepers.fetch_sub( 1, std::memory_order_relaxed );
+            this->pool.Execute( pTask );
+            continue;
+        }
+
+        {   // acquire lock
+            std::unique_lock<std::mutex> lock(this->pool.park_mutex);
+            while( !this->pool.stop.load( std::memory_order_relaxed ) &&
+                   this->pool.epoch.load( std::memory_order_relaxed ) == key &&
+                   this->pool.callbackGeneration.load( std::memory_order_relaxed ) == callbackGeneration )
+            {
+                this->pool.condition.wait(lock);
+            }
+        }   // release lock
+        this->pool.sleepers.fetch_sub( 1, std::memory_order_relaxed );
+
+        // exit if the pool is stopped
+        if( this->pool.stop.load( std::memory_order_acquire ) )
+            return;
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// TaskManager
+
 TaskManager::TaskManager()
+    : outstanding( 0 )
+    , epoch( 0 )
+    , sleepers( 0 )
+    , stop( false )
+    , callbackGeneration( 0 )
+    , callbackDone( 0 )
 {
-    auto numThreads = EnvironmentManager::getInstance().Variables().GetAsInt( "TaskManager::Threads", 0 );
-    if( numThreads <= 0 ) 
+    IEnvironment::IVariables& Variables = EnvironmentManager::getInstance().Variables();
+    const std::vector<CpuTopology::Processor>& processors = this->topology.GetProcessors();
+
+    // by default a worker per logical processor, or per core without the hyperthreads
+    auto numThreads = Variables.GetAsInt( "TaskManager::Threads", 0 );
+    if( numThreads <= 0 )
     {
-        this->numThreads = std::thread::hardware_concurrency();
-    } 
+        this->numThreads = Variables.GetAsBool( "TaskManager::HyperThreads", True ) ?
+            (std::uint32_t)processors.size() : this->topology.GetNumberOfCores();
+    }
     else
     {
         this->numThreads = numThreads;
     }
-    
+    bool bPin = Variables.GetAsBool( "TaskManager::Affinity", True ) && this->topology.IsKnown();
+
+    // ParallelFor keeps the cost of a task, given in microseconds and kept in nanoseconds, below
+    // this fraction of a piece
+    this->taskCost = std::max( Variables.GetAsFloat( "TaskManager::TaskCost", 1.0f ), 0.0f ) * 1000.0f;
+    this->taskOverhead = std::max( Variables.GetAsFloat( "TaskManager::TaskOverhead", 0.05f ), 0.001f );
+    this->grainSites.reset( new GrainSite[ GrainSiteCount ] );
+    for( u32 i = 0; i < GrainSiteCount; i++ )
+    {
+        this->grainSites[ i ].state.store( 0, std::memory_order_relaxed );
+        this->grainSites[ i ].itemCost.store( 0.0f, std::memory_order_relaxed );
+    }
+
+    // the processors come first thread of every core first, so the workers take all the
+    // cores before they double up on hyperthreads
+    std::vector<std::uint32_t> cores;
+    std::vector<std::uint32_t> nodes;
+    for(size_t i = 0;i<this->numThreads;++i)
+    {
+        const CpuTopology::Processor& processor = processors[ i % processors.size() ];
+        cores.push_back( processor.core );
+        nodes.push_back( processor.node );
+    }
+    std::sort( cores.begin(), cores.end() );
+    this->numCores = (std::uint32_t)( std::unique( cores.begin(), cores.end() ) - cores.begin() );
+
+    // steal from the workers on the same node first
+    this->victims.resize( this->numThreads );
+    this->localVictims.resize( this->numThreads );
+    for(std::uint32_t i = 0;i<this->numThreads;++i)
+    {
+        for(std::uint32_t j = 0;j<this->numThreads;++j)
+        {
+            if( j != i && nodes[ j ] == nodes[ i ] )
+                this->victims[ i ].push_back( j );
+        }
+        this->localVictims[ i ] = (std::uint32_t)this->victims[ i ].size();
+        for(std::uint32_t j = 0;j<this->numThreads;++j)
+        {
+            if( nodes[ j ] != nodes[ i ] )
+                this->victims[ i ].push_back( j );
+        }
+    }
+
+    // create the queues before any worker can try to steal
+    this->queues.clear();
+    for(size_t i = 0;i<this->numThreads;++i)
+        this->queues.push_back(std::unique_ptr<WorkStealingDeque>(new WorkStealingDeque( 4096 )));
+
     // start worker threads
-    this->stop = false;
-    this->workers.clear();    
+    this->workers.clear();
     for(size_t i = 0;i<this->numThreads;++i)
-        this->workers.push_back(std::move(std::thread(Worker(*this))));
+    {
+        this->workers.push_back(std::move(std::thread(Worker(*this, static_cast<std::uint32_t>(i)))));
+        if( bPin )
+            CpuTopology::Pin( this->workers.back(), processors[ i % processors.size() ].cpu );
+    }
 }
 
 TaskManager::~TaskManager()
 {
+    WaitForAllTasks();
+
     // stop all threads
-    this->stop = true;
+    {
+        std::unique_lock<std::mutex> lock(this->park_mutex);
+        this->stop.store( true, std::memory_order_release );
+    }
     this->condition.notify_all();
-    WaitForAllTasks();
- 
+
     // join them
     for(auto & worker : this->workers)
     {
@@ -113,6 +529,171 @@ TaskManager::~TaskManager()
     }
 }
 
+void TaskManager::Submit( Task* pTask )
+{
+    this->outstanding.fetch_add( 1, std::memory_order_relaxed );
+
+    bool queued;
+    if( workerIndex >= 0 )
+    {
+        queued = this->queues[ workerIndex ]->Push( pTask );
+    }
+    else
+    {
+        queued = this->injection.Push( pTask );
+    }
+
+    if( !queued )
+    {
+        // queue is full, do it ourselves
+        this->Execute( pTask );
+        return;
+    }
+
+    this->Signal( false );
+}
+
+Task* TaskManager::NewTaskAfter( TaskGroup* pGroup, TaskGroup* pPrevious, Task f )
+{
+    return new Task( [this, pGroup, pPrevious, f] ()
+    {
+        if( !pPrevious->IsDone() )
+        {
+            // behind the work of the own deque, which may be what the previous group waits for
+            Task* pTask = this->NewTaskAfter( pGroup, pPrevious, f );
+            this->outstanding.fetch_add( 1, std::memory_order_relaxed );
+            if( this->injection.Push( pTask ) )
+            {
+                this->Signal( false );
+            }
+            else
+            {
+                this->outstanding.fetch_sub( 1, std::memory_order_relaxed );
+                this->Submit( pTask );
+            }
+            return;
+        }
+
+        f();
+        pGroup->pending.fetch_sub( 1, std::memory_order_release );
+    });
+}
+
+Task* TaskManager::FindTask( std::int32_t index, std::uint32_t& seed )
+{
+    Task* pTask;
+    if( index >= 0 )
+    {
+        pTask = this->queues[ index ]->Pop();
+        if( pTask != nullptr )
+        {
+            return pTask;
+        }
+    }
+
+    pTask = this->injection.Pop();
+    if( pTask != nullptr )
+    {
+        return pTask;
+    }
+
+    // xorshift to pick the first victim, then try all of them
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    if( index >= 0 )
+    {
+        // the workers on the own node first, then the remote ones
+        const std::vector<std::uint32_t>& others = this->victims[ index ];
+        std::uint32_t local = this->localVictims[ index ];
+        std::uint32_t remote = (std::uint32_t)others.size() - local;
+        for( std::uint32_t i = 0; i < local; i++ )
+        {
+            pTask = this->queues[ others[ ( seed + i ) % local ] ]->Steal();
+            if( pTask != nullptr )
+            {
+                return pTask;
+            }
+        }
+        for( std::uint32_t i = 0; i < remote; i++ )
+        {
+            pTask = this->queues[ others[ local + ( seed + i ) % remote ] ]->Steal();
+            if( pTask != nullptr )
+            {
+                return pTask;
+            }
+        }
+        return nullptr;
+    }
+
+    std::uint32_t victim = seed % this->numThreads;
+    for( std::uint32_t i = 0; i < this->numThreads; i++ )
+    {
+        if( (std::int32_t)victim != index )
+        {
+            pTask = this->queues[ victim ]->Steal();
+            if( pTask != nullptr )
+            {
+                return pTask;
+            }
+        }
+        victim = ( victim + 1 ) % this->numThreads;
+    }
+    return nullptr;
+}
+
+std::uint32_t TaskManager::GetRecommendedJobCount( ITaskManager::JobCountInstructionHints Hints )
+{
+    // hyperthreads share the vector units of their core, so SIMD work gets one job per core
+    switch( Hints )
+    {
+    case ITaskManager::SIMD_FP:
+    case ITaskManager::SIMD_INT:
+        return std::max( this->numCores, 1u );
+
+    default:
+        return this->numThreads;
+    }
+}
+
+bool TaskManager::HelpOnce()
+{
+    Task* pTask = this->FindTask( workerIndex, helperSeed );
+    if( pTask == nullptr )
+    {
+        return false;
+    }
+    this->Execute( pTask );
+    return true;
+}
+
+void TaskManager::Execute( Task* pTask )
+{
+    (*pTask)();
+    delete pTask;
+    this->outstanding.fetch_sub( 1, std::memory_order_release );
+}
+
+void TaskManager::Signal( bool all )
+{
+    this->epoch.fetch_add( 1, std::memory_order_seq_cst );
+    if( this->sleepers.load( std::memory_order_seq_cst ) > 0 )
+    {
+        {
+            std::unique_lock<std::mutex> lock(this->park_mutex);
+        }
+        if( all )
+        {
+            this->condition.notify_all();
+        }
+        else
+        {
+            this->condition.notify_one();
+        }
+    }
+}
+
 void TaskManager::EnqueueTasks( std::vector<ISystemTask*> systemTasks, float deltaTime)
 {
     std::vector<ISystemTask*> notThreadSafeTasks;
@@ -125,113 +706,203 @@ void TaskManager::EnqueueTasks( std::vector<ISystemTask*> systemTasks, float del
         else
         {
             notThreadSafeTasks.push_back(task);
-        }        
-    }    
+        }
+    }
     for (const auto &task : notThreadSafeTasks)
     {
-        task->Update(deltaTime);  
+        task->Update(deltaTime);
     }
 }
 
 void TaskManager::WaitForAllTasks()
 {
-    auto empty = false;
-    while(!empty)
+    while( this->outstanding.load( std::memory_order_acquire ) != 0 )
     {
-        std::unique_lock<std::mutex> lock(this->queue_mutex);
-        empty = this->tasks.empty();
+        if( !this->HelpOnce() )
+        {
+            std::this_thread::yield();
+        }
     }
 }
 
+void TaskManager::WaitForTaskGroup( TaskGroup& group )
+{
+    if( group.IsDone() )
+    {
+        return;
+    }
+
+    // the waits of the tasks helped with are part of this one, so it replaces what they added
+    std::uint64_t outerTime = waitTime;
+    auto start = std::chrono::steady_clock::now();
+    while( !group.IsDone() )
+    {
+        if( !this->HelpOnce() )
+        {
+            std::this_thread::yield();
+        }
+    }
+    auto time = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start );
+    waitTime = outerTime + (std::uint64_t)time.count();
+}
+
 void TaskManager::PerThreadCallback( JobFunction pfnCallback, void* pData)
 {
     WaitForAllTasks();
-    
+
     { // acquire lock
-        std::unique_lock<std::mutex> lock(this->queue_mutex);
-        
-        // clear called back list
-        this->callbackDone.clear();
-        
+        std::unique_lock<std::mutex> lock(this->callback_mutex);
+
         // add the callback
         this->callback = std::bind(pfnCallback, pData);
+        this->callbackDone.store( 0, std::memory_order_relaxed );
     } // release lock
-     
-    // wait for workers to execute callback
-    auto done = false;
-    while(!done)
-    {
-        { // acquire lock
-            std::unique_lock<std::mutex> lock(this->queue_mutex);
-            if (this->workers.size() != this->callbackDone.size()) 
-            {
-                done = false;
-            }
-            else
-            {
-                done = true;
-            }
-        }
-        this->condition.notify_all();
+    this->callbackGeneration.fetch_add( 1, std::memory_order_release );
+
+    // wake up every worker and wait for them to execute the callback
+    this->Signal( true );
+    while( this->callbackDone.load( std::memory_order_acquire ) != this->numThreads )
+    {
+        std::this_thread::yield();
     }
+
     // call it for ourself, too
     pfnCallback( pData );
 }
 
 void TaskManager::ParallelFor(
     ISystemTask* pSystemTask,
-    ParallelForFunction pfnJobFunction, 
-    void* pParam, 
-    u32 begin, 
-    u32 end, 
+    ParallelForFunction pfnJobFunction,
+    void* pParam,
+    u32 begin,
+    u32 end,
+    u32 minGrainSize
+    )
+{
+    this->ParallelForSite( pSystemTask, pfnJobFunction, pParam, begin, end, minGrainSize );
+}
+
+void TaskManager::ParallelForSite(
+    const void* pSite,
+    ParallelForFunction pfnJobFunction,
+    void* pParam,
+    u32 begin,
+    u32 end,
     u32 minGrainSize
     )
 {
-    u32 uThreads = ( this->numThreads + 1 );
+    if( end <= begin )
+    {
+        return;
+    }
     u32 uCount = ( end - begin );
 
-    if ( uThreads <= 0 )
+    GrainSite* pGrainSite = this->FindGrainSite( pSite, pfnJobFunction );
+    float itemCost = ( pGrainSite != nullptr ) ? pGrainSite->itemCost.load( std::memory_order_relaxed ) : 0.0f;
+
+    u32 uGrainSize;
+    if( itemCost > 0.0f )
     {
-        std::cerr << "uThreads <= 0" << std::endl;
+        // pieces long enough for a task to cost at most the overhead fraction of their work
+        float grain = this->taskCost / ( this->taskOverhead * itemCost );
+        uGrainSize = ( grain < (float)uCount ) ? (u32)grain + 1 : uCount;
     }
-    if ( uCount <= 0 )
+    else
     {
-        std::cerr << "uCount <= 0" << std::endl;
+        // not measured yet, a piece per thread
+        uGrainSize = uCount / ( this->numThreads + 1 );
     }
+    uGrainSize = std::max( std::max( uGrainSize, minGrainSize ), 1u );
+
+    ParallelForJob job;
+    job.pfnJobFunction = pfnJobFunction;
+    job.pParam = pParam;
+    job.grainSize = uGrainSize;
+    job.time.store( 0, std::memory_order_relaxed );
 
-    u32 uGrainSize = ( uCount / uThreads );
+    // split and help with the other pieces until all of them are done
+    this->RunRange( job, begin, end );
+    this->WaitForTaskGroup( job.group );
 
-    if( uGrainSize < minGrainSize )
+    if( pGrainSite != nullptr )
     {
-        uGrainSize = minGrainSize;
-        if ( uGrainSize <= 0 )
+        // the cost changes as the scene does, follow it with a moving average
+        float sample = (float)job.time.load( std::memory_order_relaxed ) / (float)uCount;
+        if( itemCost > 0.0f )
         {
-            std::cerr << "uGrainSize <= 0" << std::endl;
+            sample = itemCost + 0.25f * ( sample - itemCost );
         }
+        pGrainSite->itemCost.store( std::max( sample, 0.001f ), std::memory_order_relaxed );
+    }
+}
 
-        uThreads = ( uCount / uGrainSize );
+void TaskManager::RunRange( ParallelForJob& job, u32 begin, u32 end )
+{
+    // the thieves take the biggest halves and split them further, so ranges where some
+    // items cost much more than others even out
+    while( end - begin > job.grainSize )
+    {
+        u32 middle = begin + ( end - begin ) / 2;
+        ParallelForJob* pJob = &job;
+        this->AddTask( job.group, [this, pJob, middle, end] ()
+        {
+            this->RunRange( *pJob, middle, end );
+        });
+        end = middle;
     }
 
-    if( uThreads > 1 )
+    Instrumentation::Scope scope( "ParallelFor", "Task" );
+    std::uint64_t startWait = waitTime;
+    auto start = std::chrono::steady_clock::now();
+    job.pfnJobFunction( job.pParam, begin, end );
+    auto time = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start );
+
+    // a job function running a nested ParallelFor helps with other tasks while it waits for
+    // its pieces, that time belongs to those tasks and not to the items of this range
+    std::uint64_t nestedWait = waitTime - startWait;
+    std::uint64_t jobTime = (std::uint64_t)time.count();
+    job.time.fetch_add( ( jobTime > nestedWait ) ? jobTime - nestedWait : 0, std::memory_order_relaxed );
+}
+
+TaskManager::GrainSite* TaskManager::FindGrainSite( const void* pSite, ParallelForFunction pfnJobFunction )
+{
+    // without a caller the function alone would mix up the loops of unrelated callers
+    if( pSite == nullptr )
+    {
+        return nullptr;
+    }
+
+    uptr hash = ( reinterpret_cast<uptr>( pfnJobFunction ) >> 4 ) ^ ( reinterpret_cast<uptr>( pSite ) * 2654435761u );
+
+    for( u32 i = 0; i < GrainSiteCount; i++ )
     {
-        u32 uStart = 0;
-        u32 uEnd = 0;
+        GrainSite& site = this->grainSites[ ( hash + i ) % GrainSiteCount ];
+        u32 state = site.state.load( std::memory_order_acquire );
 
-        // dispatch other jobs
-        for( u32 t = 1; t < uThreads; t++ )
+        if( state == 0 )
         {
-            uEnd = ( uStart + uGrainSize );
-            this->AddTask([pfnJobFunction, pParam, uStart, uEnd] () { pfnJobFunction( pParam, uStart, uEnd); });
-            uStart = uEnd;
+            if( site.state.compare_exchange_strong( state, 1, std::memory_order_acquire ) )
+            {
+                site.pSite = pSite;
+                site.pfnJobFunction = pfnJobFunction;
+                site.itemCost.store( 0.0f, std::memory_order_relaxed );
+                site.state.store( 2, std::memory_order_release );
+                return &site;
+            }
         }
 
-        // now do our job
-        uEnd = uCount;
-        pfnJobFunction( pParam, uStart, uEnd );
-    }
-    else
-    {
-        // just do it ourselves
-        pfnJobFunction( pParam, begin, end );
+        // another thread is claiming the slot, it may be for the same site
+        while( state != 2 )
+        {
+            std::this_thread::yield();
+            state = site.state.load( std::memory_order_acquire );
+        }
+
+        if( site.pSite == pSite && site.pfnJobFunction == pfnJobFunction )
+        {
+            return &site;
+        }
     }
+
+    return nullptr;
 }
@@ -14,24 +14,134 @@
 
 #pragma once
 
+#include <atomic>
 #include <thread>
-#include <deque>
 #include <vector>
+#include <memory>
 #include <utility>
 #include <chrono>
 #include <functional>
 #include <type_traits>
 #include <future>
+#include <mutex>
+#include <condition_variable>
 
 /* Thanks to https://github.com/greyfade/workqueue.*/
 class TaskManager;
-class Worker 
+class Worker
 {
 public:
-    Worker(TaskManager &s) : pool(s) { }
+    Worker(TaskManager &s, std::uint32_t index) : pool(s), index(index) { }
     void operator()();
 private:
-    TaskManager &pool;    
+    TaskManager &pool;
+    std::uint32_t index;
+};
+
+/* A unit of work as stored in the queues.*/
+typedef std::function<void()> Task;
+
+/* Chase-Lev work-stealing deque with a fixed power of two capacity.
+ * Push and Pop may only be called by the owning worker, Steal by any thread.
+ * See Le, Pop, Cohen, Zappa Nardelli: "Correct and Efficient Work-Stealing for Weak Memory Models".*/
+class WorkStealingDeque
+{
+public:
+    explicit WorkStealingDeque( std::uint32_t capacity );
+
+    /* Returns false if the deque is full.*/
+    bool Push( Task* pTask );
+    Task* Pop();
+    Task* Steal();
+
+private:
+    // top and bottom on separate cache lines
+    std::atomic<std::int64_t> top;
+    char pad[ 64 ];
+    std::atomic<std::int64_t> bottom;
+    std::int64_t mask;
+    std::unique_ptr<std::atomic<Task*>[]> buffer;
+};
+
+/* Bounded lock-free multi producer multi consumer queue used to inject work
+ * from threads which do not own a deque (the primary thread).*/
+class InjectionQueue
+{
+public:
+    explicit InjectionQueue( std::uint32_t capacity = 4096 );
+
+    /* Returns false if the queue is full.*/
+    bool Push( Task* pTask );
+    Task* Pop();
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        Task* pTask;
+    };
+
+    std::size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    // producer and consumer positions on separate cache lines
+    std::atomic<std::size_t> enqueuePos;
+    char pad[ 64 ];
+    std::atomic<std::size_t> dequeuePos;
+};
+
+/* Tracks completion of a set of tasks so the issuing thread can join on them.*/
+class TaskGroup
+{
+public:
+    TaskGroup() : pending(0) { }
+
+    bool IsDone() const { return this->pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class TaskManager;
+
+    TaskGroup(const TaskGroup&);
+    TaskGroup& operator = (const TaskGroup&);
+
+    // tasks of the group which did not finish yet
+    std::atomic<std::uint32_t> pending;
+};
+
+/* Logical processors of the machine grouped into physical cores and NUMA nodes.
+ * On Linux it is read from /sys/devices/system/cpu and limited to the processors the process
+ * may run on, elsewhere every logical processor is a core of its own on node 0.*/
+class CpuTopology
+{
+public:
+    struct Processor
+    {
+        std::uint32_t cpu;
+        std::uint32_t core;
+        std::uint32_t node;
+        // 0 for the first hardware thread of its core, 1 for its sibling and so on
+        std::uint32_t thread;
+    };
+
+    CpuTopology();
+
+    /* The processors with the first hardware thread of every core first, each group ordered by node.*/
+    const std::vector<Processor>& GetProcessors() const { return this->processors; }
+    std::uint32_t GetNumberOfCores() const { return this->cores; }
+    std::uint32_t GetNumberOfNodes() const { return this->nodes; }
+
+    /* True if the topology was read from the operating system and threads can be pinned.*/
+    bool IsKnown() const { return this->known; }
+
+    /* Pins a thread to a logical processor, returns false if that is not supported.*/
+    static bool Pin( std::thread& thread, std::uint32_t cpu );
+
+private:
+    void Read();
+
+    std::vector<Processor> processors;
+    std::uint32_t cores;
+    std::uint32_t nodes;
+    bool known;
 };
 
 class TaskManager: public ITaskManager
@@ -40,97 +150,203 @@ private:
     // singleton
     static std::shared_ptr<TaskManager> instance_;
     static std::once_flag                   only_one;
-     
+
     TaskManager(const TaskManager& rs) {
         instance_  = rs.instance_;
     }
- 
-    TaskManager& operator = (const TaskManager& rs) 
+
+    TaskManager& operator = (const TaskManager& rs)
     {
-        if (this != &rs) 
+        if (this != &rs)
         {
             instance_  = rs.instance_;
         }
- 
+
         return *this;
     }
 
     TaskManager();
 
 public:
-    static TaskManager& getInstance() 
+    static TaskManager& getInstance()
     {
-        std::call_once( TaskManager::only_one, [] () 
-        { 
-            TaskManager::instance_.reset( new TaskManager()); 
+        std::call_once( TaskManager::only_one, [] ()
+        {
+            TaskManager::instance_.reset( new TaskManager());
         });
- 
+
         return *TaskManager::instance_;
     }
-    
+
     ~TaskManager();
 
     /* Call this from the primary thread to schedule system work.*/
     void EnqueueTasks( std::vector<ISystemTask*> systemTasks, float deltaTime );
-    
+
     /* Adds a task and returns a std::future*/
     template<class F>
-    auto AddTask(std::packaged_task<F()>& task) -> std::future<F> 
+    auto AddTask(std::packaged_task<F()>& task) -> std::future<F>
     {
-        std::unique_lock<std::mutex> lock(this->queue_mutex);
-
         auto ret = task.get_future();
-        this->tasks.push_back([&task]{task();});
-
-        this->condition.notify_one();
-
+        this->Submit(new Task([&task]{task();}));
         return ret;
     }
-    
-    /* Adds a task.*/    
+
+    /* Adds a task.*/
     template<class F>
     void AddTask(F f)
     {
-        std::unique_lock<std::mutex> lock(this->queue_mutex);
-        
-        this->tasks.push_back(std::function<void()>(f));
-        
-        this->condition.notify_one();
-    } 
+        this->Submit(new Task(f));
+    }
+
+    /* Adds a task to a group. Use WaitForTaskGroup to join on it.*/
+    template<class F>
+    void AddTask(TaskGroup& group, F f)
+    {
+        group.pending.fetch_add(1, std::memory_order_relaxed);
+        TaskGroup* pGroup = &group;
+        this->Submit(new Task([pGroup, f] () { f(); pGroup->pending.fetch_sub(1, std::memory_order_release); }));
+    }
+
+    /* Adds a task to a group which starts once the tasks of another group are complete.
+     * Until then it is put back on the injection queue instead of waiting, so a thread which
+     * picks it up while helping out within the other group does not wait for itself.*/
+    template<class F>
+    void AddTaskAfter(TaskGroup& group, TaskGroup& previous, F f)
+    {
+        group.pending.fetch_add(1, std::memory_order_relaxed);
+        this->Submit(this->NewTaskAfter(&group, &previous, Task(f)));
+    }
+
+    /* Waits until all tasks of the group are complete. The calling thread executes
+     * pending tasks while it waits, so this may be called from within a task.*/
+    void WaitForTaskGroup( TaskGroup& group );
+
+    /* Executes one pending task if there is one, returns false otherwise.
+     * Lets a thread which waits for something else contribute to the work.*/
+    bool HelpOnce();
 
     /* Call this from the primary thread to wait until all tasks and all of their subtasks are complete.*/
     void WaitForAllTasks();
 
     /* Call this method to get the number of threads in the thread pool which are active for running work.*/
     std::uint32_t GetNumberOfThreads() {return this->numThreads;}
-                            
+
     /* This method triggers a synchronized callback to be called once by each thread used by the TaskManager. */
     virtual void PerThreadCallback( JobFunction pfnCallback, void* pData );
 
-    /* Call this method to determine the ideal number of tasks to submit to the TaskManager 
+    /* Call this method to determine the ideal number of tasks to submit to the TaskManager
      * for maximum performance.*/
-    virtual std::uint32_t GetRecommendedJobCount( ITaskManager::JobCountInstructionHints Hints ) {return this->numThreads;}
-    
+    virtual std::uint32_t GetRecommendedJobCount( ITaskManager::JobCountInstructionHints Hints );
+
+    /* The topology the workers were placed by.*/
+    const CpuTopology& GetTopology() const { return this->topology; }
+
+    /* Splits the range in halves until the pieces are big enough to be worth a task. The cost of an
+     * item is measured for every call site, identified by the system task and the job function, so
+     * minGrainSize only needs to be given where the job function requires it. Loops without a
+     * system task are not measured and split into a piece per thread.*/
     virtual void ParallelFor( ISystemTask* pSystemTask, ParallelForFunction pfnJobFunction, void* pParam, std::uint32_t begin, std::uint32_t end, std::uint32_t minGrainSize = 1 );
 
+    /* ParallelFor for framework code without a system task, pSite is any pointer identifying the
+     * caller together with the job function, e.g. the object running the loop.*/
+    void ParallelForSite( const void* pSite, ParallelForFunction pfnJobFunction, void* pParam, std::uint32_t begin, std::uint32_t end, std::uint32_t minGrainSize = 1 );
+
 private:
     friend class Worker;
 
+    /* Measured cost of the items of a ParallelFor call site.*/
+    struct GrainSite
+    {
+        // 0 while free, 1 while being claimed, 2 once the key is set
+        std::atomic<std::uint32_t> state;
+        const void* pSite;
+        ParallelForFunction pfnJobFunction;
+        // nanoseconds per item, 0 until the first call finished
+        std::atomic<float> itemCost;
+    };
+
+    /* A ParallelFor in flight.*/
+    struct ParallelForJob
+    {
+        ParallelForFunction pfnJobFunction;
+        void* pParam;
+        std::uint32_t grainSize;
+        TaskGroup group;
+        // nanoseconds spent in the job function, less the waits on nested groups
+        std::atomic<std::uint64_t> time;
+    };
+
+    /* Finds the site of a ParallelFor call, adding it on the first call. Returns nullptr if the
+     * table is full.*/
+    GrainSite* FindGrainSite( const void* pSite, ParallelForFunction pfnJobFunction );
+
+    /* Hands the upper halves of the range to the other workers and runs the rest.*/
+    void RunRange( ParallelForJob& job, std::uint32_t begin, std::uint32_t end );
+
+    /* Queues a task on the deque of the calling worker or on the injection queue.
+     * If the queue is full the task is executed immediately.*/
+    void Submit( Task* pTask );
+
+    /* Wraps a task of AddTaskAfter which requeues itself while the previous group runs.*/
+    Task* NewTaskAfter( TaskGroup* pGroup, TaskGroup* pPrevious, Task f );
+
+    /* Looks for work in the own deque, the injection queue and then steals from a random victim.
+     * Foreign threads pass an index of -1.*/
+    Task* FindTask( std::int32_t index, std::uint32_t& seed );
+
+    /* Runs and frees a task.*/
+    void Execute( Task* pTask );
+
+    /* Wakes a parked worker if there is one.*/
+    void Signal( bool all );
+
+    // index of the worker owning the current thread or -1 for foreign threads
+    static __thread_local std::int32_t workerIndex;
+
+    // victim selection seed of threads helping while they wait
+    static __thread_local std::uint32_t helperSeed;
+
+    // nanoseconds the current thread spent waiting on task groups, helping included
+    static __thread_local std::uint64_t waitTime;
+
     // number of active threads
     std::uint32_t numThreads;
 
+    // where the workers run, SIMD work gets one job per physical core the workers cover
+    CpuTopology topology;
+    std::uint32_t numCores;
+
+    // the other workers of each worker, those on its own node first
+    std::vector< std::vector<std::uint32_t> > victims;
+    std::vector<std::uint32_t> localVictims;
+
+    // ParallelFor call sites, the cost of a task in nanoseconds and the fraction of
+    // the work it may take
+    std::unique_ptr<GrainSite[]> grainSites;
+    float taskCost;
+    float taskOverhead;
+
     // need to keep track of threads so we can join them
     std::vector< std::thread > workers;
- 
-    // the task queue
-    std::deque<std::function<void()>> tasks;
- 
-    // synchronization
-    std::mutex queue_mutex;
+
+    // the task queues
+    std::vector< std::unique_ptr<WorkStealingDeque> > queues;
+    InjectionQueue injection;
+
+    // tasks which were submitted but did not finish yet
+    std::atomic<std::uint32_t> outstanding;
+
+    // parking
+    std::mutex park_mutex;
     std::condition_variable condition;
-    bool stop;
-    
+    std::atomic<std::uint32_t> epoch;
+    std::atomic<std::uint32_t> sleepers;
+    std::atomic<bool> stop;
+
     // per thread callback
+    std::mutex callback_mutex;
     std::function<void()> callback;
-    std::vector<std::thread::id> callbackDone;    
+    std::atomic<std::uint32_t> callbackGeneration;
+    std::atomic<std::uint32_t> callbackDone;
 };
@@ -34,6 +34,9 @@ UScene::UScene(
     )
     : m_pSceneCCM( pSceneCCM )
     , m_pObjectCCM( pObjectCCM )
+    , m_NameIndexUsed( 0 )
+    , m_IndexedObjects( 0 )
+    , m_NextSequence( 0 )
 {
 }
 
@@ -62,11 +65,17 @@ UScene::~UScene(
     m_ObjectLinks.clear();
 
     //
-    // Get rid of all the objects.
+    // Get rid of all the objects, there is no need to keep the name index up to date.
     //
+    m_NameIndex.clear();
+    m_IndexedObjects = 0;
+
     Objects Objs = m_Objects;
     for (auto & Obj : Objs)
     {
+        Obj->m_bIndexed = False;
+        Obj->m_pNextOfName = nullptr;
+        Obj->m_pPrevOfName = nullptr;
         DestroyObject( Obj );
     }
     m_Objects.clear();
@@ -190,7 +199,7 @@ UScene::CreateObject(
     //
     // Create the new object.
     //
-    auto   pObject = new UObject( this, pszName );
+    auto   pObject = new( m_ObjectPool.Allocate() ) UObject( this, pszName );
     if ( pObject == nullptr )
     {
         std::cerr << "pObject == NULL" << std::endl;
@@ -198,11 +207,33 @@ UScene::CreateObject(
 
     pObject->m_pObjectCCM = m_pObjectCCM; 
 
+    //
+    // Give the object a slot, reusing those of destroyed objects.
+    //
+    u32 Slot;
+    if ( !m_FreeObjectSlots.empty() )
+    {
+        Slot = m_FreeObjectSlots.back();
+        m_FreeObjectSlots.pop_back();
+    }
+    else
+    {
+        Slot = (u32)m_ObjectSlots.size();
+        ObjectSlot NewSlot = { nullptr, 0 };
+        m_ObjectSlots.push_back( NewSlot );
+    }
+    m_ObjectSlots[ Slot ].pObject = pObject;
+    pObject->m_Id = (m_ObjectSlots[ Slot ].Generation << ObjectSlotBits) | Slot;
+
     //
     // Add the object to the collection.
     //
+    pObject->m_Index = (u32)m_Objects.size();
+    pObject->m_Sequence = m_NextSequence++;
     m_Objects.push_back( pObject );
 
+    IndexObject( pObject );
+
     //
     // Register the object with the scene's CCM.
     //
@@ -222,11 +253,32 @@ UScene::DestroyObject(
     if ( pObject == nullptr )
     {
         std::cerr << "pObject == NULL" << std::endl;
+        return Errors::Failure;
     }
 
     m_pSceneCCM->Unregister( pObject, this );
-    m_Objects.remove( pObject );
-    delete pObject;
+
+    UnindexObject( pObject );
+
+    //
+    // Move the last object into the place of this one.
+    //
+    UObject* pLast = m_Objects.back();
+    m_Objects[ pObject->m_Index ] = pLast;
+    pLast->m_Index = pObject->m_Index;
+    m_Objects.pop_back();
+
+    //
+    // Free the slot, the next generation invalidates the id.
+    //
+    u32 Slot = pObject->m_Id & ((1 << ObjectSlotBits) - 1);
+    m_ObjectSlots[ Slot ].pObject = nullptr;
+    m_ObjectSlots[ Slot ].Generation = (m_ObjectSlots[ Slot ].Generation + 1) & ((1 << (32 - ObjectSlotBits)) - 1);
+    m_FreeObjectSlots.push_back( Slot );
+
+    pObject->m_Id = InvalidObjectId;
+    pObject->~UObject();
+    m_ObjectPool.Free( pObject );
 
     return Errors::Success;
 }
@@ -237,18 +289,251 @@ UScene::FindObject(
     pcstr pszName
     )
 {
-    UObject* pObject = nullptr;
+    UObject* pObject = FindObject( Base::InternString( pszName ) );
 
-    for ( UScene::ObjectsConstIt it=m_Objects.begin(); it != m_Objects.end(); it++ )
+    //
+    // Different names only share an id if interning reported a collision.
+    //
+    return (pObject != nullptr && strcmp( pszName, pObject->GetName() ) == 0) ? pObject : nullptr;
+}
+
+
+UObject*
+UScene::FindObject(
+    Base::StringId NameId
+    )
+{
+    if ( m_NameIndex.empty() )
     {
-        if ( strcmp( pszName, (*it)->GetName() ) == 0 )
+        return nullptr;
+    }
+
+    u32 Mask = (u32)m_NameIndex.size() - 1;
+
+    for ( u32 i = NameId & Mask; m_NameIndex[ i ] != EmptyEntry; i = (i + 1) & Mask )
+    {
+        if ( m_NameIndex[ i ] != RemovedEntry )
         {
-            pObject = *it;
-            break;
+            UObject* pObject = m_ObjectSlots[ m_NameIndex[ i ] ].pObject;
+            if ( pObject->m_NameId == NameId )
+            {
+                return pObject;
+            }
         }
     }
 
-    return pObject;
+    return nullptr;
+}
+
+
+UObject*
+UScene::GetObjectFromId(
+    ObjectId Id
+    ) const
+{
+    u32 Slot = Id & ((1 << ObjectSlotBits) - 1);
+
+    if ( Id == InvalidObjectId || Slot >= m_ObjectSlots.size() )
+    {
+        return nullptr;
+    }
+
+    UObject* pObject = m_ObjectSlots[ Slot ].pObject;
+
+    return (pObject != nullptr && pObject->m_Id == Id) ? pObject : nullptr;
+}
+
+
+void
+UScene::IndexObject(
+    UObject* pObject
+    )
+{
+    pObject->m_bIndexed = False;
+    pObject->m_pNextOfName = nullptr;
+    pObject->m_pPrevOfName = nullptr;
+    pObject->m_NameId = Base::InternString( pObject->GetName() );
+
+    //
+    // Unnamed objects cannot be found.
+    //
+    if ( *pObject->GetName() == '\0' )
+    {
+        return;
+    }
+
+    //
+    // An object of a name that is indexed already joins the others in creation order, new
+    // objects go last and renamed ones can go anywhere.
+    //
+    UObject* pFirst = FindObject( pObject->GetName() );
+    if ( pFirst != nullptr )
+    {
+        UObject* pLast = pFirst->m_pPrevOfName;
+        if ( pObject->m_Sequence > pLast->m_Sequence )
+        {
+            pLast->m_pNextOfName = pObject;
+            pObject->m_pPrevOfName = pLast;
+            pFirst->m_pPrevOfName = pObject;
+        }
+        else if ( pObject->m_Sequence > pFirst->m_Sequence )
+        {
+            UObject* pPrev = pFirst;
+            while ( pPrev->m_pNextOfName->m_Sequence < pObject->m_Sequence )
+            {
+                pPrev = pPrev->m_pNextOfName;
+            }
+            pObject->m_pNextOfName = pPrev->m_pNextOfName;
+            pObject->m_pPrevOfName = pPrev;
+            pPrev->m_pNextOfName->m_pPrevOfName = pObject;
+            pPrev->m_pNextOfName = pObject;
+        }
+        else
+        {
+            pObject->m_pNextOfName = pFirst;
+            pObject->m_pPrevOfName = pLast;
+            pFirst->m_pPrevOfName = pObject;
+            ReplaceIndexedObject( pFirst, pObject );
+        }
+        return;
+    }
+
+    //
+    // Keep the index at most half full, counting the removed entries.
+    //
+    if ( (m_NameIndexUsed + 1) * 2 > m_NameIndex.size() )
+    {
+        RebuildNameIndex();
+    }
+
+    u32 Mask = (u32)m_NameIndex.size() - 1;
+    u32 i = pObject->m_NameId & Mask;
+    while ( m_NameIndex[ i ] != EmptyEntry && m_NameIndex[ i ] != RemovedEntry )
+    {
+        i = (i + 1) & Mask;
+    }
+
+    if ( m_NameIndex[ i ] == EmptyEntry )
+    {
+        m_NameIndexUsed++;
+    }
+    m_NameIndex[ i ] = pObject->m_Id & ((1 << ObjectSlotBits) - 1);
+
+    pObject->m_bIndexed = True;
+    pObject->m_pPrevOfName = pObject;
+    m_IndexedObjects++;
+}
+
+
+void
+UScene::UnindexObject(
+    UObject* pObject
+    )
+{
+    UObject* pPrev = pObject->m_pPrevOfName;
+    UObject* pNext = pObject->m_pNextOfName;
+
+    //
+    // Unnamed objects are not linked to any others.
+    //
+    if ( pPrev == nullptr )
+    {
+        return;
+    }
+
+    if ( !pObject->m_bIndexed )
+    {
+        //
+        // Unlink the object, the first object of the name links back to the last one.
+        //
+        pPrev->m_pNextOfName = pNext;
+        if ( pNext != nullptr )
+        {
+            pNext->m_pPrevOfName = pPrev;
+        }
+        else
+        {
+            FindObject( pObject->GetName() )->m_pPrevOfName = pPrev;
+        }
+    }
+    else if ( pNext != nullptr )
+    {
+        //
+        // Let the next object of the same name be found.
+        //
+        pNext->m_pPrevOfName = pPrev;
+        ReplaceIndexedObject( pObject, pNext );
+    }
+    else
+    {
+        u32 Slot = pObject->m_Id & ((1 << ObjectSlotBits) - 1);
+        u32 Mask = (u32)m_NameIndex.size() - 1;
+        u32 i = pObject->m_NameId & Mask;
+        while ( m_NameIndex[ i ] != Slot )
+        {
+            i = (i + 1) & Mask;
+        }
+        m_NameIndex[ i ] = RemovedEntry;
+
+        pObject->m_bIndexed = False;
+        m_IndexedObjects--;
+    }
+
+    pObject->m_pNextOfName = nullptr;
+    pObject->m_pPrevOfName = nullptr;
+}
+
+
+void
+UScene::ReplaceIndexedObject(
+    UObject* pIndexed,
+    UObject* pObject
+    )
+{
+    //
+    // Both have the same name so the entry is found the same way.
+    //
+    u32 Slot = pIndexed->m_Id & ((1 << ObjectSlotBits) - 1);
+    u32 Mask = (u32)m_NameIndex.size() - 1;
+    u32 i = pIndexed->m_NameId & Mask;
+    while ( m_NameIndex[ i ] != Slot )
+    {
+        i = (i + 1) & Mask;
+    }
+    m_NameIndex[ i ] = pObject->m_Id & ((1 << ObjectSlotBits) - 1);
+
+    pIndexed->m_bIndexed = False;
+    pObject->m_bIndexed = True;
+}
+
+
+void
+UScene::RebuildNameIndex(
+    void
+    )
+{
+    u32 Size = 64;
+    while ( (m_IndexedObjects + 1) * 2 > Size )
+    {
+        Size *= 2;
+    }
+
+    m_NameIndex.assign( Size, static_cast<u32>(EmptyEntry) );
+    m_NameIndexUsed = m_IndexedObjects;
+
+    u32 Mask = Size - 1;
+    for ( auto pObject : m_Objects )
+    {
+        if ( pObject->m_bIndexed )
+        {
+            u32 i = pObject->m_NameId & Mask;
+            while ( m_NameIndex[ i ] != EmptyEntry )
+            {
+                i = (i + 1) & Mask;
+            }
+            m_NameIndex[ i ] = pObject->m_Id & ((1 << ObjectSlotBits) - 1);
+        }
+    }
 }
 
 
@@ -266,7 +551,7 @@ UScene::CreateObjectLink(
 
     if ( Changes )
     {
-        m_pObjectCCM->Register( pSubject, Changes, pObserver );
+        m_pObjectCCM->Register( pSubject, Changes, pObserver, pObserver->GetSystemType() );
 
         //
         // Hold on to the list for unregistering later.
@@ -295,7 +580,7 @@ UScene::CreateObjectLink(
         pSubject->GetPotentialSystemChanges() & pObserver->GetDesiredSystemChanges();
 
     if ( Changes ) {
-        m_pObjectCCM->Register( pSubject, Changes, pObserver );
+        m_pObjectCCM->Register( pSubject, Changes, pObserver, pObserver->GetSystemType() );
 
         //
         // Hold on to the list for unregistering later.
@@ -430,6 +715,13 @@ UObject::UObject(
     pcstr pszName
     )
     : m_pScene( pScene )
+    , m_Id( UScene::InvalidObjectId )
+    , m_Index( 0 )
+    , m_Sequence( 0 )
+    , m_NameId( Base::InvalidStringId )
+    , m_bIndexed( False )
+    , m_pNextOfName( nullptr )
+    , m_pPrevOfName( nullptr )
     , m_pGeometryObject( nullptr )
     , m_pGraphicsObject( nullptr )
 {
@@ -440,6 +732,27 @@ UObject::UObject(
 }
 
 
+void
+UObject::SetName(
+    pcstr pszName
+    )
+{
+    //
+    // Once in the scene the object has to be found by its new name.
+    //
+    if ( m_Id != UScene::InvalidObjectId )
+    {
+        m_pScene->UnindexObject( this );
+        m_sName = pszName;
+        m_pScene->IndexObject( this );
+    }
+    else
+    {
+        m_sName = pszName;
+    }
+}
+
+
 UObject::~UObject(
     void
     )
@@ -536,7 +849,8 @@ UObject::Extend(
             ISystemScene* pScene = pScenes_it.second;
             if ( pSystemObject->GetPotentialSystemChanges() & pScene->GetDesiredSystemChanges() )
             {
-                m_pObjectCCM->Register( pSystemObject, pScene->GetDesiredSystemChanges(), pScene );
+                m_pObjectCCM->Register( pSystemObject, pScene->GetDesiredSystemChanges(), pScene,
+                                        pScene->GetSystemType() );
             }
         }
 
@@ -549,11 +863,12 @@ UObject::Extend(
             ISystemObject* pObj = object.second;
             if ( pObj->GetPotentialSystemChanges() & SysObjDesiredChanges )
             {
-                m_pObjectCCM->Register( pObj, Changes, pSystemObject );
+                m_pObjectCCM->Register( pObj, Changes, pSystemObject, pSystemObject->GetSystemType() );
             }
             if ( SysObjPotentialChanges & pObj->GetDesiredSystemChanges() )
             {
-                m_pObjectCCM->Register( pSystemObject, pObj->GetDesiredSystemChanges(), pObj );
+                m_pObjectCCM->Register( pSystemObject, pObj->GetDesiredSystemChanges(), pObj,
+                                        pObj->GetSystemType() );
             }
         }
 
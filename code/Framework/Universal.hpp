@@ -22,6 +22,11 @@ class UObject;
 /// Implements a universal scene for holding all the scenes of the different systems and acts as an
 //   interface into the CMM.
 /// </summary>
+/// <remarks>
+///   The objects are kept in a contiguous array for iteration, an object is found by its id
+///   through a slot table and by its name through an open addressing hash index.  Destroying
+///   an object moves the last one into its place, so the order of the array is not kept.
+/// </remarks>
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 class UScene : public IObserver
@@ -32,10 +37,16 @@ public:
     typedef SystemScenes::iterator                                      SystemScenesIt;
     typedef SystemScenes::const_iterator                                SystemScenesConstIt;
 
-    typedef std::list<UObject*>                                         Objects;
+    typedef std::vector<UObject*>                                       Objects;
     typedef Objects::iterator                                           ObjectsIt;
     typedef Objects::const_iterator                                     ObjectsConstIt;
 
+    /// <summary>
+    ///   Identifies an object of the scene, an id is not reused for another object.
+    /// </summary>
+    typedef u32                                                         ObjectId;
+    static const ObjectId                                               InvalidObjectId = static_cast<ObjectId>(-1);
+
 
 public:
 
@@ -86,8 +97,27 @@ public:
     /// <returns>An error code.</returns>
     Error DestroyObject( UObject* pObject );
 
+    /// <summary>
+    ///   Finds an object by its name.
+    /// </summary>
+    /// <param name="pszName">The name of the object.</param>
+    /// <returns>The first created object of the name or NULL if there is none.</returns>
     UObject* FindObject( pcstr pszName );
 
+    /// <summary>
+    ///   Finds an object by the interned id of its name.
+    /// </summary>
+    /// <param name="NameId">The id of the name of the object.</param>
+    /// <returns>The first created object of the name or NULL if there is none.</returns>
+    UObject* FindObject( Base::StringId NameId );
+
+    /// <summary>
+    ///   Gets an object by its id.
+    /// </summary>
+    /// <param name="Id">The id of the object.</param>
+    /// <returns>The object or NULL if it was destroyed.</returns>
+    UObject* GetObjectFromId( ObjectId Id ) const;
+
     void CreateObjectLink( ISystemObject* pSubject,
                            ISystemObject* pObserver );
 
@@ -111,12 +141,59 @@ public:
 
 protected:
 
+    friend class UObject;
+
+    /// <summary>
+    ///   Adds an object to the objects of its name, the first created of them is indexed.
+    /// </summary>
+    void IndexObject( UObject* pObject );
+
+    /// <summary>
+    ///   Removes an object from the objects of its name and indexes the next one if it was first.
+    /// </summary>
+    void UnindexObject( UObject* pObject );
+
+    /// <summary>
+    ///   Puts an object of the same name into the index entry of the indexed one.
+    /// </summary>
+    void ReplaceIndexedObject( UObject* pIndexed, UObject* pObject );
+
+    /// <summary>
+    ///   Rebuilds the name index with room for one more object and without the removed entries.
+    /// </summary>
+    void RebuildNameIndex( void );
+
     IChangeManager*                         m_pSceneCCM;
     IChangeManager*                         m_pObjectCCM;
 
     SystemScenes                            m_SystemScenes;
     Objects                                 m_Objects;
 
+    // Memory of the objects, a destroyed object's slot goes to the next one created.
+    Base::ObjectPool<UObject>               m_ObjectPool;
+
+    // The id of an object is the index of its slot in the low bits and the generation of the
+    // slot in the high bits.
+    static const u32                        ObjectSlotBits = 24;
+
+    struct ObjectSlot
+    {
+        UObject*                pObject;
+        u32                     Generation;
+    };
+    std::vector<ObjectSlot>                 m_ObjectSlots;
+    std::vector<u32>                        m_FreeObjectSlots;
+
+    // Slot indices of the named objects, probed linearly from the hash of the name.
+    static const u32                        EmptyEntry = static_cast<u32>(-1);
+    static const u32                        RemovedEntry = static_cast<u32>(-2);
+
+    std::vector<u32>                        m_NameIndex;
+    u32                                     m_NameIndexUsed;
+    u32                                     m_IndexedObjects;
+    // Creation order of the objects, the first created object of a name is the one found.
+    u32                                     m_NextSequence;
+
     struct ObjectLinkData
     {
         ISubject*               pSubject;
@@ -175,9 +252,22 @@ public:
     // Sets the name of the object.
     //  pszName - the new name of the object.
     //
-    void SetName( pcstr pszName )
+    void SetName( pcstr pszName );
+
+    //
+    // Gets the id of the object within its scene.
+    //
+    UScene::ObjectId GetId( void ) const
+    {
+        return m_Id;
+    }
+
+    //
+    // Gets the interned id of the name of the object.
+    //
+    Base::StringId GetNameId( void ) const
     {
-        m_sName = pszName;
+        return m_NameId;
     }
 
     //
@@ -300,6 +390,16 @@ protected:
     IChangeManager*                                     m_pObjectCCM;
     std::string                                         m_sName;
 
+    UScene::ObjectId                                    m_Id;
+    u32                                                 m_Index;
+    u32                                                 m_Sequence;
+    Base::StringId                                      m_NameId;
+    Bool                                                m_bIndexed;
+    // The objects of the same name in creation order, the first one is indexed and links
+    // back to the last one.
+    UObject*                                            m_pNextOfName;
+    UObject*                                            m_pPrevOfName;
+
     SystemObjects                                       m_ObjectExtensions;
     IGeometryObject*                                    m_pGeometryObject;
     IGraphicsObject*                                    m_pGraphicsObject;
@@ -86,6 +86,41 @@ public:
     ///         Not enough memory is available to resolve the change.
     ///</returns>
     virtual Error ChangeOccurred( ISubject* pSubject, System::Changes::BitMask ChangeType ) = 0;
+
+    /// <summary>
+    ///   A single change as handed to <c>ChangesOccurred</c>.
+    /// </summary>
+    struct Change
+    {
+        ISubject*                   pSubject;
+        System::Changes::BitMask    ChangeType;
+    };
+
+    /// <summary>
+    ///   Lets the IChangeManager notify the IObserver of all its changes at once.
+    /// </summary>
+    /// <remarks> This method is called from IChangeManager::DistributeQueuedChanges() with each
+    ///     subject appearing once, unless some of its changes were delivered to another system
+    ///     ahead of time.  It is never called concurrently for the same observer,
+    ///     but different observers receive their changes in parallel.  The default implementation
+    ///     calls ChangeOccurred for each of the changes.
+    ///  </remarks>
+    /// <param name="pChanges">The changes, see ChangeOccurred.</param>
+    /// <param name="Count">The number of changes.</param>
+    /// <returns>Error::Success or the first error returned for a change.</returns>
+    virtual Error ChangesOccurred( const Change* pChanges, u32 Count )
+    {
+        Error curError = Errors::Success;
+        for ( u32 i = 0; i < Count; i++ )
+        {
+            Error changeError = ChangeOccurred( pChanges[ i ].pSubject, pChanges[ i ].ChangeType );
+            if ( curError == Errors::Success )
+            {
+                curError = changeError;
+            }
+        }
+        return curError;
+    }
 };
 
 
@@ -34,12 +34,74 @@ public:
     {
     public:
 
+        /// <summary>
+        ///   The value of a variable parsed into the types it can be read as.
+        /// </summary>
+        /// <remarks>
+        ///   The value is parsed once when the variable is set.  It stays at the same address for
+        ///    the lifetime of the environment and is republished in place when the variable
+        ///    changes, so it can be looked up once and read as often as needed.
+        /// </remarks>
+        struct Value
+        {
+            std::atomic<u32>    bSet;
+            std::atomic<u32>    bValue;
+            std::atomic<i32>    IntValue;
+            std::atomic<f32>    FloatValue;
+        };
+
+        typedef const Value*    VariableHandle;
+
+        /// <summary>
+        ///   Gets a handle to a variable for reading it without looking it up by name.  The
+        ///    variable does not have to be set yet.
+        /// </summary>
+        /// <param name="pszName">The name of the variable.</param>
+        /// <returns>The handle of the variable.</returns>
+        virtual VariableHandle GetHandle( In pcstr pszName ) = 0;
+
+        /// <summary>
+        ///   Returns the variable value as a bool.
+        /// </summary>
+        /// <param name="hVariable">The handle of the variable.</param>
+        /// <param name="bDefaultValue">The value returned if the variable isn't set.</param>
+        /// <returns>The value of the variable.</returns>
+        Bool GetAsBool( In VariableHandle hVariable, In Bool bDefaultValue=False )
+        {
+            return hVariable->bSet.load( std::memory_order_acquire ) ?
+                hVariable->bValue.load( std::memory_order_relaxed ) : bDefaultValue;
+        }
+
+        /// <summary>
+        ///   Returns the variable value as an int.
+        /// </summary>
+        /// <param name="hVariable">The handle of the variable.</param>
+        /// <param name="DefaultValue">The value returned if the variable isn't set.</param>
+        /// <returns>The value of the variable.</returns>
+        i32 GetAsInt( In VariableHandle hVariable, In i32 DefaultValue=0 )
+        {
+            return hVariable->bSet.load( std::memory_order_acquire ) ?
+                hVariable->IntValue.load( std::memory_order_relaxed ) : DefaultValue;
+        }
+
+        /// <summary>
+        ///   Returns the variable value as a float.
+        /// </summary>
+        /// <param name="hVariable">The handle of the variable.</param>
+        /// <param name="DefaultValue">The value returned if the variable isn't set.</param>
+        /// <returns>The value of the variable.</returns>
+        f32 GetAsFloat( In VariableHandle hVariable, In f32 DefaultValue=0.0f )
+        {
+            return hVariable->bSet.load( std::memory_order_acquire ) ?
+                hVariable->FloatValue.load( std::memory_order_relaxed ) : DefaultValue;
+        }
+
         /// <summary>
         ///   Returns the environment variable value as a string.
         /// </summary>
         /// <param name="pszName">The name of the variable.</param>
         /// <param name="pszDefaultValue">The value returned if the variable doesn't exist.</param>
-        /// <returns>The value of the variable.</returns>
+        /// <returns>The value of the variable, it stays valid when the variable changes.</returns>
         virtual pcstr GetAsString( In pcstr pszName, In pcstr pszDefaultValue="" ) = 0;
 
         /// <summary>
@@ -116,6 +178,20 @@ public:
         /// </summary>
         /// <param name="Status">The execution status.</param>
         virtual void SetStatus( Status Status ) = 0;
+
+        /// <summary>
+        ///   Returns how far the time being presented is past the last fixed simulation step,
+        ///   as a fraction of the step.  Presentation systems blend the previous and the current
+        ///   simulated state with it.  It is 1 when not running with fixed steps.
+        /// </summary>
+        /// <returns>The interpolation factor between 0 and 1.</returns>
+        virtual f32 GetInterpolation( void ) = 0;
+
+        /// <summary>
+        ///   Sets the interpolation factor for the presentation systems.
+        /// </summary>
+        /// <param name="Interpolation">The interpolation factor between 0 and 1.</param>
+        virtual void SetInterpolation( f32 Interpolation ) = 0;
     };
 
     /// <summary>
@@ -17,6 +17,8 @@
 #include "Base/Intrinsics.hpp"
 #include "Base/Math.hpp"
 #include "Base/Platform.hpp"
+#include "Base/SlabPool.hpp"
+#include "Base/StringId.hpp"
 
 #include <algorithm>
 #include <cstring>
@@ -27,6 +29,8 @@
 #include <vector>
 #include <cstddef> 
 #include <functional>
+#include <new>
+#include <type_traits>
 // VS2010 support
 #if defined(COMPILER_MSVC) && (COMPILER_VERSION_MAJOR == 10 )
 #include "External/tinythread/tinythread.h"
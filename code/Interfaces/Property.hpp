@@ -108,6 +108,7 @@ namespace Properties
             ...
             )
             : m_pszName( pszName )
+            , m_NameId( Base::InternString( pszName ) )
             , m_Type( Type )
             , m_Flags( Flags )
             , m_apszEnumOptions( NULL )
@@ -259,6 +260,18 @@ namespace Properties
             return m_pszName;
         }
 
+        /// <summary>
+        ///   Returns the interned id of the property name.
+        /// </summary>
+        /// <remarks>
+        ///   Compare ids instead of names when looking up properties.
+        /// </remarks>
+        /// <returns>The id of the property's name.</returns>
+        Base::StringId GetNameId( void ) const
+        {
+            return m_NameId;
+        }
+
         u32 GetValueType( i32 Index ) const
         {
             ASSERT( Index >= 0 && Index < Values::Count );
@@ -432,6 +445,7 @@ namespace Properties
         static pcstr            sm_kpszValue4Name;
 
         pcstr                   m_pszName;
+        Base::StringId          m_NameId;
 
         u32                     m_Type;
         u32                     m_Flags;
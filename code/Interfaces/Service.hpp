@@ -190,6 +190,26 @@ public:
         /// <param name="Result">Pointer to structure to be filled with results.</param>
         /// <returns>Returns True if test has finished.</returns>
         virtual Bool Finalize( Collision::Handle Handle, Collision::Result* Result ) = 0;
+
+        /// <summary>
+        ///   Requests a batch of collision tests.  All the tests of the batch run together
+        ///    the next time the provider updates, replacing any results not taken yet.
+        /// </summary>
+        /// <param name="Batch">Handle returned when the batch was last requested, or
+        ///  InvalidHandle for a new batch.</param>
+        /// <param name="Requests">Collision requests, swapped for a vector to fill the next time.</param>
+        /// <returns>The handle of the batch.</returns>
+        virtual Collision::Handle SubmitBatch( Collision::Handle Batch, std::vector<Collision::Request>& Requests ) = 0;
+
+        /// <summary>
+        ///   Gets the results of the batch of tests which finished last.
+        /// </summary>
+        /// <param name="Batch">Collision batch handle.</param>
+        /// <param name="Requests">Swapped for the requests which were tested.</param>
+        /// <param name="Results">Swapped for their results, in the order of the requests.</param>
+        /// <returns>Returns True if new results were available.</returns>
+        virtual Bool FinalizeBatch( Collision::Handle Batch, std::vector<Collision::Request>& Requests,
+                                    std::vector<Collision::Result>& Results ) = 0;
     };
 
     /// <summary>
@@ -198,6 +218,12 @@ public:
     /// <returns>A reference to the ICollision class.</returns>
     virtual ICollision& Collision() = 0;
 
+    /// <summary>
+    ///   Checks if a system registered itself as the provider for ICollision.
+    /// </summary>
+    /// <returns>True if collision tests can be requested.</returns>
+    virtual Bool HasCollisionProvider() = 0;
+
     /// <summary>
     ///   Used by a system/framework to register itself as a provider for ICollision.
     /// </summary>
@@ -209,4 +235,165 @@ public:
     /// </summary>
     /// <param name="pCollision">A pointer to the provider to de-register.</param>
     virtual void UnregisterCollisionProvider( ICollision* pCollision ) = 0;
+
+
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    /// <summary>
+    ///   Interface class for recording timed events in the trace of the framework.
+    /// </summary>
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+
+    class IInstrumentation
+    {
+    public:
+
+        /// <summary>
+        ///   Returns True if events are being recorded.  Check this before beginning events
+        ///    in frequently executed code.
+        /// </summary>
+        /// <returns>True if events are being recorded.</returns>
+        virtual Bool IsCapturing( void ) = 0;
+
+        /// <summary>
+        ///   Begins an event on the calling thread.  Events may be nested.
+        /// </summary>
+        /// <param name="pszName">The name of the event, it must stay valid until shutdown.</param>
+        /// <param name="pszCategory">The category of the event, it must stay valid until shutdown.</param>
+        virtual void BeginEvent( pcstr pszName, pcstr pszCategory ) = 0;
+
+        /// <summary>
+        ///   Ends the last event begun on the calling thread.
+        /// </summary>
+        virtual void EndEvent( void ) = 0;
+    };
+
+    /// <summary>
+    ///   Gets a reference to the IInstrumentation class.  It is provided by the framework.
+    /// </summary>
+    /// <returns>A reference to the IInstrumentation class.</returns>
+    virtual IInstrumentation& Instrumentation() = 0;
+
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    /// <summary>
+    ///   Interface class for allocating memory which is only needed for a frame.
+    /// </summary>
+    /// <remarks>
+    ///   Every thread allocates from an arena of its own, so no locks are taken.  The memory
+    ///    is not freed individually, it stays valid until the end of the frame after the one
+    ///    it was allocated in and is then reused as a whole.  Destructors are not run.
+    /// </remarks>
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+
+    class IFrameArena
+    {
+    public:
+
+        /// <summary>
+        ///   Allocates memory from the arena of the calling thread.
+        /// </summary>
+        /// <param name="Size">The number of bytes to allocate.</param>
+        /// <param name="Alignment">The alignment of the memory, a power of two.</param>
+        /// <returns>A pointer to the memory.</returns>
+        virtual void* Allocate( size_t Size, size_t Alignment=16 ) = 0;
+
+        /// <summary>
+        ///   Allocates and default constructs an object.
+        /// </summary>
+        /// <returns>A pointer to the object.</returns>
+        template<class T>
+        T* Create( void )
+        {
+            return new( Allocate( sizeof( T ), std::alignment_of<T>::value ) ) T();
+        }
+
+        /// <summary>
+        ///   Allocates and default constructs an array of objects.
+        /// </summary>
+        /// <param name="Count">The number of objects.</param>
+        /// <returns>A pointer to the first object.</returns>
+        template<class T>
+        T* CreateArray( size_t Count )
+        {
+            T* pArray = static_cast<T*>( Allocate( sizeof( T ) * Count, std::alignment_of<T>::value ) );
+            for ( size_t i = 0; i < Count; i++ )
+            {
+                new( &pArray[ i ] ) T();
+            }
+            return pArray;
+        }
+    };
+
+    /// <summary>
+    ///   Gets a reference to the IFrameArena class.  It is provided by the framework.
+    /// </summary>
+    /// <returns>A reference to the IFrameArena class.</returns>
+    virtual IFrameArena& FrameArena() = 0;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// <summary>
+///   Allocator for the standard containers which takes its memory from the frame arena.
+/// </summary>
+/// <remarks>
+///   Deallocating does nothing, the container has to go away within the lifetime of the
+///    frame memory.
+/// </remarks>
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template<class T>
+class FrameAllocator
+{
+public:
+
+    typedef T value_type;
+
+    template<class U>
+    struct rebind
+    {
+        typedef FrameAllocator<U> other;
+    };
+
+    FrameAllocator( IService::IFrameArena& Arena )
+        : m_pArena( &Arena )
+    {
+    }
+
+    template<class U>
+    FrameAllocator( const FrameAllocator<U>& Other )
+        : m_pArena( Other.GetArena() )
+    {
+    }
+
+    T* allocate( size_t Count )
+    {
+        return static_cast<T*>( m_pArena->Allocate( sizeof( T ) * Count, std::alignment_of<T>::value ) );
+    }
+
+    void deallocate( T*, size_t )
+    {
+    }
+
+    IService::IFrameArena* GetArena( void ) const
+    {
+        return m_pArena;
+    }
+
+    template<class U>
+    bool operator==( const FrameAllocator<U>& Other ) const
+    {
+        return m_pArena == Other.GetArena();
+    }
+
+    template<class U>
+    bool operator!=( const FrameAllocator<U>& Other ) const
+    {
+        return m_pArena != Other.GetArena();
+    }
+
+protected:
+
+    IService::IFrameArena*              m_pArena;
 };
@@ -43,12 +43,13 @@ namespace Collision
         Base::Vector3 m_Position0;  // Start position of the test
         Base::Vector3 m_Position1;  // End position of the test
         Type          m_Type;       // Type of test
-        Handle        m_Handle;     // Unique handle for this request
-        std::string   m_Ignore;     // Name of object to ignore in collision
+        Handle        m_Handle;     // Unique handle for this request (set by the caller in a batch)
+        Base::StringId m_Ignore;    // Name id of object to ignore in collision
         Flags         m_Flags;      // Flags (see Collision::Flags)
 
         Request() { std::memset( this, 0, sizeof( *this ) ); }
-        void SetIgnore( std::string ignore ) { m_Ignore = ignore; }
+        void SetIgnore( pcstr ignore ) { m_Ignore = Base::InternString( ignore ); }
+        void SetIgnore( Base::StringId ignore ) { m_Ignore = ignore; }
         void SetFlags( Collision::Flags Flags ) { m_Flags = Flags; }
     };
 
@@ -57,9 +58,10 @@ namespace Collision
     {
         Base::Vector3   m_Position;   // Contact position
         Base::Vector3   m_Normal;     // Normal vector (vector pernedicular to contact surface)
-        std::string     m_Hit;        // Name of object hit (null is no collision detected)
+        Base::StringId  m_Hit;        // Name id of object hit (InvalidStringId is no collision detected)
         float           m_Depth;      // Penetration depth (along normal vector)
         std::uint32_t   m_Finalized;  // Collision test has finished (0 = no, 1 = yes, >1 = delete)
         bool            m_Valid;      // A valid collision was detected
+        bool            m_Filtered;   // m_Flags and m_Ignore of the request were honoured
     };
 }
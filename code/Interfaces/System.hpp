@@ -163,6 +163,18 @@ public:
     /// <returns>The newly created system object.</returns>
     virtual ISystemObject* CreateObject( pcstr pszName, pcstr pszType ) = 0;
 
+    /// <summary>
+    ///   Returns True if objects of the type can be initialized while other objects are being
+    ///    initialized on other threads.  Objects of types which return False are initialized one
+    ///    after the other on the framework thread.
+    /// </summary>
+    /// <param name="pszType">The object type, NULL for objects created without a type.</param>
+    /// <returns>True if the object's Initialize is thread safe.</returns>
+    virtual Bool IsObjectInitializeThreadSafe( pcstr pszType )
+    {
+        return False;
+    }
+
     /// <summary>
     ///   Destroys a system object.
     /// </summary>
@@ -230,6 +242,7 @@ public:
     ISystemObject( ISystemScene* pSystemScene, pcstr pszName )
         : m_bInitialized( False )
         , m_pSystemScene( pSystemScene )
+        , m_NameId( Base::InvalidStringId )
     {
         if( pszName )
         {
@@ -290,6 +303,16 @@ public:
     virtual inline void SetName( pcstr pszName )
     {
         m_sName = pszName;
+        m_NameId = Base::InternString( pszName );
+    }
+
+    /// <summary>
+    ///   Gets the interned id of the name of the object.
+    /// </summary>
+    /// <returns>The id of the name of the object.</returns>
+    Base::StringId GetNameId( void )
+    {
+        return m_NameId;
     }
 
     /// <summary>
@@ -329,6 +352,7 @@ protected:
     Handle                      m_hParentObject;
 
     std::string                 m_sName;
+    Base::StringId              m_NameId;
 };
 
 
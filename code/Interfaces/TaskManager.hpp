@@ -66,6 +66,16 @@ public:
     /// </returns>
     virtual u32 GetRecommendedJobCount( JobCountInstructionHints Hints=None ) = 0;
 
+    /// <summary cref="ITaskManager::ParallelFor">
+    /// Splits the range [<paramref name="begin"/>, <paramref name="end"/>) into chunks of at least
+    /// <paramref name="minGrain"/> iterations and runs them concurrently.  The calling thread helps
+    /// executing pending work and the method returns once every chunk has completed, so it is safe
+    /// to call it from within another <c>ParallelFor</c>.
+    /// </summary>
+    /// <param name="pSystemTask">the system task issuing the work, the cost of the iterations is
+    /// measured per system task and function.  May be null, the loop is then not measured.</param>
+    /// <param name="pfnJobFunction">the function called for each chunk</param>
+    /// <param name="pParam">a pointer to data that is passed to the function</param>
     virtual void ParallelFor( ISystemTask* pSystemTask,
                               ParallelForFunction pfnJobFunction, void* pParam, u32 begin, u32 end, u32 minGrain = 1 ) = 0;
 };
@@ -18,13 +18,42 @@
 
 #include "Framework/FrameworkAPI.hpp"
 
+#include <cstring>
 #include <iostream>
 #include <string>
 
-int main()
+/* Usage: Smoke [--benchmark] [--compile] [Name=Value ...] [GDF]
+ * Name=Value sets an environment variable, overriding the GDF.  --benchmark runs the
+ * scene headless and reports timings, see Framework/Benchmark.hpp for its variables.
+ * --compile writes the GDF and the files it includes to GDF.cache and exits, the cache
+ * is loaded instead of the XML while it is up to date (SceneCache::Enabled=False skips it).
+ * Environment::WatchFile=File sets the Name=Value lines of File again whenever it changes.*/
+int main( int argc, char* argv[] )
 {
 
     std::string sGdfPath = "Smoke.gdf";
+    for ( int i = 1; i < argc; i++ )
+    {
+        const char* pszArg = argv[ i ];
+        const char* pszValue = strchr( pszArg, '=' );
+        if ( strcmp( pszArg, "--benchmark" ) == 0 )
+        {
+            EngineSetVariable( "Benchmark::Enabled", "True" );
+        }
+        else if ( strcmp( pszArg, "--compile" ) == 0 )
+        {
+            EngineSetVariable( "SceneCache::Compile", "True" );
+        }
+        else if ( pszValue != nullptr )
+        {
+            EngineSetVariable( std::string( pszArg, pszValue ).c_str(), pszValue + 1 );
+        }
+        else
+        {
+            sGdfPath = pszArg;
+        }
+    }
+
     std::clog << "Initializing Smoke" << std::endl;
     EngineExecuteGDF(sGdfPath.c_str());
     std::clog << "Exiting Smoke" << std::endl;  
@@ -83,51 +83,45 @@ void Animal::UpdateFear( f32 DeltaTime )
         m_FearVector = Base::Vector3::UnitX; 
     }
 
-    // Search for all scary things
-    AIScene* pScene = (AIScene*)GetSystemScene();
-    std::list<POI*> POIs = pScene->GetPOI();
+    // Search for all scary things, the store of the scene only changes between updates
+    const POIStore& POIs = ( (AIScene*)GetSystemScene() )->GetPOI();
 
-    for( std::list<POI*>::iterator it = POIs.begin(); it != POIs.end(); it++ )
+    POIs.VisitFires( [&] ( POIFire* pPOIFire )
     {
-        POI* pPOI = *it;
-        Base::Vector3 Diff = m_Position - pPOI->GetPosition();
+        Base::Vector3 Diff = m_Position - pPOIFire->GetPosition();
 
-        // Handle contacts
-        if( pPOI->GetType() == POIType::e_POI_Fire )
+        // Determine if we are close to the fire
+        Base::Vector3 Min, Max;
+        pPOIFire->GetAABB( Min, Max );
+        Min = pPOIFire->GetPosition() + ( Min - pPOIFire->GetPosition() ) * 4.0f;
+        Max = pPOIFire->GetPosition() + ( Max - pPOIFire->GetPosition() ) * 4.0f;
+
+        if( m_Position.x > Min.x && m_Position.x < Max.x
+         && m_Position.y > Min.y && m_Position.y < Max.y
+         && m_Position.z > Min.z && m_Position.z < Max.z )
         {
-            POIFire* pPOIFire = (POIFire*)pPOI;
-
-            // Determine if we are close to the fire
-            Base::Vector3 Min, Max;
-            pPOIFire->GetAABB( Min, Max );
-            Min = pPOIFire->GetPosition() + ( Min - pPOIFire->GetPosition() ) * 4.0f;
-            Max = pPOIFire->GetPosition() + ( Max - pPOIFire->GetPosition() ) * 4.0f;
-
-            if( m_Position.x > Min.x && m_Position.x < Max.x
-             && m_Position.y > Min.y && m_Position.y < Max.y
-             && m_Position.z > Min.z && m_Position.z < Max.z )
-            {
-                // Increase fear based on how close we are to the center
-                f32 MaxDistance = ( Max - pPOIFire->GetPosition() ).Magnitude();
-                f32 Distance = Diff.Magnitude();
-
-                f32 Factor = (MaxDistance - Distance) / MaxDistance;
-                m_Fear = Base::Min( 1.0f, m_Fear + Factor );
-                m_FearVector += Diff.Normalize() * Factor * 4.0f;
-            }
+            // Increase fear based on how close we are to the center
+            f32 MaxDistance = ( Max - pPOIFire->GetPosition() ).Magnitude();
+            f32 Distance = Diff.Magnitude();
+
+            f32 Factor = (MaxDistance - Distance) / MaxDistance;
+            m_Fear = Base::Min( 1.0f, m_Fear + Factor );
+            m_FearVector += Diff.Normalize() * Factor * 4.0f;
         }
-        else if( pPOI->GetType() == POIType::e_POI_Contact )
+    } );
+
+    // Contacts scare us up to five times the range of our perception
+    POIs.VisitContacts( m_Position, 1000.0f * m_Perception, [&] ( POIContact* pPOIContact )
+    {
+        Base::Vector3 Diff = m_Position - pPOIContact->GetPosition();
+
+        f32 Distance = Base::Max( 0.0f, ( Diff.Magnitude() / ( 200.0f * m_Perception ) ) - 1.0f );
+        if( Distance < 4.0f )
         {
-            //POIContact* pPOIContact = (POIContact*)pPOI;
-
-            f32 Distance = Base::Max( 0.0f, ( Diff.Magnitude() / ( 200.0f * m_Perception ) ) - 1.0f );
-            if( Distance < 4.0f )
-            {
-                m_FearVector += Diff.Normalize() / Distance;
-                m_Fear = Base::Min( 1.0f, m_Fear + ( 1.0f / Distance ) );
-            }
+            m_FearVector += Diff.Normalize() / Distance;
+            m_Fear = Base::Min( 1.0f, m_Fear + ( 1.0f / Distance ) );
         }
-    }
+    } );
 
     // Normalize and clamp y if we can't fly
     if( !m_CanFly )
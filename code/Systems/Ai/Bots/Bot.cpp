@@ -22,6 +22,7 @@
 
 // Local constants
 #define MIN_UPDATE_MAGNITUDE 0.00000001f
+#define MOVE_PROBE_TIME      0.5f  // How far ahead in seconds a bot looks for obstacles
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -41,16 +42,24 @@ Bot::Bot( ISystemScene* pSystemScene, pcstr pszName ) : AIObject( pSystemScene,
     m_SpeedRot   = 0.5f;
     m_Agility    = 1.0f;
     m_YOffset    = 200.0f;
+    m_Slot       = (u32)-1;
 
     m_Velocity        = Base::Vector3::Zero;
     m_DesiredVelocity = Base::Vector3::Zero;
 
-    m_Ground      = Base::Vector3::Zero;
-    m_GroundTest  = Collision::InvalidHandle;
-    m_GroundValid = False;
-    m_PhysicsMove = True;
+    m_Ground        = Base::Vector3::Zero;
+    m_GroundNormal  = Base::Vector3::Zero;
+    m_GroundValid   = False;
+    m_Obstacle      = Base::Vector3::Zero;
+    m_ObstacleValid = False;
+    m_PhysicsMove   = True;
 
-    m_MoveTest = Collision::InvalidHandle;
+    // Seed the random sequence from the name, it does not change between runs
+    m_RandomSeed = 2166136261u;
+    for( pcstr p = pszName; p != NULL && *p != '\0'; p++ )
+    {
+        m_RandomSeed = ( m_RandomSeed ^ (u8)*p ) * 16777619u;
+    }
 
     m_OriginalFacing.x = 0.0f;
     m_OriginalFacing.y = 0.0f;
@@ -185,7 +194,26 @@ void Bot::PostUpdate( f32 DeltaTime )
     {
         m_Goal->PostUpdate( DeltaTime );
     }
-    
+
+    // Steer away from what the move test found ahead, walking bots stay on the ground
+    if( m_ObstacleValid )
+    {
+        Base::Vector3 Away = m_Obstacle;
+        if( m_PhysicsMove )
+        {
+            Away.y = 0.0f;
+        }
+        Away.Normalize();
+
+        m_DesiredVelocity = m_DesiredVelocity + Away;
+    }
+
+    // Walk along the slope of the ground instead of into it
+    if( m_GroundValid )
+    {
+        m_DesiredVelocity -= m_GroundNormal * m_DesiredVelocity.Dot( m_GroundNormal );
+    }
+
     // Update velocity
     m_Velocity.Normalize();
 
@@ -202,6 +230,77 @@ void Bot::PostUpdate( f32 DeltaTime )
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// GetProbes - Fill in the ray tests for the next updates
+u32 Bot::GetProbes( Collision::Request* p_Probes )
+{
+    u32 Count = 0;
+
+    // Bots moved by the physics walk, look for the ground below them
+    if( m_PhysicsMove )
+    {
+        Collision::Request& Probe = p_Probes[ Count++ ];
+        Probe = Collision::Request();
+
+        Base::Vector3 Down( 0.0f, -2.0f * m_YOffset, 0.0f );
+        Probe.m_Type = Collision::e_LineTest;
+        Probe.m_Position0 = m_Position;
+        Probe.m_Position1 = m_Position + Down;
+        Probe.m_Handle = e_GroundProbe;
+        Probe.SetIgnore( GetNameId() );
+        Probe.SetFlags( Collision::e_Ground );
+    }
+
+    // Look ahead as far as we get in a while
+    f32 Magnitude = m_Velocity.Dot( m_Velocity );
+    if( Magnitude > MIN_UPDATE_MAGNITUDE )
+    {
+        Collision::Request& Probe = p_Probes[ Count++ ];
+        Probe = Collision::Request();
+
+        Base::Vector3 Ahead = m_Velocity;
+        Ahead.Normalize();
+        Ahead *= m_Radius + m_Speed * MOVE_PROBE_TIME;
+
+        Probe.m_Type = Collision::e_LineTest;
+        Probe.m_Position0 = m_Position;
+        Probe.m_Position1 = m_Position + Ahead;
+        Probe.m_Handle = e_MoveProbe;
+        Probe.SetIgnore( GetNameId() );
+        Probe.SetFlags( Collision::e_IgnoreGround );
+    }
+    else
+    {
+        // Nothing is in the way of a bot which stands still
+        m_ObstacleValid = False;
+    }
+
+    return Count;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SetProbeResult - Store the result of a ray test
+void Bot::SetProbeResult( const Collision::Request& Probe, const Collision::Result& Result )
+{
+    // A provider which did not skip the bot itself or apply the ground flags may report
+    // the bot as its own obstacle, steer as if nothing was probed then
+    Bool Valid = ( Result.m_Valid && Result.m_Filtered ) ? True : False;
+
+    if( ( Probe.m_Handle % e_ProbeTypes ) == e_GroundProbe )
+    {
+        m_GroundValid = Valid;
+        m_Ground = Result.m_Position;
+        m_GroundNormal = Result.m_Normal;
+    }
+    else
+    {
+        m_ObstacleValid = Valid;
+        m_Obstacle = Result.m_Normal;
+    }
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // GetPotentialSystemChanges - Returns systems changes possible for this Bot
 System::Changes::BitMask Bot::GetPotentialSystemChanges( void )
@@ -97,6 +97,32 @@ public:
     /// <seealso cref="IMoveObject::GetMaxVelocity"/>
     virtual f32 GetMaxVelocity() { return m_MaxSpeed; }
 
+    // Kinds of the ray tests of a bot, stored in the handle of their requests
+    enum ProbeType
+    {
+        e_GroundProbe,
+        e_MoveProbe,
+
+        e_ProbeTypes
+    };
+
+    /// <summary cref="Bot::GetProbes">
+    /// Fills in the ray tests this bot wants for its next updates: one down to the ground
+    /// if it walks and one ahead along its velocity if it moves.
+    /// </summary>
+    /// <param name="p_Probes">Room for <c>e_ProbeTypes</c> requests.</param>
+    /// <returns>u32 - The number of requests filled in.</returns>
+    u32 GetProbes( Collision::Request* p_Probes );
+
+    /// <summary cref="Bot::SetProbeResult">
+    /// Stores the result of a ray test requested by <c>GetProbes</c>.  The next updates
+    /// follow the ground and steer away from what is ahead.  Results of providers which
+    /// do not honour the flags and ignore id of the request are not used.
+    /// </summary>
+    /// <param name="Probe">The request of the test.</param>
+    /// <param name="Result">Its result.</param>
+    void SetProbeResult( const Collision::Request& Probe, const Collision::Result& Result );
+
 protected:
     /// <summary cref="Bot::GetPotentialSystemChanges">
     ///   Implementation of the <c>ISubject::GetPotentialSystemChanges</c> function.
@@ -106,8 +132,20 @@ protected:
     /// <seealso cref="AIObject::GetPotentialSystemChanges"/>
     virtual System::Changes::BitMask GetPotentialSystemChanges( void );
 
+    /// <summary cref="Bot::Random">
+    /// Returns the next number of the random sequence of this bot.  Each bot has its own
+    /// sequence so the result of an update does not depend on the order of the bots.
+    /// </summary>
+    /// <returns>f32 - Random number in [0.0 to 1.0].</returns>
+    inline f32 Random( void )
+    {
+        m_RandomSeed = m_RandomSeed * 1664525u + 1013904223u;
+        return (f32)( m_RandomSeed >> 8 ) * ( 1.0f / 16777215.0f );
+    }
+
     Goal* m_Goal;         // Current goal for this bot
     Bool  m_PhysicsMove;  // Should this bot move by the physics system
+    u32   m_RandomSeed;   // State of the random sequence of this bot
 
 public:
     BotType::BotType m_Type;  // Type of bot
@@ -120,6 +158,7 @@ public:
     f32   m_SpeedRot;    // Rotation speed
     f32   m_Agility;     // Scalar used for changing m_Velocity to m_DesiredVelocity
     f32   m_YOffset;     // Distance off the ground from m_Position to the root
+    u32   m_Slot;        // Slot of this bot in the neighbour grid of the scene
 
     Base::Vector3 m_Velocity;         // Current velocity 
     Base::Vector3 m_DesiredVelocity;  // Desired velocity 
@@ -129,9 +168,10 @@ public:
 
 private:
     Base::Vector3 m_Ground;          // Current ground position
-    Collision::Handle  m_GroundTest;      // Current ground test
+    Base::Vector3 m_GroundNormal;    // Normal of the ground at m_Ground
     Bool          m_GroundValid;     // Is m_Ground valid?
-    Collision::Handle  m_MoveTest;        // Current move collision test
+    Base::Vector3 m_Obstacle;        // Normal of the obstacle ahead found by the move test
+    Bool          m_ObstacleValid;   // Is m_Obstacle valid?
     Base::Vector3 m_TargetPosition;  // Desired position
 };
 
@@ -98,17 +98,17 @@ void Chicken::Update( f32 DeltaTime )
                 // Create new goal
                 m_Goal = (Goal*)new Idle( this );
 
-                // Set duration [0.5 to 1.5] second) - rand not thread safe?
-                m_Duration = 0.5f + 1.0f * ( (f32)rand() / (f32)RAND_MAX );
+                // Set duration [0.5 to 1.5] second)
+                m_Duration = 0.5f + 1.0f * Random();
 
                 // Lower our current max speend
                 m_CurrentMaxSpeed = MAX_SPEED_CALM;
 
                 // Pick a random facing direction
-                if( rand() % 16 == 0 )
+                if( Random() < 1.0f / 16.0f )
                 {
-                    m_IdleDirection.x = -1.0f + 2.0f * ( (f32)rand() / (f32)RAND_MAX );
-                    m_IdleDirection.z = -1.0f + 2.0f * ( (f32)rand() / (f32)RAND_MAX );
+                    m_IdleDirection.x = -1.0f + 2.0f * Random();
+                    m_IdleDirection.z = -1.0f + 2.0f * Random();
                     m_IdleDirection.Normalize();
                 }
                 else
@@ -194,7 +194,7 @@ void Chicken::UpdateIdle( f32 DeltaTime )
         m_State.SetState( STATE_FLOCK );
         
         // Set duration [0.0 to 1.0] second)
-        m_Duration = 1.0f * ( (f32)rand() / (f32)RAND_MAX );
+        m_Duration = 1.0f * Random();
 
         // Increase length of flocking as we get more panicked
         m_Duration += 2.0f * Base::Min( 1.0f, m_Fear / m_PanicLevel );
@@ -215,30 +215,19 @@ void Chicken::UpdateIdle( f32 DeltaTime )
 
     // Check if there is a panicked chicken in range
     AIScene* p_Scene = (AIScene*)GetSystemScene();
-    std::vector<AIObject*> p_Objects = p_Scene->GetObjects();
+    f32 Range = 1000.0f * m_Perception;
 
-    std::vector<AIObject*>::iterator it;
-    for( it = p_Objects.begin(); it != p_Objects.end(); it++ )
+    if( p_Scene->GetNeighbors().FindAny( this, m_Position, (u32)m_Type, Range * Range,
+            [] ( i32 State ) { return State == STATE_PANIC; } ) )
     {
-        Bot* p_Bot = (Bot*)*it;
-
-        if( p_Bot != this 
-         && p_Bot->m_Type == m_Type
-         && p_Bot->GetState() == STATE_PANIC )
-        {
-            f32 Distance = (p_Bot->m_Position - m_Position).Magnitude();
-            if( Distance < 1000.0f * m_Perception )
-            {
-                // A chicken near us is panicked, start flocking to follow it
-                m_State.SetState( STATE_FLOCK );
+        // A chicken near us is panicked, start flocking to follow it
+        m_State.SetState( STATE_FLOCK );
 
-                // Increase our current max speend
-                m_CurrentMaxSpeed = MAX_SPEED;
+        // Increase our current max speend
+        m_CurrentMaxSpeed = MAX_SPEED;
 
-                // Set duration [1.0 to 5.0] second)
-                m_Duration = 1.0f + ( 4.0f * ( (f32)rand() / (f32)RAND_MAX ) );
-            }
-        }
+        // Set duration [1.0 to 5.0] second)
+        m_Duration = 1.0f + ( 4.0f * Random() );
     }
 
     // Check if we should panic
@@ -278,7 +267,7 @@ void Chicken::UpdatePanic( void )
         m_State.SetState( STATE_FLOCK );
 
         // Set duration [2.0 to 5.0] second)
-        m_Duration = 2.0f + ( 3.0f * ( (f32)rand() / (f32)RAND_MAX ) );
+        m_Duration = 2.0f + ( 3.0f * Random() );
     }
 }
 
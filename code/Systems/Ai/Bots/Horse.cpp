@@ -106,8 +106,8 @@ void Horse::Update( f32 DeltaTime )
                 // Set our speed to walk
                 m_MaxSpeed = m_WalkSpeed;
 
-                // Set duration [5.0 to 60.0] second) - rand not thread safe?
-                m_Duration = 5.0f + 55.0f * ( (f32)rand() / (f32)RAND_MAX );
+                // Set duration [5.0 to 60.0] second)
+                m_Duration = 5.0f + 55.0f * Random();
             }
 
             UpdateIdle();
@@ -133,8 +133,8 @@ void Horse::Update( f32 DeltaTime )
                 //m_MaxSpeed = HalfSpeed + HalfSpeed * ( (f32)rand() / (f32)RAND_MAX );
                 m_MaxSpeed = m_RunSpeed;
                     
-                // Set duration [10.0 to 30.0] second) - rand not thread safe?
-                m_Duration = 10.0f + 20.0f * ( (f32)rand() / (f32)RAND_MAX );
+                // Set duration [10.0 to 30.0] second)
+                m_Duration = 10.0f + 20.0f * Random();
             }
 
             UpdateWander();
@@ -158,8 +158,8 @@ void Horse::Update( f32 DeltaTime )
                 // Set our speed to walk
                 m_MaxSpeed = m_RunSpeed;
 
-                // Set duration [5.0 to 10.0] second) - rand not thread safe?
-                m_Duration = 5.0f + 5.0f * ( (f32)rand() / (f32)RAND_MAX );
+                // Set duration [5.0 to 10.0] second)
+                m_Duration = 5.0f + 5.0f * Random();
             }
 
             UpdateFlocking();
@@ -246,28 +246,12 @@ void Horse::UpdateFear( f32 DeltaTime )
     Animal::UpdateFear( DeltaTime );
 
     // If we are not near another horse, than increase fear level
-    Bool NearHorse = False;
-
-    // Check if there is a horse in range
     AIScene* p_Scene = (AIScene*)GetSystemScene();
-    std::vector<AIObject*> p_Objects = p_Scene->GetObjects();
+    f32 Range = 1000.0f * m_Perception;
 
-    std::vector<AIObject*>::iterator it;
-    for( it = p_Objects.begin(); it != p_Objects.end(); it++ )
-    {
-        Bot* p_Bot = (Bot*)*it;
-
-        if( p_Bot != this && p_Bot->m_Type == m_Type )
-        {
-            f32 Distance = (p_Bot->m_Position - m_Position).Magnitude();
-            if( Distance < 1000.0f * m_Perception )
-            {
-                // A horse near us
-                NearHorse = True;
-                break;
-            }
-        }
-    }
+    // Check if there is a horse in range
+    Bool NearHorse = p_Scene->GetNeighbors().FindAny( this, m_Position, (u32)m_Type, Range * Range,
+        [] ( i32 State ) { UNREFERENCED_PARAM( State ); return true; } );
 
     // Increase fear if we are not near another horse
     if( !NearHorse )
@@ -285,7 +269,7 @@ void Horse::UpdateIdle( void )
     // Check if duration is up (change to flocking)
     if( m_State.GetTime() > m_Duration && m_Velocity.Magnitude() == 0.0f )
     {
-        if( rand() % 16 == 0 )
+        if( Random() < 1.0f / 16.0f )
         {
             m_State.SetState( STATE_WANDER );
         }
@@ -414,31 +398,11 @@ void Horse::UpdatePanic( void )
 // NearPanickedHorse - Returns true if we are near a panicked horse
 Bool Horse::NearPanickedHorse( void )
 {
-    Bool NearPanickedHorse = False;
-
     // Check if there is a panicked horse in range
     AIScene* p_Scene = (AIScene*)GetSystemScene();
-    std::vector<AIObject*> p_Objects = p_Scene->GetObjects();
-
-    std::vector<AIObject*>::iterator it;
-    for( it = p_Objects.begin(); it != p_Objects.end(); it++ )
-    {
-        Bot* p_Bot = (Bot*)*it;
-
-        if( p_Bot != this 
-         && p_Bot->m_Type == m_Type
-         && p_Bot->GetState() == STATE_PANIC )
-        {
-            f32 Distance = (p_Bot->m_Position - m_Position).Magnitude();
-            if( Distance < 1000.0f * m_Perception )
-            {
-                // A horse near us is panicked
-                NearPanickedHorse = True;
-                break;
-            }
-        }
-    }
+    f32 Range = 1000.0f * m_Perception;
 
-    return NearPanickedHorse;
+    return p_Scene->GetNeighbors().FindAny( this, m_Position, (u32)m_Type, Range * Range,
+        [] ( i32 State ) { return State == STATE_PANIC; } );
 }
 
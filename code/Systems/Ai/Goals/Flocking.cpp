@@ -20,9 +20,8 @@ Flocking::Flocking( Bot* pBot ) : Goal( pBot )
     m_SqrdRange *= m_SqrdRange;
     m_MinSqrdDistance *= m_MinSqrdDistance;
 
-
-    // Find flocking targets
-    FindTargets();
+    // The targets are found at each update
+    m_NumTargets = 0;
 }
 
 
@@ -47,39 +46,29 @@ void Flocking::Update( f32 DeltaTime )
 {
     ASSERT( m_Bot->m_Type == BotType::e_Animal || m_Bot->m_Type == BotType::e_Chicken || m_Bot->m_Type == BotType::e_Horse || m_Bot->m_Type == BotType::e_Swallow );
 
-    // Find all targets in range
-    u32 NumTargets = 0;
-    FlockingTarget* p_Targets[ MAX_FLOCKING_TARGETS ];
-    for( u32 Index = 0; Index < m_NumTargets; Index++ )
-    {
-        Base::Vector3 Diff = m_Targets[ Index ].m_pBot->m_Position - m_Bot->m_Position;
+    // Find the nearest targets, they keep moving
+    FindTargets();
 
-        // Determine the squared distance
-        f32 Distance = Diff.x * Diff.x + Diff.y * Diff.y + Diff.z * Diff.z;
+    // Follow the targets in front of us (or really close), the grid of the scene holds
+    // their positions and velocities at the start of the update
+    SpatialGrid::Steering Params;
+    Params.m_SqrdFollow = m_MinSqrdDistance * 4.0f;
+    Params.m_SqrdAvoid = m_MinSqrdDistance;
+    Params.m_AvoidAhead = False;
+    Params.m_AvoidScale = 2.0f;
 
-        // Add this as a target, if it's in range and in front of us (or it is really close)
-        if( Distance < m_SqrdRange 
-         && ( m_Bot->m_Facing.Dot( Diff ) > 0.0f || Distance < ( m_MinSqrdDistance * 4.0f ) ) )
-        {
-            ASSERT( NumTargets < MAX_FLOCKING_TARGETS );
-            p_Targets[ NumTargets ] = &m_Targets[ Index ];
-            NumTargets++;
-        }
-    }
+    const SpatialGrid& Grid = ( (AIScene*)m_Bot->GetSystemScene() )->GetNeighbors();
+    Base::Vector3 AvoidanceVector, Velocity, Center;
+    u32 NumTargets = Grid.Steer( m_Bot->m_Position, m_Bot->m_Facing, m_Targets, m_NumTargets, Params,
+                                 AvoidanceVector, Velocity, Center );
 
     if( NumTargets > 0 )
     {
-        // Target Avoidance
-        Base::Vector3 AvoidanceVector;
-        Avoidance( p_Targets, NumTargets, AvoidanceVector );
-
         // Velocity Matching
-        Base::Vector3 MatchingVector;
-        Matching( p_Targets, NumTargets, MatchingVector );
+        Base::Vector3 MatchingVector = ( Velocity * ( 1.0f / NumTargets ) - m_Bot->m_Velocity ) * 0.1f;
 
         // Flock Centering
-        Base::Vector3 CenterVector;
-        Centering( p_Targets, NumTargets, CenterVector );
+        Base::Vector3 CenterVector = ( Center * ( 1.0f / NumTargets ) - m_Bot->m_Position ) * 0.1f;
 
         // Determine the new direction
         Base::Vector3 Direction = AvoidanceVector + MatchingVector + CenterVector;
@@ -125,97 +114,16 @@ void Flocking::PostUpdate( f32 DeltaTime )
 }
 
 
-///////////////////////////////////////////////////////////////////////////////
-// Avoidance - Determine target avoidance vector
-void Flocking::Avoidance( FlockingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result )
-{
-    Result = Base::Vector3::Zero;
-
-    // Determine if we are too close to any other targets
-    for( u32 Index = 0; Index < NumTargets; Index++ )
-    {
-        Base::Vector3 Diff = p_Targets[ Index ]->m_pBot->m_Position - m_Bot->m_Position;
-
-        // Determine the squared distance
-        f32 Distance = Diff.x * Diff.x + Diff.y * Diff.y + Diff.z * Diff.z;
-
-        if( Distance < m_MinSqrdDistance )
-        {
-            // Push away from this target to avoid colliding
-            Result = ( Result - Diff ) * 2.0f;
-        }
-    }
-}
-
-
-///////////////////////////////////////////////////////////////////////////////
-// Matching - Determine velocity matching vector
-void Flocking::Matching( FlockingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result )
-{
-    // Determine the avaerage velocity of all the targets
-    Base::Vector3 Velocity = Base::Vector3::Zero;
-    for( u32 Index = 0; Index < NumTargets; Index++ )
-    {
-        Velocity += p_Targets[ Index ]->m_pBot->m_Velocity;
-    }
-
-    Velocity = Velocity * ( 1.0f / NumTargets );
-
-    // Determine matching vector
-    Result = (Velocity - m_Bot->m_Velocity) * 0.1f;
-}
-
-
-///////////////////////////////////////////////////////////////////////////////
-// Centering - Determine centering vector
-void Flocking::Centering( FlockingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result )
-{
-    // Determine the center of all the targets
-    Base::Vector3 Center = Base::Vector3::Zero;
-    for( u32 Index = 0; Index < NumTargets; Index++ )
-    {
-        Center += p_Targets[ Index ]->m_pBot->m_Position;
-    }
-
-    Center = Center * ( 1.0f / NumTargets );
-
-    // Determine centering vector
-    Result = ( Center - m_Bot->m_Position ) * 0.1f;
-}
-
-
 ///////////////////////////////////////////////////////////////////////////////
 // FindTargets - Find suitable flocking targets
 void Flocking::FindTargets( void )
 {
-    // Reset the flocking target list
-    m_NumTargets = 0;
-
-    // Get object list for this scene
+    // Take the nearest bots of our kind in range, the grid of the scene holds their
+    // positions at the start of the update
     AIScene* p_Scene = (AIScene*)m_Bot->GetSystemScene();
-    std::vector<AIObject*> p_Objects = p_Scene->GetObjects();
+    u32 MaxTargets = MIN( p_Scene->GetNeighborCount(), (u32)MAX_FLOCKING_TARGETS );
 
-    // Loop through each Object and find targets
-    std::vector<AIObject*>::iterator it;
-    for( it = p_Objects.begin(); it != p_Objects.end(); it++ )
-    {
-        Bot* p_Bot = (Bot*)*it;
-        if( m_Bot != p_Bot )
-        {
-            // See is this is a similar bot
-            // TODO - sort by distance
-            if( m_Bot->m_Type == p_Bot->m_Type )
-            {
-                m_Targets[ m_NumTargets ].m_pBot = p_Bot;
-                m_NumTargets++;
-            }
-
-            // Check if we've maxed out the number of flocking targets
-            if( m_NumTargets == MAX_FLOCKING_TARGETS )
-            {
-                break;
-            }
-        }
-    }
+    m_NumTargets = p_Scene->GetNeighbors().FindNearest(
+        m_Bot, m_Bot->m_Position, (u32)m_Bot->m_Type, m_SqrdRange, MaxTargets, m_Targets );
 }
 
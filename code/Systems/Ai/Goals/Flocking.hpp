@@ -5,11 +5,6 @@
 
 #define MAX_FLOCKING_TARGETS 256
 
-struct FlockingTarget
-{
-    Bot* m_pBot;
-};
-
 
 ///////////////////////////////////////////////////////////////////////////////
 /// <summary>
@@ -57,36 +52,12 @@ public:
     virtual void PostUpdate( f32 DeltaTime );
 
 protected:
-    /// <summary cref="Flocking::Avoidance">
-    /// Determines the best vector to avoid all p_Targets.
-    /// </summary>
-    /// <param name="p_Targets">An array of target that should be avoided.</param>
-    /// <param name="NumTargets">The number of targets in p_Targets.</param>
-    /// <param name="Result">This vector will be filled in with the result.</param>
-    void Avoidance( FlockingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result );
-
-    /// <summary cref="Flocking::Matching">
-    /// Determines the best vector to match the heading of all p_Targets.
-    /// </summary>
-    /// <param name="p_Targets">An array of target that should be followed.</param>
-    /// <param name="NumTargets">The number of targets in p_Targets.</param>
-    /// <param name="Result">This vector will be filled in with the result.</param>
-    void Matching( FlockingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result );
-
-    /// <summary cref="Flocking::Centering">
-    /// Determines the best vector to get to the center of all p_Targets.
-    /// </summary>
-    /// <param name="p_Targets">An array of target that should be centered upon</param>
-    /// <param name="NumTargets">The number of targets in p_Targets.</param>
-    /// <param name="Result">This vector will be filled in with the result.</param>
-    void Centering( FlockingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result );
-
     /// <summary cref="Flocking::FindTargets">
-    /// Find suitable flocking targets (other AI's we should flock with).
+    /// Find the nearest bots of the same type in range to flock with.
     /// </summary>
     void FindTargets( void );
 
-    FlockingTarget m_Targets[ MAX_FLOCKING_TARGETS ];  // All possible targets
+    u32            m_Targets[ MAX_FLOCKING_TARGETS ];  // Grid slots of all possible targets
     u32            m_NumTargets;                       // Number of possible targets
     f32            m_SqrdRange;                        // Perception range (squared)
     f32            m_MinSqrdDistance;                  // Desired min distance (squared) from targets
@@ -1,6 +1,7 @@
 //internal
 #include "Base/Compat.hpp"
 #include "Base/Platform.hpp"
+#include <cfloat>
 #include "Interfaces/Interface.hpp"
 #include "Systems/Ai/Scene.hpp"
 #include "Systems/Ai/Bots/Animal.hpp"
@@ -16,8 +17,8 @@ Herding::Herding( Bot* pBot ) : Goal( pBot )
     m_Range = 1000.0f + 1000.0f * pBot->m_Perception;
     m_MinDistance = pBot->m_Radius + ( pBot->m_Radius * 0.1f * pBot->m_Perception );
 
-    // Find herding targets
-    FindTargets();
+    // The targets are found at each update
+    m_NumTargets = 0;
 }
 
 
@@ -42,38 +43,29 @@ void Herding::Update( f32 DeltaTime )
 {
     ASSERT( m_Bot->m_Type == BotType::e_Animal || m_Bot->m_Type == BotType::e_Chicken || m_Bot->m_Type == BotType::e_Horse || m_Bot->m_Type == BotType::e_Swallow );
 
-    // Find all targets in range
-    u32 NumTargets = 0;
-    HerdingTarget* p_Targets[ MAX_HERDING_TARGETS ];
-    for( u32 Index = 0; Index < m_NumTargets; Index++ )
-    {
-        // If this target is visiable
-        if( m_Targets[ Index ].m_Visible )
-        {
-            Base::Vector3 Diff = m_Targets[ Index ].m_pBot->m_Position - m_Bot->m_Position;
-
-            // Add this as a target if it's in range
-            if( Diff.Magnitude() < m_Range )
-            {
-                p_Targets[ NumTargets ] = &m_Targets[ Index ];
-                NumTargets++;
-            }
-        }
-    }
+    // Find the nearest targets, they keep moving
+    FindTargets();
+
+    // Herd with all the targets, the grid of the scene holds their positions and velocities
+    // at the start of the update
+    SpatialGrid::Steering Params;
+    Params.m_SqrdFollow = FLT_MAX;
+    Params.m_SqrdAvoid = m_MinDistance * m_MinDistance;
+    Params.m_AvoidAhead = True;
+    Params.m_AvoidScale = 0.25f;
+
+    const SpatialGrid& Grid = ( (AIScene*)m_Bot->GetSystemScene() )->GetNeighbors();
+    Base::Vector3 AvoidanceVector, Velocity, Center;
+    u32 NumTargets = Grid.Steer( m_Bot->m_Position, m_Bot->m_Facing, m_Targets, m_NumTargets, Params,
+                                 AvoidanceVector, Velocity, Center );
 
     if( NumTargets > 0 )
     {
-        // Target Avoidance
-        Base::Vector3 AvoidanceVector;
-        Avoidance( p_Targets, NumTargets, AvoidanceVector );
-
         // Velocity Matching
-        Base::Vector3 MatchingVector;
-        Matching( p_Targets, NumTargets, MatchingVector );
+        Base::Vector3 MatchingVector = ( Velocity * ( 1.0f / NumTargets ) - m_Bot->m_Velocity ) * 0.5f;
 
         // Flock Centering
-        Base::Vector3 CenterVector;
-        Centering( p_Targets, NumTargets, CenterVector );
+        Base::Vector3 CenterVector = ( Center * ( 1.0f / NumTargets ) - m_Bot->m_Position ) * 0.05f;
 
         // Determine the new direction
         Base::Vector3 Direction = AvoidanceVector + MatchingVector + CenterVector;
@@ -105,95 +97,16 @@ void Herding::PostUpdate( f32 DeltaTime )
 }
 
 
-///////////////////////////////////////////////////////////////////////////////
-// Avoidance - Determine target avoidance vector
-void Herding::Avoidance( HerdingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result )
-{
-    Result = Base::Vector3::Zero;
-
-    // Determine if we are too close to any other targets
-    for( u32 Index = 0; Index < NumTargets; Index++ )
-    {
-        Base::Vector3 Diff = p_Targets[ Index ]->m_pBot->m_Position - m_Bot->m_Position;
-
-        if( Diff.Magnitude() < m_MinDistance && m_Bot->m_Facing.Dot( Diff ) > 0.0f )
-        {
-            // Push away from this target to avoid colliding
-            Result = ( Result - Diff ) * 0.25f;
-        }
-    }
-}
-
-
-///////////////////////////////////////////////////////////////////////////////
-// Matching - Determine velocity matching vector
-void Herding::Matching( HerdingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result )
-{
-    // Determine the avaerage velocity of all the targets
-    Base::Vector3 Velocity = Base::Vector3::Zero;
-    for( u32 Index = 0; Index < NumTargets; Index++ )
-    {
-        Velocity += p_Targets[ Index ]->m_pBot->m_Velocity;
-    }
-
-    Velocity = Velocity * ( 1.0f / NumTargets );
-
-    // Determine matching vector
-    Result = (Velocity - m_Bot->m_Velocity) * 0.5f;
-}
-
-
-///////////////////////////////////////////////////////////////////////////////
-// Centering - Determine centering vector
-void Herding::Centering( HerdingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result )
-{
-    // Determine the center of all the targets
-    Base::Vector3 Center = Base::Vector3::Zero;
-    for( u32 Index = 0; Index < NumTargets; Index++ )
-    {
-        Center += p_Targets[ Index ]->m_pBot->m_Position;
-    }
-
-    Center = Center * ( 1.0f / NumTargets );
-
-    // Determine centering vector
-    Result = ( Center - m_Bot->m_Position ) * 0.05f;
-}
-
-
 ///////////////////////////////////////////////////////////////////////////////
 // FindTargets - Find suitable herding targets
 void Herding::FindTargets( void )
 {
-    // Reset the herding target list
-    m_NumTargets = 0;
-
-    // Get object list for this scene
+    // Take the nearest bots of our kind in range, the grid of the scene holds their
+    // positions at the start of the update
     AIScene* p_Scene = (AIScene*)m_Bot->GetSystemScene();
-    std::vector<AIObject*> p_Objects = p_Scene->GetObjects();
+    u32 MaxTargets = MIN( p_Scene->GetNeighborCount(), (u32)MAX_HERDING_TARGETS );
 
-    // Loop through each Object and find targets
-    std::vector<AIObject*>::iterator it;
-    for( it = p_Objects.begin(); it != p_Objects.end(); it++ )
-    {
-        Bot* p_Bot = (Bot*)*it;
-        if( m_Bot != p_Bot )
-        {
-            // See is this is a similar bot
-            // TODO - sort by distance
-            if( m_Bot->m_Type == p_Bot->m_Type )
-            {
-                m_Targets[ m_NumTargets ].m_pBot = p_Bot;
-                m_Targets[ m_NumTargets ].m_Visible = True;
-                m_NumTargets++;
-            }
-
-            // Check if we've maxed out the number of herding targets
-            if( m_NumTargets == MAX_HERDING_TARGETS )
-            {
-                break;
-            }
-        }
-    }
+    m_NumTargets = p_Scene->GetNeighbors().FindNearest(
+        m_Bot, m_Bot->m_Position, (u32)m_Bot->m_Type, m_Range * m_Range, MaxTargets, m_Targets );
 }
 
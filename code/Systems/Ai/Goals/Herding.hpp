@@ -5,13 +5,6 @@
 
 #define MAX_HERDING_TARGETS 256
 
-struct HerdingTarget
-{
-    Bot*         m_pBot;
-    Bool         m_Visible;
-};
-
-
 ///////////////////////////////////////////////////////////////////////////////
 /// <summary>
 ///   <c>Herding</c> Implementation of a herding goal.  This goal mimics
@@ -58,36 +51,12 @@ public:
     virtual void PostUpdate( f32 DeltaTime );
 
 protected: 
-    /// <summary cref="Herding::Avoidance">
-    /// Determines the best vector to avoid all p_Targets.
-    /// </summary>
-    /// <param name="p_Targets">An array of target that should be avoided.</param>
-    /// <param name="NumTargets">The number of targets in p_Targets.</param>
-    /// <param name="Result">This vector will be filled in with the result.</param>
-    void Avoidance( HerdingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result );
-
-    /// <summary cref="Herding::Matching">
-    /// Determines the best vector to match the heading of all p_Targets.
-    /// </summary>
-    /// <param name="p_Targets">An array of target that should be followed.</param>
-    /// <param name="NumTargets">The number of targets in p_Targets.</param>
-    /// <param name="Result">This vector will be filled in with the result.</param>
-    void Matching( HerdingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result );
-
-    /// <summary cref="Herding::Centering">
-    /// Determines the best vector to get to the center of all p_Targets.
-    /// </summary>
-    /// <param name="p_Targets">An array of target that should be centered upon</param>
-    /// <param name="NumTargets">The number of targets in p_Targets.</param>
-    /// <param name="Result">This vector will be filled in with the result.</param>
-    void Centering( HerdingTarget** p_Targets, u32 NumTargets, Base::Vector3& Result );  // Determine centering vector
-
     /// <summary cref="Herding::FindTargets">
-    /// Find suitable herding targets (other AI's we should herd with).
+    /// Find the nearest bots of the same type in range to herd with.
     /// </summary>
     void FindTargets( void );
 
-    HerdingTarget m_Targets[ MAX_HERDING_TARGETS ];  // All possible targets
+    u32           m_Targets[ MAX_HERDING_TARGETS ];  // Grid slots of all possible targets
     u32           m_NumTargets;                      // Number of possible targets
     f32           m_Range;                           // Perception range
     f32           m_MinDistance;                     // Desired min distance from targets
@@ -48,7 +48,6 @@ public:
 
 protected:
     Base::Vector3 m_TargetPosition;
-    Collision::Handle  m_CollHandle;
     Bool          m_Finished;  // Goal has completed
 };
 
@@ -17,10 +17,8 @@
 #include "Base/Platform.hpp"
 // Interface
 #include "Interfaces/Interface.hpp"
-// Standard Library
-#include <mutex>
 // System
-#include "Systems/Common/POI.hpp"
+#include "Systems/Common/POIStore.hpp"
 #include "Systems/Ai/Bots/Animal.hpp"
 #include "Systems/Ai/Bots/Bot.hpp"
 #include "Systems/Ai/Bots/Chicken.hpp"
@@ -40,7 +38,7 @@ u32 JobsComplete( void* pScene );
 
 ///////////////////////////////////////////////////////////////////////////////
 // AIScene - Constructor
-AIScene::AIScene( ISystem* pSystem ) : ISystemScene( pSystem ), m_pAITask( nullptr ), m_bParallelize(True)
+AIScene::AIScene( ISystem* pSystem ) : ISystemScene( pSystem ), m_pAITask( nullptr ), m_bParallelize(True), m_hGrainSize( nullptr ), m_hCellSize( nullptr ), m_hNeighbors( nullptr ), m_NeighborCount( 16 ), m_ProbeBatch( Collision::InvalidHandle )
 {
 }
 
@@ -54,19 +52,11 @@ AIScene::~AIScene( void )
     // Free all the remaining objects.
     for( std::vector<AIObject*>::iterator it = m_Objects.begin(); it != m_Objects.end(); it++ )
     {
-        delete *it;
+        Base::DestroyPooled<ISystemObject>( *it );
     }
 
     m_Objects.clear();
-
-
-    // Free all the remaining POI.
-    for( std::list<POI*>::iterator it = m_POI.begin(); it != m_POI.end(); it++ )
-    {
-        delete *it;
-    }
-
-    m_POI.clear();
+    m_Bots.clear();
 }
 
 
@@ -88,6 +78,15 @@ Error AIScene::Initialize( std::vector<Properties::Property> Properties )
     m_bParallelize = g_Managers.pTask != NULL && 
         g_Managers.pEnvironment->Variables().GetAsBool( "AI::Parallel", True );
 
+    // A lower bound for the pieces ParallelFor splits the objects into, read every update
+    // so it can be tuned while running
+    m_hGrainSize = g_Managers.pEnvironment->Variables().GetHandle( "AI::GrainSize" );
+
+    // Edge length of the cells of the neighbour grid and how many of the nearest bots of
+    // their kind the flocking and herding bots follow
+    m_hCellSize = g_Managers.pEnvironment->Variables().GetHandle( "AI::CellSize" );
+    m_hNeighbors = g_Managers.pEnvironment->Variables().GetHandle( "AI::Neighbors" );
+
     // Create a new AITask
     m_pAITask = new AITask( this );
     ASSERT( m_pAITask != NULL );
@@ -135,35 +134,36 @@ ISystemObject* AIScene::CreateObject( pcstr pszName, pcstr pszType )
 
     // Create the AI object
     AIObject* pObject = NULL;
+    Bot* pBot = NULL;
     if( strcmp( pszType, "Bot" ) == 0 )
     {
-        pObject = (AIObject*)new Bot( this, pszName );
+        pObject = pBot = new( m_BotPool.Allocate() ) Bot( this, pszName );
     }
     else if( strcmp( pszType, "Animal" ) == 0 )
     {
-        pObject = (AIObject*)new Animal( this, pszName );
+        pObject = pBot = new( m_AnimalPool.Allocate() ) Animal( this, pszName );
     }
     else if( strcmp( pszType, "Chicken" ) == 0 )
     {
-        pObject = (AIObject*)new Chicken( this, pszName );
+        pObject = pBot = new( m_ChickenPool.Allocate() ) Chicken( this, pszName );
     }
     else if( strcmp( pszType, "Horse" ) == 0 )
     {
-        pObject = (AIObject*)new Horse( this, pszName );
+        pObject = pBot = new( m_HorsePool.Allocate() ) Horse( this, pszName );
     }
     else if( strcmp( pszType, "Swallow" ) == 0 )
     {
-        pObject = (AIObject*)new Swallow( this, pszName );
+        pObject = pBot = new( m_SwallowPool.Allocate() ) Swallow( this, pszName );
     }
     else if( strcmp( pszType, "CamBot" ) == 0 )
     {
-        pObject = (AIObject*)new CamBot( this, pszName );
+        pObject = new( m_CamBotPool.Allocate() ) CamBot( this, pszName );
     }
     else
     {
         // Create a default AI object (this is probably an error, so assert)
         ASSERT( false );
-        pObject = new AIObject( this, pszName );
+        pObject = new( m_ObjectPool.Allocate() ) AIObject( this, pszName );
     }
 
     if( pObject != NULL )
@@ -171,10 +171,25 @@ ISystemObject* AIScene::CreateObject( pcstr pszName, pcstr pszType )
         m_Objects.push_back( pObject );
     }
 
+    if( pBot != NULL )
+    {
+        m_Bots.push_back( pBot );
+    }
+
     return pObject;
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// IsObjectInitializeThreadSafe - Objects of all types can be initialized concurrently
+Bool AIScene::IsObjectInitializeThreadSafe( pcstr pszType )
+{
+    UNREFERENCED_PARAM( pszType );
+
+    return True;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // DestroyObject - Destorys the given Object, removing it from the Scene
 Error AIScene::DestroyObject( ISystemObject* pSystemObject )
@@ -185,7 +200,7 @@ Error AIScene::DestroyObject( ISystemObject* pSystemObject )
     // Cast to a AIObject so that the correct destructor will be called.
     AIObject* pObject = reinterpret_cast<AIObject*>(pSystemObject);
 
-    // Remove the object from the list and delete it
+    // Remove the object from the list and return it to its pool
     u32 index = 0;
     for( std::vector<AIObject*>::iterator it=m_Objects.begin(); it != m_Objects.end(); it++ )
     {
@@ -197,7 +212,16 @@ Error AIScene::DestroyObject( ISystemObject* pSystemObject )
         index++;
     }
 
-    SAFE_DELETE( pSystemObject );
+    for( std::vector<Bot*>::iterator it = m_Bots.begin(); it != m_Bots.end(); it++ )
+    {
+        if( static_cast<AIObject*>( *it ) == pObject )
+        {
+            m_Bots.erase( it );
+            break;
+        }
+    }
+
+    Base::DestroyPooled( pSystemObject );
 
     return Errors::Success;
 }
@@ -237,35 +261,8 @@ Error AIScene::ChangeOccurred( ISubject* pSubject, System::Changes::BitMask Chan
 
         // Store this area so objects can process them later
         // (assuming all areas are fire)
-        pcstr AreaName = pAreaObject->GetAreaName();
-
-        POIFire* pFire = NULL;
-
-        // Check if we already have a fire with the same name
-        m_mutex.lock();
-        for( std::list<POI*>::iterator it = m_POI.begin(); it != m_POI.end(); it++ )
-        {
-            POI* pPOI = *it;
-            if( pPOI->GetType() == POIType::e_POI_Fire )
-            {
-                POIFire* pTestFire = (POIFire*)pPOI;
-                if( strcmp( pTestFire->GetName().c_str(), AreaName ) == 0 )
-                {
-                    pFire = pTestFire;
-                    break;
-                }
-            }
-        }
-
-        // If we didn't find an exisiting fire POI, create a new one
-        if( !pFire )
-        {
-            pFire = new POIFire();
-            m_POI.push_back( pFire );
-
-            pFire->SetName( AreaName );
-        }
-        m_mutex.unlock();
+        // (a new fire POI is created the first time the name comes up)
+        POIFire* pFire = m_POI.GetFire( pAreaObject->GetAreaName() );
 
         // Set data
         Base::Vector3 Min, Max;
@@ -282,13 +279,13 @@ Error AIScene::ChangeOccurred( ISubject* pSubject, System::Changes::BitMask Chan
 
         const IContactObject::Info* pContactInfo = pContactObject->GetContact();
 
-        // Store the contact points so objects can process them later
-        POIContact* pContact = new POIContact();
-        pContact->SetPosition( pContactInfo->m_Position );
-        pContact->SetImpact( pContactInfo->m_Impact );
-
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_POI.push_back( pContact );
+        // Store the contact points so objects can process them during the next update
+        POIContact* pContact = m_POI.AddContact();
+        if( pContact != NULL )
+        {
+            pContact->SetPosition( pContactInfo->m_Position );
+            pContact->SetImpact( pContactInfo->m_Impact );
+        }
     }
 
     return Errors::Success;
@@ -322,15 +319,28 @@ void AIScene::ProcessRange ( u32 begin, u32 end )
 // Update - Main Update for the AI Scene
 void AIScene::Update(f32 fDeltaTime)
 {
-    static const u32 GrainSize = 80;
+    u32 GrainSize = (u32)std::max( g_Managers.pEnvironment->Variables().GetAsInt( m_hGrainSize, 1 ), 1 );
 
     m_fDeltaTime = fDeltaTime;
 
+    // Let the objects see the contacts which came in since the last update
+    m_POI.Publish();
+
+    // Hand the bots the ray tests which finished since the last update
+    FinalizeProbes();
+
+    // Publish the bots as they are before any of them moves, while updating they read each
+    // other from this snapshot only and write just their own state
+    f32 CellSize = g_Managers.pEnvironment->Variables().GetAsFloat( m_hCellSize, 250.0f );
+    m_NeighborCount = (u32)std::min( std::max( g_Managers.pEnvironment->Variables().GetAsInt( m_hNeighbors, 16 ), 1 ),
+                                     (i32)SpatialGrid::MaxNeighbors );
+    m_Neighbors.Build( m_Bots, std::max( CellSize, 1.0f ), m_bParallelize ? m_pAITask : NULL );
+
     u32 uSize = (u32)m_Objects.size();
 
     if( m_bParallelize
      && g_Managers.pTask != NULL
-     && GrainSize < uSize )
+     && 1 < uSize )
     {
         g_Managers.pTask->ParallelFor( m_pAITask, UpdateCallback, this, 0, uSize, GrainSize );
     }
@@ -338,26 +348,75 @@ void AIScene::Update(f32 fDeltaTime)
     {
         ProcessRange( 0, (u32)m_Objects.size() );
     }
+
+    // Request the ray tests for the next update
+    SubmitProbes();
+
     PostUpdate();
 }
 
+
 ///////////////////////////////////////////////////////////////////////////////
-// PostUpdate - PostUpdate processing
-void AIScene::PostUpdate( void )
+// FinalizeProbes - Give the bots the results of their last ray tests
+void AIScene::FinalizeProbes( void )
 {
-    // Loop through and remove and expired POI
-    std::list<POI*>::iterator it = m_POI.begin();
-    while( it != m_POI.end() )
+    if( m_ProbeBatch == Collision::InvalidHandle
+     || !g_Managers.pService->HasCollisionProvider()
+     || !g_Managers.pService->Collision().FinalizeBatch( m_ProbeBatch, m_Probes, m_ProbeResults ) )
     {
-        POI* pPOI = *it;
-        if( pPOI->Expired() )
+        return;
+    }
+
+    // The tests can be a few updates old, the name of the bot tells if the index in
+    // the handle still belongs to the same bot
+    u32 uBots = (u32)m_Bots.size();
+    u32 uProbes = (u32)std::min( m_Probes.size(), m_ProbeResults.size() );
+
+    for( u32 i = 0; i < uProbes; i++ )
+    {
+        const Collision::Request& Probe = m_Probes[ i ];
+        u32 Index = Probe.m_Handle / Bot::e_ProbeTypes;
+
+        if( Index < uBots && m_Bots[ Index ]->GetNameId() == Probe.m_Ignore )
         {
-            it = m_POI.erase( it );
-            delete pPOI;
+            m_Bots[ Index ]->SetProbeResult( Probe, m_ProbeResults[ i ] );
         }
-        else
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SubmitProbes - Request the ray tests of all the bots as one batch
+void AIScene::SubmitProbes( void )
+{
+    // Without a collision provider the bots go without ground and obstacles
+    if( !g_Managers.pService->HasCollisionProvider() || m_Bots.empty() )
+    {
+        return;
+    }
+
+    u32 uBots = (u32)m_Bots.size();
+    m_Probes.resize( uBots * Bot::e_ProbeTypes );
+
+    u32 uProbes = 0;
+    for( u32 i = 0; i < uBots; i++ )
+    {
+        u32 Count = m_Bots[ i ]->GetProbes( &m_Probes[ uProbes ] );
+
+        for( u32 j = uProbes; j < uProbes + Count; j++ )
         {
-            it++;
+            m_Probes[ j ].m_Handle += i * Bot::e_ProbeTypes;
         }
+        uProbes += Count;
     }
+    m_Probes.resize( uProbes );
+
+    m_ProbeBatch = g_Managers.pService->Collision().SubmitBatch( m_ProbeBatch, m_Probes );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PostUpdate - PostUpdate processing
+void AIScene::PostUpdate( void )
+{
+    // Nothing to remove, the contacts are dropped when the next ones are published
 }
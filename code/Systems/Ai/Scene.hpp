@@ -14,15 +14,20 @@
 
 #pragma once
 
-// Standard Library
-#include <mutex>
 // System
-#include "Systems/Common/POI.hpp"
+#include "Systems/Common/POIStore.hpp"
+#include "Systems/Ai/SpatialGrid.hpp"
 
 
 class AISystem;
 class AITask;
 class AIObject;
+class Animal;
+class Bot;
+class CamBot;
+class Chicken;
+class Horse;
+class Swallow;
 
 
 
@@ -48,8 +53,6 @@ class AIScene : public ISystemScene
     friend class AITask;
 
 public:
-    typedef std::list<POI*> PoiList;
-
     /// <summary cref="AIObject::GetObjects">
     ///   Returns all AI objects in the AI scene.
     /// </summary>
@@ -58,11 +61,23 @@ public:
     inline std::vector<AIObject*> GetObjects( void ) { return m_Objects; }
 
     /// <summary cref="AIObject::GetPOI">
-    ///   Returns all POI (Point of Interest) in the AI scene.
+    ///   Returns the POI (Point of Interest) in the AI scene.
     /// </summary>
-    /// <returns>std::list - List of POI.</returns>
+    /// <returns>POIStore - Store of the POI published for this update.</returns>
     /// <seealso cref="POI"/>
-    inline PoiList GetPOI( void ) { return m_POI; }
+    inline const POIStore& GetPOI( void ) { return m_POI; }
+
+    /// <summary cref="AIScene::GetNeighbors">
+    ///   Returns the grid of the bot positions, rebuilt at the start of each update.
+    /// </summary>
+    /// <returns>SpatialGrid - Grid to find the nearest bots in.</returns>
+    inline const SpatialGrid& GetNeighbors( void ) { return m_Neighbors; }
+
+    /// <summary cref="AIScene::GetNeighborCount">
+    ///   Returns how many of the nearest bots a bot follows when flocking or herding.
+    /// </summary>
+    /// <returns>u32 - Number of neighbours.</returns>
+    inline u32 GetNeighborCount( void ) { return m_NeighborCount; }
 
     /// <summary cref="AIScene::PostUpdate">
     /// This method is called after each <c>Update</c> call to perform post-processing.
@@ -131,6 +146,15 @@ protected:
     /// <seealso cref="ISystemScene::CreateObject"/>
     virtual ISystemObject* CreateObject( pcstr pszName, pcstr pszType );
 
+    /// <summary cref="AIScene::IsObjectInitializeThreadSafe">
+    ///   Implementation of the <c>ISystemScene::IsObjectInitializeThreadSafe</c> function.
+    ///   AI objects only read their properties when initialized.
+    /// </summary>
+    /// <param name="pszType">The object type.</param>
+    /// <returns>Bool - True for all the AI object types.</returns>
+    /// <seealso cref="ISystemScene::IsObjectInitializeThreadSafe"/>
+    virtual Bool IsObjectInitializeThreadSafe( pcstr pszType );
+
     /// <summary cref="AIScene::DestroyObject">
     ///   Implementation of the <c>ISystemScene::DestroyObject</c> function.
     ///   Destroys a system object.
@@ -181,16 +205,34 @@ protected:
 
     AITask*                 m_pAITask;                       // Main task for this scen
     std::vector<AIObject*>  m_Objects;                       // Scene objects
-    std::list<POI*>         m_POI;                           // Scene points of interest
+    std::vector<Bot*>       m_Bots;                          // Scene objects which are bots
+    SpatialGrid             m_Neighbors;                     // Bot positions at the start of the update
+    POIStore                m_POI;                           // Scene points of interest
+
+    // Memory of the objects, one pool per class
+    Base::ObjectPool<Bot>       m_BotPool;
+    Base::ObjectPool<Animal>    m_AnimalPool;
+    Base::ObjectPool<Chicken>   m_ChickenPool;
+    Base::ObjectPool<Horse>     m_HorsePool;
+    Base::ObjectPool<Swallow>   m_SwallowPool;
+    Base::ObjectPool<CamBot>    m_CamBotPool;
+    Base::ObjectPool<AIObject>  m_ObjectPool;
     u32                     m_SubTasks;                      // Number of desired sub tasks
     ProcessData             m_ProcessData[ MAX_SUB_TASKS ];  // Data used by sub tasks
 
     Bool                    m_bParallelize;
+    IEnvironment::IVariables::VariableHandle m_hGrainSize;
+    IEnvironment::IVariables::VariableHandle m_hCellSize;
+    IEnvironment::IVariables::VariableHandle m_hNeighbors;
+    u32                     m_NeighborCount;                 // Neighbours a bot follows
+    Collision::Handle       m_ProbeBatch;                    // Batch of the ray tests of the bots
+    std::vector<Collision::Request> m_Probes;                // Ray tests of the bots
+    std::vector<Collision::Result>  m_ProbeResults;          // Results of the ray tests
     f32                     m_fDeltaTime;
 
     static void UpdateCallback( void *param, u32 begin, u32 end );
     void ProcessRange ( u32 begin, u32 end );
-
-    std::mutex m_mutex;
+    void FinalizeProbes( void );
+    void SubmitProbes( void );
 };
 
@@ -0,0 +1,483 @@
+// Copyright © 2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+// Base
+#include "Base/Compat.hpp"
+#include "Base/Platform.hpp"
+#include "Base/Intrinsics.hpp"
+// Interface
+#include "Interfaces/Interface.hpp"
+// Standard Library
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+// System
+#include "Systems/Ai/Bots/Bot.hpp"
+#include "Systems/Ai/SpatialGrid.hpp"
+
+#if defined(PLATFORM_ARCH_X86) || defined(PLATFORM_ARCH_X86_64)
+#   include "Base/Math/SSE/SSE.hpp"
+#   define USE_SSE_KERNELS
+#endif
+
+
+extern ManagerInterfaces   g_Managers;
+
+// Entries are padded to a multiple of this
+static const u32 Lanes = 4;
+
+// The most bots in range a search collects before it drops the farther ones
+static const u32 MaxCandidates = 4 * SpatialGrid::MaxNeighbors;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpatialGrid - Constructor
+SpatialGrid::SpatialGrid( void )
+    : m_pSource( NULL )
+    , m_Types( 0 )
+    , m_Columns( 0 )
+    , m_Rows( 0 )
+    , m_OriginX( 0.0f )
+    , m_OriginZ( 0.0f )
+    , m_CellSize( 1.0f )
+    , m_InvCellSize( 1.0f )
+{
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ~SpatialGrid - Destructor
+SpatialGrid::~SpatialGrid( void )
+{
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Build - Rebuild the grid from the positions of the bots
+void SpatialGrid::Build( const std::vector<Bot*>& Bots, f32 CellSize, ISystemTask* pSystemTask )
+{
+    u32 Count = (u32)Bots.size();
+
+    m_Bots.clear();
+    m_Types = 0;
+    if( Count == 0 )
+    {
+        return;
+    }
+
+    // Cover the bots
+    f32 MinX = Bots[ 0 ]->m_Position.x, MaxX = MinX;
+    f32 MinZ = Bots[ 0 ]->m_Position.z, MaxZ = MinZ;
+    for( u32 i = 0; i < Count; i++ )
+    {
+        const Base::Vector3& Position = Bots[ i ]->m_Position;
+        MinX = Base::Min( MinX, Position.x );
+        MaxX = Base::Max( MaxX, Position.x );
+        MinZ = Base::Min( MinZ, Position.z );
+        MaxZ = Base::Max( MaxZ, Position.z );
+        m_Types = std::max( m_Types, (u32)Bots[ i ]->m_Type + 1 );
+    }
+
+    // Keep the cells in proportion to the bots
+    f32 MaxCells = (f32)std::max( 4 * Count, 64u );
+    f32 Cells = ( ( MaxX - MinX ) / CellSize + 1.0f ) * ( ( MaxZ - MinZ ) / CellSize + 1.0f );
+    if( Cells > MaxCells )
+    {
+        CellSize *= sqrtf( Cells / MaxCells );
+    }
+
+    m_CellSize = CellSize;
+    m_InvCellSize = 1.0f / CellSize;
+    m_OriginX = MinX;
+    m_OriginZ = MinZ;
+    m_Columns = GetColumn( MaxX ) + 1;
+    m_Rows = GetRow( MaxZ ) + 1;
+
+    // Find the cell of each bot
+    m_pSource = &Bots;
+    m_Keys.resize( Count );
+    if( pSystemTask != NULL && g_Managers.pTask != NULL && 1 < Count )
+    {
+        g_Managers.pTask->ParallelFor( pSystemTask, SortCallback, this, 0, Count );
+    }
+    else
+    {
+        KeyRange( 0, Count );
+    }
+    m_pSource = NULL;
+
+    // Sort the bots by cell
+    u32 CellCount = m_Types * m_Rows * m_Columns;
+    m_Cells.assign( CellCount + 1, 0 );
+    for( u32 i = 0; i < Count; i++ )
+    {
+        m_Cells[ m_Keys[ i ] + 1 ]++;
+    }
+    for( u32 i = 0; i < CellCount; i++ )
+    {
+        m_Cells[ i + 1 ] += m_Cells[ i ];
+    }
+
+    // The padding is far away from everything, so it is never in range
+    u32 Padded = ( Count + Lanes - 1 ) / Lanes * Lanes;
+    m_Bots.assign( Padded, NULL );
+    m_X.assign( Padded, FLT_MAX );
+    m_Y.assign( Padded, FLT_MAX );
+    m_Z.assign( Padded, FLT_MAX );
+    m_VelocityX.assign( Padded, 0.0f );
+    m_VelocityY.assign( Padded, 0.0f );
+    m_VelocityZ.assign( Padded, 0.0f );
+    m_States.assign( Padded, 0 );
+
+    for( u32 i = 0; i < Count; i++ )
+    {
+        const Bot* p_Bot = Bots[ i ];
+        u32 Slot = m_Cells[ m_Keys[ i ] ]++;
+
+        Bots[ i ]->m_Slot = Slot;
+        m_Bots[ Slot ] = Bots[ i ];
+        m_X[ Slot ] = p_Bot->m_Position.x;
+        m_Y[ Slot ] = p_Bot->m_Position.y;
+        m_Z[ Slot ] = p_Bot->m_Position.z;
+        m_VelocityX[ Slot ] = p_Bot->m_Velocity.x;
+        m_VelocityY[ Slot ] = p_Bot->m_Velocity.y;
+        m_VelocityZ[ Slot ] = p_Bot->m_Velocity.z;
+        m_States[ Slot ] = Bots[ i ]->GetState();
+    }
+
+    // Each cell now starts where the one before it was filled up to
+    for( u32 i = CellCount; i > 0; i-- )
+    {
+        m_Cells[ i ] = m_Cells[ i - 1 ];
+    }
+    m_Cells[ 0 ] = 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SortCallback - Invoked by ParallelFor algorithm to find the cells of a range of bots
+void SpatialGrid::SortCallback( void* param, u32 begin, u32 end )
+{
+    SpatialGrid* pThis = static_cast<SpatialGrid*>( param );
+    pThis->KeyRange( begin, end );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// KeyRange - Find the cells of a range of bots
+void SpatialGrid::KeyRange( u32 begin, u32 end )
+{
+    const std::vector<Bot*>& Bots = *m_pSource;
+
+    for( u32 i = begin; i < end; i++ )
+    {
+        const Bot* p_Bot = Bots[ i ];
+
+        // Rounding can put the bots on the far edge one cell out
+        i32 Column = std::min( GetColumn( p_Bot->m_Position.x ), m_Columns - 1 );
+        i32 Row = std::min( GetRow( p_Bot->m_Position.z ), m_Rows - 1 );
+
+        m_Keys[ i ] = ( (u32)p_Bot->m_Type * m_Rows + Row ) * m_Columns + Column;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FindNearest - Find the nearest bots of a type
+u32 SpatialGrid::FindNearest( const Bot* pSelf, const Base::Vector3& Position, u32 Type,
+                              f32 SqrdRange, u32 MaxCount, u32* p_Slots ) const
+{
+    ASSERT( MaxCount <= MaxNeighbors );
+    if( MaxCount > MaxNeighbors )
+    {
+        MaxCount = MaxNeighbors;
+    }
+    if( MaxCount == 0 || Type >= m_Types || m_Bots.empty() )
+    {
+        return 0;
+    }
+
+    // Leave out the bot itself, its slot is only trusted if it was part of the last build
+    u32 Self = (u32)-1;
+    if( pSelf != NULL && pSelf->m_Slot < m_Bots.size() && m_Bots[ pSelf->m_Slot ] == pSelf )
+    {
+        Self = pSelf->m_Slot;
+    }
+
+    // The bots in range are collected without branching on each of them and the nearest are
+    // picked out at the end.  A key holds the squared distance in the upper half, as the bits
+    // of a positive float sort like the float, and the slot in the lower half.
+    u64 Keys[ MaxCandidates + Lanes ];
+    u32 Found = 0;
+    f32 Limit = SqrdRange;
+
+    // Keeps the nearest keys only, the bots found later have to be nearer than all of them
+    auto Trim = [&] ( void )
+    {
+        std::nth_element( Keys, Keys + MaxCount - 1, Keys + Found );
+        Found = MaxCount;
+
+        u32 Bits = (u32)( Keys[ MaxCount - 1 ] >> 32 );
+        memcpy( &Limit, &Bits, sizeof( Limit ) );
+    };
+
+#if defined(USE_SSE_KERNELS)
+    const __m128 X = _mm_set1_ps( Position.x );
+    const __m128 Y = _mm_set1_ps( Position.y );
+    const __m128 Z = _mm_set1_ps( Position.z );
+#endif
+
+    // Tests the entries of a span four at a time, the lanes past the span are masked off
+    auto VisitSpan = [&] ( i32 Row, i32 FirstColumn, i32 LastColumn )
+    {
+        u32 First, Last;
+        GetSpan( Type, Row, FirstColumn, LastColumn, First, Last );
+
+        for( u32 i = First; i < Last; i += Lanes )
+        {
+            u32 Valid = ( Last - i >= Lanes ) ? 0xF : ( 1u << ( Last - i ) ) - 1;
+            u32 Bits[ Lanes ];
+
+#if defined(USE_SSE_KERNELS)
+            __m128 DiffX = _mm_sub_ps( _mm_loadu_ps( &m_X[ i ] ), X );
+            __m128 DiffY = _mm_sub_ps( _mm_loadu_ps( &m_Y[ i ] ), Y );
+            __m128 DiffZ = _mm_sub_ps( _mm_loadu_ps( &m_Z[ i ] ), Z );
+            __m128 Sqrd = _mm_add_ps( _mm_add_ps( _mm_mul_ps( DiffX, DiffX ), _mm_mul_ps( DiffY, DiffY ) ),
+                                      _mm_mul_ps( DiffZ, DiffZ ) );
+
+            u32 Mask = (u32)_mm_movemask_ps( _mm_cmplt_ps( Sqrd, _mm_set1_ps( Limit ) ) ) & Valid;
+            _mm_storeu_si128( (__m128i*)Bits, _mm_castps_si128( Sqrd ) );
+#else
+            u32 Mask = 0;
+            for( u32 Lane = 0; Lane < Lanes; Lane++ )
+            {
+                f32 DiffX = m_X[ i + Lane ] - Position.x;
+                f32 DiffY = m_Y[ i + Lane ] - Position.y;
+                f32 DiffZ = m_Z[ i + Lane ] - Position.z;
+                f32 Sqrd = DiffX * DiffX + DiffY * DiffY + DiffZ * DiffZ;
+
+                memcpy( &Bits[ Lane ], &Sqrd, sizeof( Sqrd ) );
+                Mask |= ( Sqrd < Limit ) ? 1u << Lane : 0;
+            }
+            Mask &= Valid;
+#endif
+
+            for( u32 Lane = 0; Lane < Lanes; Lane++ )
+            {
+                Keys[ Found ] = ( (u64)Bits[ Lane ] << 32 ) | ( i + Lane );
+                Found += ( ( Mask >> Lane ) & 1 ) & ( i + Lane != Self );
+            }
+
+            if( Found >= MaxCandidates )
+            {
+                Trim();
+            }
+        }
+    };
+
+    i32 Rings = GetRings( SqrdRange );
+    i32 Column = GetColumn( Position.x );
+    i32 Row = GetRow( Position.z );
+
+    // Distance from the position to the nearest edge of its cell
+    f32 CellX = ( Position.x - m_OriginX ) * m_InvCellSize - (f32)Column;
+    f32 CellZ = ( Position.z - m_OriginZ ) * m_InvCellSize - (f32)Row;
+    f32 Edge = Base::Min( Base::Min( CellX, 1.0f - CellX ), Base::Min( CellZ, 1.0f - CellZ ) ) * m_CellSize;
+
+    // Search the square of cells around the position a row at a time, the bots found are
+    // final once the square covers the farthest of them.  Otherwise the square grows and
+    // the search starts over, the bots are mostly found in the first square.
+    for( i32 Reach = 1; ; )
+    {
+        Found = 0;
+        Limit = SqrdRange;
+        for( i32 z = Row - Reach; z <= Row + Reach; z++ )
+        {
+            VisitSpan( z, Column - Reach, Column + Reach );
+        }
+
+        if( Found >= MaxCount )
+        {
+            Trim();
+        }
+
+        f32 Covered = (f32)Reach * m_CellSize + Edge;
+        f32 Farthest = ( Found == MaxCount ) ? Limit : SqrdRange;
+        if( Reach >= Rings || Farthest <= Covered * Covered
+         || ( Column - Reach <= 0 && Column + Reach >= m_Columns - 1 && Row - Reach <= 0 && Row + Reach >= m_Rows - 1 ) )
+        {
+            break;
+        }
+
+        // Grow to the farthest bot found, or by the bots still missing
+        i32 Needed = ( Found == MaxCount )
+            ? (i32)ceilf( ( sqrtf( Farthest ) - Edge ) * m_InvCellSize )
+            : (i32)ceilf( (f32)Reach * sqrtf( (f32)MaxCount / (f32)std::max( Found, 1u ) ) );
+        Reach = std::min( std::max( Needed, Reach + 1 ), Rings );
+    }
+
+    // Nearest first, bots as far away as each other by slot
+    std::sort( Keys, Keys + Found );
+    for( u32 i = 0; i < Found; i++ )
+    {
+        p_Slots[ i ] = (u32)Keys[ i ];
+    }
+
+    return Found;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Steer - Sum up the bots followed out of the given ones
+u32 SpatialGrid::Steer( const Base::Vector3& Position, const Base::Vector3& Facing,
+                        const u32* p_Slots, u32 Count, const Steering& Params,
+                        Base::Vector3& Avoidance, Base::Vector3& Velocity, Base::Vector3& Center ) const
+{
+    // Each bot avoided scales the avoidance so far, Powers[ n ] is the scale of n bots
+    f32 Powers[ Lanes + 1 ];
+    Powers[ 0 ] = 1.0f;
+    for( u32 i = 1; i <= Lanes; i++ )
+    {
+        Powers[ i ] = Powers[ i - 1 ] * Params.m_AvoidScale;
+    }
+
+    u32 Followed = 0;
+
+#if defined(USE_SSE_KERNELS)
+    const __m128 X = _mm_set1_ps( Position.x );
+    const __m128 Y = _mm_set1_ps( Position.y );
+    const __m128 Z = _mm_set1_ps( Position.z );
+    const __m128 FacingX = _mm_set1_ps( Facing.x );
+    const __m128 FacingY = _mm_set1_ps( Facing.y );
+    const __m128 FacingZ = _mm_set1_ps( Facing.z );
+    const __m128 SqrdFollow = _mm_set1_ps( Params.m_SqrdFollow );
+    const __m128 SqrdAvoid = _mm_set1_ps( Params.m_SqrdAvoid );
+    const __m128 Zero = _mm_setzero_ps();
+
+    __m128 AvoidX = Zero, AvoidY = Zero, AvoidZ = Zero;
+    __m128 VelocityX = Zero, VelocityY = Zero, VelocityZ = Zero;
+    __m128 CenterX = Zero, CenterY = Zero, CenterZ = Zero;
+
+    for( u32 i = 0; i < Count; i += Lanes )
+    {
+        // Gather the next four bots, the missing ones repeat the first
+        u32 Slot[ Lanes ];
+        u32 Valid = 0;
+        for( u32 Lane = 0; Lane < Lanes; Lane++ )
+        {
+            Bool bValid = i + Lane < Count;
+            Slot[ Lane ] = p_Slots[ bValid ? i + Lane : i ];
+            Valid |= bValid ? 1u << Lane : 0;
+        }
+
+        __m128 DiffX = _mm_sub_ps( _mm_set_ps( m_X[ Slot[ 3 ] ], m_X[ Slot[ 2 ] ], m_X[ Slot[ 1 ] ], m_X[ Slot[ 0 ] ] ), X );
+        __m128 DiffY = _mm_sub_ps( _mm_set_ps( m_Y[ Slot[ 3 ] ], m_Y[ Slot[ 2 ] ], m_Y[ Slot[ 1 ] ], m_Y[ Slot[ 0 ] ] ), Y );
+        __m128 DiffZ = _mm_sub_ps( _mm_set_ps( m_Z[ Slot[ 3 ] ], m_Z[ Slot[ 2 ] ], m_Z[ Slot[ 1 ] ], m_Z[ Slot[ 0 ] ] ), Z );
+        __m128 Sqrd = _mm_add_ps( _mm_add_ps( _mm_mul_ps( DiffX, DiffX ), _mm_mul_ps( DiffY, DiffY ) ),
+                                  _mm_mul_ps( DiffZ, DiffZ ) );
+        __m128 Ahead = _mm_cmpgt_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( FacingX, DiffX ), _mm_mul_ps( FacingY, DiffY ) ),
+                                                 _mm_mul_ps( FacingZ, DiffZ ) ), Zero );
+
+        // Follow the bots ahead and the ones close by
+        __m128 Follow = _mm_and_ps( _mm_or_ps( Ahead, _mm_cmplt_ps( Sqrd, SqrdFollow ) ), _mm_lookupmask_ps[ Valid ] );
+        __m128 Avoid = _mm_and_ps( Follow, _mm_cmplt_ps( Sqrd, SqrdAvoid ) );
+        if( Params.m_AvoidAhead )
+        {
+            Avoid = _mm_and_ps( Avoid, Ahead );
+        }
+
+        u32 FollowMask = (u32)_mm_movemask_ps( Follow );
+        if( FollowMask == 0 )
+        {
+            continue;
+        }
+        Followed += Base::PopCount( FollowMask );
+
+        VelocityX = _mm_add_ps( VelocityX, _mm_and_ps( Follow, _mm_set_ps( m_VelocityX[ Slot[ 3 ] ], m_VelocityX[ Slot[ 2 ] ], m_VelocityX[ Slot[ 1 ] ], m_VelocityX[ Slot[ 0 ] ] ) ) );
+        VelocityY = _mm_add_ps( VelocityY, _mm_and_ps( Follow, _mm_set_ps( m_VelocityY[ Slot[ 3 ] ], m_VelocityY[ Slot[ 2 ] ], m_VelocityY[ Slot[ 1 ] ], m_VelocityY[ Slot[ 0 ] ] ) ) );
+        VelocityZ = _mm_add_ps( VelocityZ, _mm_and_ps( Follow, _mm_set_ps( m_VelocityZ[ Slot[ 3 ] ], m_VelocityZ[ Slot[ 2 ] ], m_VelocityZ[ Slot[ 1 ] ], m_VelocityZ[ Slot[ 0 ] ] ) ) );
+        CenterX = _mm_add_ps( CenterX, _mm_and_ps( Follow, DiffX ) );
+        CenterY = _mm_add_ps( CenterY, _mm_and_ps( Follow, DiffY ) );
+        CenterZ = _mm_add_ps( CenterZ, _mm_and_ps( Follow, DiffZ ) );
+
+        // Avoiding a bot scales what was avoided before it, so a bot is weighed by the
+        // number of bots avoided after it
+        u32 AvoidMask = (u32)_mm_movemask_ps( Avoid );
+        if( AvoidMask != 0 )
+        {
+            f32 Weights[ Lanes ];
+            for( u32 Lane = 0; Lane < Lanes; Lane++ )
+            {
+                Weights[ Lane ] = ( AvoidMask & ( 1u << Lane ) )
+                    ? -Powers[ Base::PopCount( AvoidMask >> ( Lane + 1 ) ) + 1 ] : 0.0f;
+            }
+
+            __m128 Scale = _mm_set1_ps( Powers[ Base::PopCount( AvoidMask ) ] );
+            __m128 Weight = _mm_loadu_ps( Weights );
+            AvoidX = _mm_add_ps( _mm_mul_ps( AvoidX, Scale ), _mm_mul_ps( Weight, DiffX ) );
+            AvoidY = _mm_add_ps( _mm_mul_ps( AvoidY, Scale ), _mm_mul_ps( Weight, DiffY ) );
+            AvoidZ = _mm_add_ps( _mm_mul_ps( AvoidZ, Scale ), _mm_mul_ps( Weight, DiffZ ) );
+        }
+    }
+
+    // Add up the lanes
+    f32 p_Sums[ 9 ][ Lanes ];
+    _mm_storeu_ps( p_Sums[ 0 ], AvoidX );
+    _mm_storeu_ps( p_Sums[ 1 ], AvoidY );
+    _mm_storeu_ps( p_Sums[ 2 ], AvoidZ );
+    _mm_storeu_ps( p_Sums[ 3 ], VelocityX );
+    _mm_storeu_ps( p_Sums[ 4 ], VelocityY );
+    _mm_storeu_ps( p_Sums[ 5 ], VelocityZ );
+    _mm_storeu_ps( p_Sums[ 6 ], CenterX );
+    _mm_storeu_ps( p_Sums[ 7 ], CenterY );
+    _mm_storeu_ps( p_Sums[ 8 ], CenterZ );
+
+    f32 Sums[ 9 ];
+    for( u32 i = 0; i < 9; i++ )
+    {
+        Sums[ i ] = ( p_Sums[ i ][ 0 ] + p_Sums[ i ][ 1 ] ) + ( p_Sums[ i ][ 2 ] + p_Sums[ i ][ 3 ] );
+    }
+
+    Avoidance = Base::Vector3( Sums[ 0 ], Sums[ 1 ], Sums[ 2 ] );
+    Velocity = Base::Vector3( Sums[ 3 ], Sums[ 4 ], Sums[ 5 ] );
+    Center = Base::Vector3( Sums[ 6 ], Sums[ 7 ], Sums[ 8 ] ) + Position * (f32)Followed;
+#else
+    Avoidance = Base::Vector3::Zero;
+    Velocity = Base::Vector3::Zero;
+    Center = Base::Vector3::Zero;
+
+    for( u32 i = 0; i < Count; i++ )
+    {
+        u32 Slot = p_Slots[ i ];
+        Base::Vector3 Diff = GetPosition( Slot ) - Position;
+        f32 Sqrd = Diff.x * Diff.x + Diff.y * Diff.y + Diff.z * Diff.z;
+        Bool bAhead = Facing.Dot( Diff ) > 0.0f;
+
+        if( bAhead || Sqrd < Params.m_SqrdFollow )
+        {
+            Followed++;
+            Velocity += GetVelocity( Slot );
+            Center += Diff;
+
+            if( Sqrd < Params.m_SqrdAvoid && ( bAhead || !Params.m_AvoidAhead ) )
+            {
+                Avoidance = ( Avoidance - Diff ) * Powers[ 1 ];
+            }
+        }
+    }
+    Center += Position * (f32)Followed;
+#endif
+
+    return Followed;
+}
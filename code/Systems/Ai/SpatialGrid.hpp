@@ -0,0 +1,233 @@
+// Copyright © 2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+#pragma once
+
+// Standard Library
+#include <cmath>
+#include <vector>
+
+
+class Bot;
+
+
+///////////////////////////////////////////////////////////////////////////////
+/// <summary>
+///   <c>SpatialGrid</c> Uniform grid over the ground plane holding the positions,
+///   velocities and states of the bots.  The AI scene rebuilds it once per frame before
+///   the bots update, after that it is only read and can be queried from all the bots
+///   concurrently.  The bots only see each other through the grid, so what they see
+///   does not depend on which of them updated first.
+/// </summary>
+/// <remarks>
+///   The grid covers the bots of the last build.  The entries are sorted by bot
+///   type, row and column, so the cells of a row are next to each other and a
+///   range query reads one span of entries per row.  Each component of the entries
+///   is kept in its own array so four entries at a time fit an SSE register.  An
+///   entry is addressed by its slot, the index into these arrays.
+/// </remarks>
+///////////////////////////////////////////////////////////////////////////////
+
+class SpatialGrid
+{
+public:
+    /// <summary>
+    ///   The most neighbours a single query can return.
+    /// </summary>
+    static const u32 MaxNeighbors = 256;
+
+    /// <summary>
+    ///   How a bot weighs the bots around it when it flocks or herds with them.
+    /// </summary>
+    struct Steering
+    {
+        f32  m_SqrdFollow;   // Bots closer than this are followed even when behind
+        f32  m_SqrdAvoid;    // Followed bots closer than this are avoided
+        Bool m_AvoidAhead;   // Only avoid the bots ahead
+        f32  m_AvoidScale;   // Scale applied to the avoidance for each bot avoided
+    };
+
+    SpatialGrid( void );
+    ~SpatialGrid( void );
+
+    /// <summary cref="SpatialGrid::Build">
+    /// Rebuilds the grid from the current positions, velocities and states of the bots and
+    /// stores the slot of each bot in its <c>m_Slot</c>.
+    /// </summary>
+    /// <param name="Bots">The bots to insert.</param>
+    /// <param name="CellSize">Edge length of a grid cell, grows if the bots are spread so
+    ///  far that the grid would have many more cells than bots.</param>
+    /// <param name="pSystemTask">Task to sort the bots in parallel for, may be NULL.</param>
+    void Build( const std::vector<Bot*>& Bots, f32 CellSize, ISystemTask* pSystemTask );
+
+    /// <summary cref="SpatialGrid::FindNearest">
+    /// Finds the nearest bots of a type as of the last <c>Build</c>.
+    /// </summary>
+    /// <param name="pSelf">Bot to leave out of the result.</param>
+    /// <param name="Position">Position to search around.</param>
+    /// <param name="Type">Type of the bots to find.</param>
+    /// <param name="SqrdRange">Squared distance the bots have to be within.</param>
+    /// <param name="MaxCount">The most bots to find, at most <c>MaxNeighbors</c>.</param>
+    /// <param name="p_Slots">Receives the slots of the bots, nearest first.</param>
+    /// <returns>u32 - The number of bots found.</returns>
+    u32 FindNearest( const Bot* pSelf, const Base::Vector3& Position, u32 Type,
+                     f32 SqrdRange, u32 MaxCount, u32* p_Slots ) const;
+
+    /// <summary cref="SpatialGrid::Steer">
+    /// Sums up the bots a bot follows out of the given ones.  The bots ahead of it and
+    /// the ones close to it are followed.
+    /// </summary>
+    /// <param name="Position">Position of the bot.</param>
+    /// <param name="Facing">Direction the bot is facing.</param>
+    /// <param name="p_Slots">Slots of the bots around it, nearest first.</param>
+    /// <param name="Count">The number of slots.</param>
+    /// <param name="Params">How to weigh the bots.</param>
+    /// <param name="Avoidance">Receives the vector to avoid the bots too close.</param>
+    /// <param name="Velocity">Receives the sum of the velocities of the bots followed.</param>
+    /// <param name="Center">Receives the sum of the positions of the bots followed.</param>
+    /// <returns>u32 - The number of bots followed.</returns>
+    u32 Steer( const Base::Vector3& Position, const Base::Vector3& Facing,
+               const u32* p_Slots, u32 Count, const Steering& Params,
+               Base::Vector3& Avoidance, Base::Vector3& Velocity, Base::Vector3& Center ) const;
+
+    /// <summary cref="SpatialGrid::FindAny">
+    /// Checks if there is a bot of a type in range which passes a test.
+    /// </summary>
+    /// <param name="pSelf">Bot to leave out.</param>
+    /// <param name="Position">Position to search around.</param>
+    /// <param name="Type">Type of the bots to test.</param>
+    /// <param name="SqrdRange">Squared distance the bots have to be within.</param>
+    /// <param name="Accept">Called with the states of the bots in range at the time of the
+    ///  build until it returns True.</param>
+    /// <returns>Bool - True if a bot passed the test.</returns>
+    template<class Test>
+    Bool FindAny( const Bot* pSelf, const Base::Vector3& Position, u32 Type,
+                  f32 SqrdRange, Test Accept ) const
+    {
+        if( Type >= m_Types || m_Bots.empty() )
+        {
+            return False;
+        }
+
+        i32 Rings = GetRings( SqrdRange );
+        i32 Column = GetColumn( Position.x );
+        i32 Row = GetRow( Position.z );
+
+        for( i32 z = Row - Rings; z <= Row + Rings; z++ )
+        {
+            u32 First, Last;
+            GetSpan( Type, z, Column - Rings, Column + Rings, First, Last );
+
+            for( u32 i = First; i < Last; i++ )
+            {
+                f32 DiffX = m_X[ i ] - Position.x;
+                f32 DiffY = m_Y[ i ] - Position.y;
+                f32 DiffZ = m_Z[ i ] - Position.z;
+
+                if( DiffX * DiffX + DiffY * DiffY + DiffZ * DiffZ < SqrdRange
+                 && m_Bots[ i ] != pSelf
+                 && Accept( m_States[ i ] ) )
+                {
+                    return True;
+                }
+            }
+        }
+
+        return False;
+    }
+
+    /// <summary cref="SpatialGrid::GetBot">
+    /// Gets the bot in a slot.
+    /// </summary>
+    inline Bot* GetBot( u32 Slot ) const { return m_Bots[ Slot ]; }
+
+    /// <summary cref="SpatialGrid::GetPosition">
+    /// Gets the position of the bot in a slot at the time of the build.
+    /// </summary>
+    inline Base::Vector3 GetPosition( u32 Slot ) const
+    {
+        return Base::Vector3( m_X[ Slot ], m_Y[ Slot ], m_Z[ Slot ] );
+    }
+
+    /// <summary cref="SpatialGrid::GetVelocity">
+    /// Gets the velocity of the bot in a slot at the time of the build.
+    /// </summary>
+    inline Base::Vector3 GetVelocity( u32 Slot ) const
+    {
+        return Base::Vector3( m_VelocityX[ Slot ], m_VelocityY[ Slot ], m_VelocityZ[ Slot ] );
+    }
+
+protected:
+    static void SortCallback( void* param, u32 begin, u32 end );
+    void KeyRange( u32 begin, u32 end );
+
+    i32 GetColumn( f32 x ) const
+    {
+        return (i32)floorf( ( x - m_OriginX ) * m_InvCellSize );
+    }
+
+    i32 GetRow( f32 z ) const
+    {
+        return (i32)floorf( ( z - m_OriginZ ) * m_InvCellSize );
+    }
+
+    i32 GetRings( f32 SqrdRange ) const
+    {
+        // Limit the rings to the grid, the range can be far larger
+        f32 Rings = ceilf( sqrtf( SqrdRange ) * m_InvCellSize );
+        return (i32)Base::Min( Rings, (f32)( m_Columns + m_Rows ) );
+    }
+
+    /// <summary cref="SpatialGrid::GetSpan">
+    /// Gets the entries of a type in a span of the columns of a row, the span is clipped to the grid.
+    /// </summary>
+    void GetSpan( u32 Type, i32 Row, i32 FirstColumn, i32 LastColumn, u32& First, u32& Last ) const
+    {
+        FirstColumn = FirstColumn > 0 ? FirstColumn : 0;
+        LastColumn = LastColumn < m_Columns - 1 ? LastColumn : m_Columns - 1;
+
+        if( Row < 0 || Row >= m_Rows || FirstColumn > LastColumn )
+        {
+            First = Last = 0;
+            return;
+        }
+
+        u32 Cell = ( Type * m_Rows + Row ) * m_Columns;
+        First = m_Cells[ Cell + FirstColumn ];
+        Last = m_Cells[ Cell + LastColumn + 1 ];
+    }
+
+    const std::vector<Bot*>* m_pSource;   // Bots of the build in progress
+    std::vector<u32>         m_Keys;      // Cell of each bot of the build in progress
+
+    // The entries sorted by type, row and column, the components are padded so the
+    // last entries can be read four at a time
+    std::vector<Bot*>        m_Bots;
+    std::vector<f32>         m_X;
+    std::vector<f32>         m_Y;
+    std::vector<f32>         m_Z;
+    std::vector<f32>         m_VelocityX;
+    std::vector<f32>         m_VelocityY;
+    std::vector<f32>         m_VelocityZ;
+    std::vector<i32>         m_States;
+
+    std::vector<u32>         m_Cells;     // First entry of each cell, one past the last at the end
+    u32                      m_Types;     // Bot types in the grid
+    i32                      m_Columns;
+    i32                      m_Rows;
+    f32                      m_OriginX;
+    f32                      m_OriginZ;
+    f32                      m_CellSize;
+    f32                      m_InvCellSize;
+};
@@ -17,6 +17,7 @@
 // Base
 #include "Base/Platform.hpp"
 #include "Base/Math.hpp"
+#include "Base/StringId.hpp"
 // Standard Library
 #include <string>
 
@@ -43,6 +44,7 @@ public:
     {
         m_Position = Base::Vector3::Zero;
         m_Type = POIType::e_POI_None;
+        m_Id = 0;
     }
 
     virtual ~POI( void ) {}
@@ -62,9 +64,16 @@ public:
     // Returns True is this POI is no longer valid.
     virtual inline bool Expired( void ) { return true; }
 
+    // Returns the id of this POI, no other POI of the scene had it before.
+    inline u32 GetId( void ) { return m_Id; }
+
+    // Set the id of this POI.
+    inline void SetId( u32 Id ) { m_Id = Id; }
+
 protected:
     Base::Vector3    m_Position;  // Position of POI
     POIType::POIType m_Type;      // Type of POI
+    u32              m_Id;        // Id of POI
 };
 
 
@@ -146,6 +155,7 @@ public:
         m_AABB_Max = Base::Vector3::Zero;
         m_AABB_Min = Base::Vector3::Zero;
         m_Name     = "";
+        m_NameId   = Base::InvalidStringId;
     }
 
     ~POIFire( void ) {}
@@ -171,11 +181,15 @@ public:
     inline std::string GetName( void ) { return m_Name; }
     
     // Sets the name for this fire.  Name must be unique for each fire.
-    inline void  SetName( std::string name ) { m_Name = name; }
+    inline void  SetName( std::string name ) { m_Name = name; m_NameId = Base::InternString( name.c_str() ); }
+
+    // Returns the interned id of the name, compare it instead of the name.
+    inline Base::StringId GetNameId( void ) { return m_NameId; }
 
 protected:
     Base::Vector3 m_AABB_Max;  // Max position of fire's AABB
     Base::Vector3 m_AABB_Min;  // Min position of fire's AABB
     std::string   m_Name;      // Name used to ID this area
+    Base::StringId m_NameId;   // Interned id of m_Name
 };
 
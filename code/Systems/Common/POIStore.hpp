@@ -0,0 +1,328 @@
+// Copyright © 2008-2009 Intel Corporation
+// All Rights Reserved
+//
+// Permission is granted to use, copy, distribute and prepare derivative works of this
+// software for any purpose and without fee, provided, that the above copyright notice
+// and this statement appear in all copies.  Intel makes no representations about the
+// suitability of this software for any purpose.  THIS SOFTWARE IS PROVIDED "AS IS."
+// INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES, EXPRESS OR IMPLIED, AND ALL LIABILITY,
+// INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES, FOR THE USE OF THIS SOFTWARE,
+// INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY RIGHTS, AND INCLUDING THE
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.  Intel does not
+// assume any responsibility for any errors which may appear in this software nor any
+// responsibility to update it.
+
+#pragma once
+
+// Base
+#include "Base/Platform.hpp"
+#include "Base/Math.hpp"
+#include "Base/StringId.hpp"
+// Standard Library
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <vector>
+// System
+#include "Systems/Common/POI.hpp"
+
+
+///////////////////////////////////////////////////////////////////////////////
+/// <summary>
+///   <c>POIStore</c> Points of interest of a scene.  The contacts are added while
+///   the changes are distributed and read by the objects of the scene during its next
+///   update, the fires are kept until the store is destroyed.
+/// </summary>
+/// <remarks>
+///   The contacts are added to one buffer and read from the other, <c>Publish</c>
+///   swaps them at the start of the update and buckets the published contacts by
+///   the cell of a coarse grid they are in.  A buffer is made of chunks of contacts
+///   which are reused in the next frames, so once the chunks exist adding a contact
+///   neither allocates nor locks.
+/// </remarks>
+///////////////////////////////////////////////////////////////////////////////
+
+class POIStore
+{
+public:
+    /// <summary>
+    ///   Contacts in a chunk of a buffer.
+    /// </summary>
+    static const u32 ChunkSize = 256;
+
+    /// <summary>
+    ///   The most chunks of a buffer, contacts added past them are dropped.
+    /// </summary>
+    static const u32 MaxChunks = 64;
+
+    /// <param name="CellSize">Edge length of a cell of the grid of the contacts.</param>
+    POIStore( f32 CellSize = 1000.0f )
+        : m_InvCellSize( 1.0f / CellSize )
+        , m_Write( 0 )
+        , m_Read( 1 )
+        , m_Published( 0 )
+        , m_NextId( 1 )
+    {
+        for( u32 i = 0; i < 2; i++ )
+        {
+            m_Buffers[ i ].m_Count.store( 0, std::memory_order_relaxed );
+            for( u32 j = 0; j < MaxChunks; j++ )
+            {
+                m_Buffers[ i ].m_Chunks[ j ].store( NULL, std::memory_order_relaxed );
+            }
+        }
+    }
+
+    ~POIStore( void )
+    {
+        for( u32 i = 0; i < 2; i++ )
+        {
+            for( u32 j = 0; j < MaxChunks; j++ )
+            {
+                delete [] m_Buffers[ i ].m_Chunks[ j ].load( std::memory_order_relaxed );
+            }
+        }
+
+        for( std::vector<POIFire*>::iterator it = m_Fires.begin(); it != m_Fires.end(); it++ )
+        {
+            delete *it;
+        }
+    }
+
+    /// <summary cref="POIStore::AddContact">
+    /// Adds a contact to be published by the next <c>Publish</c>.  Can be called from
+    /// several threads at once, but not while <c>Publish</c> runs.
+    /// </summary>
+    /// <returns>POIContact* - The contact to fill in, NULL if the buffer is full.</returns>
+    POIContact* AddContact( void )
+    {
+        Buffer& Write = m_Buffers[ m_Write ];
+        u32 Index = Write.m_Count.fetch_add( 1, std::memory_order_relaxed );
+        u32 Chunk = Index / ChunkSize;
+        if( Chunk >= MaxChunks )
+        {
+            return NULL;
+        }
+
+        // The first to need a chunk allocates it, the others use the one it stored
+        POIContact* pChunk = Write.m_Chunks[ Chunk ].load( std::memory_order_acquire );
+        if( pChunk == NULL )
+        {
+            POIContact* pNewChunk = new POIContact[ ChunkSize ];
+            if( Write.m_Chunks[ Chunk ].compare_exchange_strong( pChunk, pNewChunk, std::memory_order_acq_rel ) )
+            {
+                pChunk = pNewChunk;
+            }
+            else
+            {
+                delete [] pNewChunk;
+            }
+        }
+
+        POIContact* pContact = &pChunk[ Index % ChunkSize ];
+        *pContact = POIContact();
+        return pContact;
+    }
+
+    /// <summary cref="POIStore::GetFire">
+    /// Gets the fire with a name, adds it if there is none yet.
+    /// </summary>
+    /// <param name="pszName">The unique name of the fire.</param>
+    /// <returns>POIFire* - The fire.</returns>
+    POIFire* GetFire( pcstr pszName )
+    {
+        Base::StringId NameId = Base::InternString( pszName );
+
+        std::lock_guard<std::mutex> lock( m_FireMutex );
+        for( std::vector<POIFire*>::iterator it = m_Fires.begin(); it != m_Fires.end(); it++ )
+        {
+            if( (*it)->GetNameId() == NameId )
+            {
+                return *it;
+            }
+        }
+
+        POIFire* pFire = new POIFire();
+        pFire->SetName( pszName );
+        pFire->SetId( m_NextId++ );
+        m_Fires.push_back( pFire );
+        return pFire;
+    }
+
+    /// <summary cref="POIStore::Publish">
+    /// Publishes the contacts added since the last call and drops the ones published
+    /// before.  Must not run at the same time as <c>AddContact</c> or the visits.
+    /// </summary>
+    void Publish( void )
+    {
+        m_Read = m_Write;
+        m_Write ^= 1;
+        m_Buffers[ m_Write ].m_Count.store( 0, std::memory_order_relaxed );
+
+        u32 Count = m_Buffers[ m_Read ].m_Count.load( std::memory_order_relaxed );
+        if( Count > MaxChunks * ChunkSize )
+        {
+            std::cerr << "POIStore: dropped " << Count - MaxChunks * ChunkSize << " contacts" << std::endl;
+            Count = MaxChunks * ChunkSize;
+        }
+        m_Published = Count;
+
+        // Bucket the contacts by cell, several cells can share a bucket
+        u32 Buckets = 16;
+        while( Buckets < Count )
+        {
+            Buckets *= 2;
+        }
+
+        m_Contacts.resize( Count );
+        m_Keys.resize( Count );
+        m_Buckets.assign( Buckets + 1, 0 );
+
+        for( u32 i = 0; i < Count; i++ )
+        {
+            POIContact* pContact = GetPublished( i );
+            pContact->SetId( m_NextId++ );
+
+            Base::Vector3 Position = pContact->GetPosition();
+            m_Keys[ i ] = GetBucket( GetCell( Position.x ), GetCell( Position.z ), Buckets );
+            m_Buckets[ m_Keys[ i ] + 1 ]++;
+        }
+
+        for( u32 i = 0; i < Buckets; i++ )
+        {
+            m_Buckets[ i + 1 ] += m_Buckets[ i ];
+        }
+
+        for( u32 i = 0; i < Count; i++ )
+        {
+            m_Contacts[ m_Buckets[ m_Keys[ i ] ]++ ] = GetPublished( i );
+        }
+
+        // Each bucket now starts where the one before it was filled up to
+        for( u32 i = Buckets; i > 0; i-- )
+        {
+            m_Buckets[ i ] = m_Buckets[ i - 1 ];
+        }
+        m_Buckets[ 0 ] = 0;
+    }
+
+    /// <summary cref="POIStore::VisitContacts">
+    /// Visits the published contacts in range of a position.
+    /// </summary>
+    /// <param name="Position">Position to search around.</param>
+    /// <param name="Range">Distance the contacts have to be within.</param>
+    /// <param name="Visit">Called with each contact in range.</param>
+    template<class Visitor>
+    void VisitContacts( const Base::Vector3& Position, f32 Range, Visitor Visit ) const
+    {
+        if( m_Contacts.empty() )
+        {
+            return;
+        }
+
+        u32 Buckets = (u32)m_Buckets.size() - 1;
+        i32 FirstColumn = GetCell( Position.x - Range );
+        i32 LastColumn = GetCell( Position.x + Range );
+        i32 FirstRow = GetCell( Position.z - Range );
+        i32 LastRow = GetCell( Position.z + Range );
+        f32 SqrdRange = Range * Range;
+
+        // Far reaching searches would test the buckets more than once, just test all
+        if( (f32)( LastColumn - FirstColumn + 1 ) * (f32)( LastRow - FirstRow + 1 ) >= (f32)Buckets )
+        {
+            for( std::vector<POIContact*>::const_iterator it = m_Contacts.begin(); it != m_Contacts.end(); it++ )
+            {
+                Base::Vector3 Diff = (*it)->GetPosition() - Position;
+                if( Diff.x * Diff.x + Diff.y * Diff.y + Diff.z * Diff.z < SqrdRange )
+                {
+                    Visit( *it );
+                }
+            }
+            return;
+        }
+
+        for( i32 z = FirstRow; z <= LastRow; z++ )
+        {
+            for( i32 x = FirstColumn; x <= LastColumn; x++ )
+            {
+                u32 Bucket = GetBucket( x, z, Buckets );
+                for( u32 i = m_Buckets[ Bucket ]; i < m_Buckets[ Bucket + 1 ]; i++ )
+                {
+                    // Skip the contacts of the other cells sharing the bucket
+                    POIContact* pContact = m_Contacts[ i ];
+                    Base::Vector3 Diff = pContact->GetPosition() - Position;
+                    if( GetCell( pContact->GetPosition().x ) == x && GetCell( pContact->GetPosition().z ) == z
+                     && Diff.x * Diff.x + Diff.y * Diff.y + Diff.z * Diff.z < SqrdRange )
+                    {
+                        Visit( pContact );
+                    }
+                }
+            }
+        }
+    }
+
+    /// <summary cref="POIStore::VisitContactsInOrder">
+    /// Visits all the published contacts in the order they were added.
+    /// </summary>
+    /// <param name="Visit">Called with each contact until it returns False.</param>
+    template<class Visitor>
+    void VisitContactsInOrder( Visitor Visit ) const
+    {
+        for( u32 i = 0; i < m_Published; i++ )
+        {
+            if( !Visit( GetPublished( i ) ) )
+            {
+                return;
+            }
+        }
+    }
+
+    /// <summary cref="POIStore::VisitFires">
+    /// Visits all the fires.
+    /// </summary>
+    /// <param name="Visit">Called with each fire.</param>
+    template<class Visitor>
+    void VisitFires( Visitor Visit ) const
+    {
+        for( std::vector<POIFire*>::const_iterator it = m_Fires.begin(); it != m_Fires.end(); it++ )
+        {
+            Visit( *it );
+        }
+    }
+
+protected:
+    inline POIContact* GetPublished( u32 Index ) const
+    {
+        return &m_Buffers[ m_Read ].m_Chunks[ Index / ChunkSize ].load( std::memory_order_relaxed )[ Index % ChunkSize ];
+    }
+
+    inline i32 GetCell( f32 Coordinate ) const
+    {
+        return (i32)floorf( Coordinate * m_InvCellSize );
+    }
+
+    static inline u32 GetBucket( i32 Column, i32 Row, u32 Buckets )
+    {
+        return ( (u32)Column * 73856093u ^ (u32)Row * 19349663u ) & ( Buckets - 1 );
+    }
+
+    struct Buffer
+    {
+        std::atomic<POIContact*> m_Chunks[ MaxChunks ];
+        std::atomic<u32>         m_Count;     // Contacts added, may run past the chunks
+    };
+
+    f32                      m_InvCellSize;
+    Buffer                   m_Buffers[ 2 ];
+    u32                      m_Write;       // Buffer the contacts are added to
+    u32                      m_Read;        // Buffer the contacts were published from
+    u32                      m_Published;   // Contacts published from it
+    u32                      m_NextId;      // Id of the next POI published
+
+    std::vector<POIContact*> m_Contacts;    // Published contacts sorted by bucket
+    std::vector<u32>         m_Keys;        // Bucket of each contact while publishing
+    std::vector<u32>         m_Buckets;     // First contact of each bucket, one past the last at the end
+
+    std::vector<POIFire*>    m_Fires;
+    std::mutex               m_FireMutex;
+};
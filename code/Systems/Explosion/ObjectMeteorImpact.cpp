@@ -27,7 +27,7 @@
 static int ballCounter = 0; // Cheat used alongside delta time to control release of meteor fragments
 
 // Globals
-POI* pLastContact = NULL; // Used to differentiate between meteor impact collision events
+u32 uLastContactId = 0; // Used to differentiate between meteor impact collision events
 
 ///////////////////////////////////////////////////////////////////////////////
 // MeteorImpact - Constructor
@@ -69,90 +69,86 @@ void MeteorImpact::Update( f32 DeltaTime )
     Explosion::Update( DeltaTime );
 
     ExplosionScene* pScene = (ExplosionScene*)GetSystemScene();
-    std::list<POI*> POIs = pScene->GetPOI();
+    const POIStore& POIs = pScene->GetPOI();
 
     // Iterate through the list of contact points of interest and release up to 3 
     // meteor fragments for this impact event and reset for the next event.
     // Note: meteor fragments are "pooled" meaning that there are M many meteors
     // and N fragments with N as the amount of fragments contained in the
     // scene definition file (.cdf).
-    for( std::list<POI*>::iterator it = POIs.begin(); it != POIs.end(); it++ )
+    POIs.VisitContactsInOrder( [&] ( POIContact* pPOIContact ) -> Bool
     {
-        POI* pPOI = *it;
-        Base::Vector3 Diff = m_Position - pPOI->GetPosition();
-        if( pPOI->GetType() == POIType::e_POI_Contact )
-        {   
-            POIContact* pPOIContact = (POIContact*)pPOI;
-            Base::Vector3 position = pPOIContact->GetPosition();
-            f32 impact = pPOIContact->GetImpact();
-
-            // Hack: As there is no differentiation between hitting the ground or any other static mesh
-            // from Havok, we release fragments based on impact speed, if the object is a static mesh
-            // at the time of impact (the house becomes dynamic after a collision), and if an unused
-            // fragment from the pool is free up to the maximum allowed fragments per meteor impact.
-            if( (impact > 800.0f ) && pPOIContact->IsStatic() && !m_bFragmentUsed )
+        Base::Vector3 position = pPOIContact->GetPosition();
+        f32 impact = pPOIContact->GetImpact();
+
+        // Hack: As there is no differentiation between hitting the ground or any other static mesh
+        // from Havok, we release fragments based on impact speed, if the object is a static mesh
+        // at the time of impact (the house becomes dynamic after a collision), and if an unused
+        // fragment from the pool is free up to the maximum allowed fragments per meteor impact.
+        if( (impact > 800.0f ) && pPOIContact->IsStatic() && !m_bFragmentUsed )
+        {
+            if( uLastContactId == pPOIContact->GetId() )
             {
-                if( pLastContact == pPOI )
-                {
-                    ballCounter = 0;
-                    return;
-                }
-
-                if( ballCounter > (MAX_FRAGMENTS-1) )
-                {
-                    // Hack: remember this meteor impact collision event so we do not reinterpret future 
-                    // impacts of qualifying velocity as a new impact (some meteors start so high
-                    // that a secondary bounce still possesses a significant velocity)
-
-                    pLastContact = pPOI; 
-                    return;
-                }
-                else
-                {
-                    ballCounter++;
-                }
-
-                // Hack: The current architecture does not support object creation, rather objects exist in the scene
-                // and we simply move them from below the world, position them at the point of impact with an
-                // approximated deflection vector, and give each fragment an arc offset from the initial impact
-                // around the meteor, give it a new deflection vector, and update related systems.
-                m_bFragmentUsed = True;
-                m_Position.x = sin(.707f*ballCounter); // assign this fragment a position away from other objects around the meteor
-                m_Position.z = cos(.707f*ballCounter);
-                m_Position.Normalize();
-                m_Position *= 150;
-                
-                position.y += 100.0f*ballCounter; // reposition the meteor above the ground
-
-                m_Position = position;
-
-                Base::Vector3 inboundVelocity, deflectionVelocity;
-                
-                Base::Vector3 vectorI = pPOIContact->GetVelocityObjectA() + pPOIContact->GetVelocityObjectB();
-                vectorI.y *= -1.0f;
-                vectorI.x *= 0.95f;
-                vectorI.Normalize(); // get the deflection adjusted vector
-
-                const f32 scale = 0.1f;
-                f32 x = Base::Random::GetRandomFloat( -scale, scale ); 
-                f32 y = Base::Random::GetRandomFloat( -scale, scale ); 
-                f32 z = Base::Random::GetRandomFloat( -scale, scale ); 
-                f32 m = Base::Random::GetRandomFloat( -scale, scale ); 
-                vectorI.x += x;
-                vectorI.y += y;
-                vectorI.z += z;
-                impact += impact*m; // assign the fragment an adjusted deflection vector
-                vectorI.Normalize();
-               
-                SetVelocity( vectorI * impact/2 ); // adjust the fragment velocity and scale it down for realism
-
-                // Post these changes to update the physics and geometry systems because we've given
-                // the meteor fragment a new position and velocity
-                PostChanges( System::Changes::Geometry::Position );
-                PostChanges( System::Changes::Physics::Velocity );
+                ballCounter = 0;
+                return False;
             }
+
+            if( ballCounter > (MAX_FRAGMENTS-1) )
+            {
+                // Hack: remember this meteor impact collision event so we do not reinterpret future 
+                // impacts of qualifying velocity as a new impact (some meteors start so high
+                // that a secondary bounce still possesses a significant velocity)
+
+                uLastContactId = pPOIContact->GetId();
+                return False;
+            }
+            else
+            {
+                ballCounter++;
+            }
+
+            // Hack: The current architecture does not support object creation, rather objects exist in the scene
+            // and we simply move them from below the world, position them at the point of impact with an
+            // approximated deflection vector, and give each fragment an arc offset from the initial impact
+            // around the meteor, give it a new deflection vector, and update related systems.
+            m_bFragmentUsed = True;
+            m_Position.x = sin(.707f*ballCounter); // assign this fragment a position away from other objects around the meteor
+            m_Position.z = cos(.707f*ballCounter);
+            m_Position.Normalize();
+            m_Position *= 150;
+            
+            position.y += 100.0f*ballCounter; // reposition the meteor above the ground
+
+            m_Position = position;
+
+            Base::Vector3 inboundVelocity, deflectionVelocity;
+            
+            Base::Vector3 vectorI = pPOIContact->GetVelocityObjectA() + pPOIContact->GetVelocityObjectB();
+            vectorI.y *= -1.0f;
+            vectorI.x *= 0.95f;
+            vectorI.Normalize(); // get the deflection adjusted vector
+
+            const f32 scale = 0.1f;
+            f32 x = Base::Random::GetRandomFloat( -scale, scale ); 
+            f32 y = Base::Random::GetRandomFloat( -scale, scale ); 
+            f32 z = Base::Random::GetRandomFloat( -scale, scale ); 
+            f32 m = Base::Random::GetRandomFloat( -scale, scale ); 
+            vectorI.x += x;
+            vectorI.y += y;
+            vectorI.z += z;
+            impact += impact*m; // assign the fragment an adjusted deflection vector
+            vectorI.Normalize();
+           
+            SetVelocity( vectorI * impact/2 ); // adjust the fragment velocity and scale it down for realism
+
+            // Post these changes to update the physics and geometry systems because we've given
+            // the meteor fragment a new position and velocity
+            PostChanges( System::Changes::Geometry::Position );
+            PostChanges( System::Changes::Physics::Velocity );
         }
-    }
+
+        return True;
+    } );
 }
 
 
@@ -17,10 +17,8 @@
 #include "Base/Platform.hpp"
 // Interface
 #include "Interfaces/Interface.hpp"
-// Standard Library
-#include <mutex>
 // System
-#include "Systems/Common/POI.hpp"
+#include "Systems/Common/POIStore.hpp"
 #include "Systems/Explosion/Object.hpp"
 #include "Systems/Explosion/ObjectMeteorImpact.hpp"
 #include "Systems/Explosion/Scene.hpp"
@@ -54,15 +52,6 @@ ExplosionScene::~ExplosionScene( void )
     }
 
     m_Objects.clear();
-
-
-    // Free all the remaining POI.
-    for( std::list<POI*>::iterator it = m_POI.begin(); it != m_POI.end(); it++ )
-    {
-        delete *it;
-    }
-
-    m_POI.clear();
 }
 
 
@@ -211,18 +200,17 @@ Error ExplosionScene::ChangeOccurred( ISubject* pSubject, System::Changes::BitMa
 
             if( pContactInfo )
             {
-                // Store the contact points so objects can process them later
-                POIContact* pContact = new POIContact();
-                ASSERT( pContact );
-
-                pContact->SetPosition( pContactInfo->m_Position );
-                pContact->SetImpact( pContactInfo->m_Impact );
-                pContact->SetStatic( pContactInfo->m_Static );
-                pContact->SetVelocityObjectA( pContactInfo->m_VelocityObjectA );
-                pContact->SetVelocityObjectB( pContactInfo->m_VelocityObjectB );
-
-                std::lock_guard<std::mutex> lock(m_mutex);
-                m_POI.push_back( pContact );
+                // Store the contact points so objects can process them during the next update
+                POIContact* pContact = m_POI.AddContact();
+
+                if( pContact )
+                {
+                    pContact->SetPosition( pContactInfo->m_Position );
+                    pContact->SetImpact( pContactInfo->m_Impact );
+                    pContact->SetStatic( pContactInfo->m_Static );
+                    pContact->SetVelocityObjectA( pContactInfo->m_VelocityObjectA );
+                    pContact->SetVelocityObjectB( pContactInfo->m_VelocityObjectB );
+                }
             }
         }
     }
@@ -235,6 +223,9 @@ Error ExplosionScene::ChangeOccurred( ISubject* pSubject, System::Changes::BitMa
 // Update - Main Update for the Explosion Scene
 void ExplosionScene::Update(f32 DeltaTime)
 {
+    // Let the objects see the contacts which came in since the last update
+    m_POI.Publish();
+
     // Update all Explosion objects serially
     std::vector<ExplosionObject*>::iterator it;
     for ( it = m_Objects.begin(); it != m_Objects.end(); it++ )
@@ -255,19 +246,5 @@ void ExplosionScene::Update(f32 DeltaTime)
 // PostUpdate - PostUpdate processing
 void ExplosionScene::PostUpdate( void )
 {
-    // Loop through and remove and expired POI
-    std::list<POI*>::iterator it = m_POI.begin();
-    while( it != m_POI.end() )
-    {
-        POI* pPOI = *it;
-        if( pPOI->Expired() )
-        {
-            it = m_POI.erase( it );
-            delete pPOI;
-        }
-        else
-        {
-            it++;
-        }
-    }
+    // Nothing to remove, the contacts are dropped when the next ones are published
 }
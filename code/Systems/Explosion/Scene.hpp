@@ -15,11 +15,9 @@
 #pragma once
 
 // Standard Library
-#include <list>
-#include <mutex>
 #include <vector>
 // System
-#include "Systems/Common/POI.hpp"
+#include "Systems/Common/POIStore.hpp"
 
 class ExplosionSystem;
 class ExplosionTask;
@@ -35,7 +33,7 @@ class ExplosionScene : public ISystemScene
 
 public:
     inline std::vector<ExplosionObject*> GetObjects( void ) { return m_Objects; }
-    inline std::list<POI*> GetPOI( void ) { return m_POI; }
+    inline const POIStore& GetPOI( void ) { return m_POI; }
 
     void PostUpdate( void );
 
@@ -71,7 +69,6 @@ protected:
 
     ExplosionTask*                 m_pExplosionTask;   // Main task for this scene
     std::vector<ExplosionObject*>  m_Objects;          // Scene objects
-    std::list<POI*>         m_POI;                     // Scene points of interest
-    std::mutex m_mutex;
+    POIStore                       m_POI;              // Scene points of interest
 };
 
@@ -24,6 +24,11 @@ pcstr GeometryObject::sm_kapszPropertyNames[] =
     "Position", "Orientation", "Scale",
 };
 
+const Base::StringId GeometryObject::sm_kaPropertyIds[] =
+{
+    STRINGID( "Position" ), STRINGID( "Orientation" ), STRINGID( "Scale" ),
+};
+
 const Properties::Property GeometryObject::sm_kaDefaultProperties[] =
 {
     Properties::Property( sm_kapszPropertyNames[ Property_Position ],
@@ -53,6 +58,7 @@ GeometryObject::GeometryObject(
     , m_Scale( Base::Vector3::One )
 {
     ASSERT( Property_Count == sizeof sm_kapszPropertyNames / sizeof sm_kapszPropertyNames[ 0 ] );
+    ASSERT( Property_Count == sizeof sm_kaPropertyIds / sizeof sm_kaPropertyIds[ 0 ] );
     ASSERT( Property_Count == sizeof sm_kaDefaultProperties / sizeof sm_kaDefaultProperties[ 0 ] );
 }
 
@@ -135,21 +141,21 @@ GeometryObject::SetProperties(
     //
     for ( Properties::Iterator it=Properties.begin(); it != Properties.end(); it++ )
     {
-        std::string sName = it->GetName();
+        Base::StringId NameId = it->GetNameId();
 
         if ( it->GetFlags() & Properties::Flags::Valid )
         {
-            if ( sName == sm_kapszPropertyNames[ Property_Position ] )
+            if ( NameId == sm_kaPropertyIds[ Property_Position ] )
             {
                 m_Position = it->GetVector3();
                 PostChanges( System::Changes::Geometry::Position );
             }
-            else if ( sName == sm_kapszPropertyNames[ Property_Orientation ] )
+            else if ( NameId == sm_kaPropertyIds[ Property_Orientation ] )
             {
                 m_Orientation = it->GetQuaternion();
                 PostChanges( System::Changes::Geometry::Orientation );
             }
-            else if ( sName == sm_kapszPropertyNames[ Property_Scale ] )
+            else if ( NameId == sm_kaPropertyIds[ Property_Scale ] )
             {
                 m_Scale = it->GetVector3();
                 PostChanges( System::Changes::Geometry::Scale );
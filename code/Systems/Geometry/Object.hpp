@@ -90,6 +90,7 @@ protected:
     };
 
     static pcstr                        sm_kapszPropertyNames[];
+    static const Base::StringId         sm_kaPropertyIds[];
     static const Properties::Property   sm_kaDefaultProperties[];
 
 
@@ -38,7 +38,7 @@ GeometryScene::~GeometryScene(
     for ( std::list<GeometryObject*>::iterator it=m_Objects.begin();
           it != m_Objects.end(); it++ )
     {
-        delete *it;
+        Base::DestroyPooled<ISystemObject>( *it );
     }
 
     m_Objects.clear();
@@ -111,7 +111,7 @@ GeometryScene::CreateObject(
     //
     // Create the object and add it to the object list.
     //
-    GeometryObject* pObject = new GeometryObject( this );
+    GeometryObject* pObject = new( m_ObjectPool.Allocate() ) GeometryObject( this );
 
     if ( pObject != NULL )
     {
@@ -122,6 +122,20 @@ GeometryScene::CreateObject(
 }
 
 
+Bool
+GeometryScene::IsObjectInitializeThreadSafe(
+    pcstr pszType
+    )
+{
+    UNREFERENCED_PARAM( pszType );
+
+    //
+    // Initializing an object only sets its own transform.
+    //
+    return True;
+}
+
+
 Error
 GeometryScene::DestroyObject(
     ISystemObject* pSystemObject
@@ -136,11 +150,11 @@ GeometryScene::DestroyObject(
     GeometryObject* pObject = reinterpret_cast<GeometryObject*>(pSystemObject);
 
     //
-    // Remove the object from the list and delete it.
+    // Remove the object from the list and return it to the pool.
     //
     m_Objects.remove( pObject );
 
-    SAFE_DELETE( pSystemObject );
+    Base::DestroyPooled( pSystemObject );
 
     return Errors::Success;
 }
@@ -50,6 +50,7 @@ protected:
 
     virtual pcstr* GetObjectTypes( void );
     virtual ISystemObject* CreateObject( pcstr pszName, pcstr pszType );
+    virtual Bool IsObjectInitializeThreadSafe( pcstr pszType );
     virtual Error DestroyObject( ISystemObject* pSystemObject );
 
     virtual ISystemTask* GetSystemTask( void );
@@ -62,4 +63,5 @@ protected:
 protected:
 
     std::list<GeometryObject*>          m_Objects;
+    Base::ObjectPool<GeometryObject>    m_ObjectPool;
 };
@@ -15,6 +15,9 @@
 #include "Systems/GraphicsOGRE/System.hpp"
 
 
+extern ManagerInterfaces       g_Managers;
+
+
 #define POGRESCENEMGR (reinterpret_cast<OGREGraphicsScene*>(m_pSystemScene)->GetOGRESceneManager())
 
 
@@ -542,7 +545,8 @@ OGREGraphicsObjectMesh::ChangeOccurred(
         {
             u32 IndexDecl = pGfxObj->GetIndexDeclaration();
             u32 VertexDeclCount = pGfxObj->GetVertexDeclarationCount();
-            auto  pVertexDecl = new VertexDecl::Element[ VertexDeclCount ];
+            // Only needed while the sub mesh is built, the frame arena takes it back
+            auto  pVertexDecl = g_Managers.pService->FrameArena().CreateArray<VertexDecl::Element>( VertexDeclCount );
             ASSERT( pVertexDecl != NULL );
             pGfxObj->GetVertexDeclaration( pVertexDecl );
 
@@ -1155,7 +1159,7 @@ OGREGraphicsObjectMesh::BuildNormalsTemplate(
    
 
     u32 VertexDeclCount = GetVertexDeclarationCount( nSubMesh );
-    auto  pVertexDecl = new VertexDecl::Element[ VertexDeclCount ];
+    auto  pVertexDecl = g_Managers.pService->FrameArena().CreateArray<VertexDecl::Element>( VertexDeclCount );
     GetVertexDeclaration( pVertexDecl, nSubMesh );
     
     //
@@ -55,8 +55,6 @@ static float StaticTerrainHeightScene(const float a, const float b, void *userDa
     return ((OGREGraphicsScene*)userData)->getTerrainHeightScene( a, b, nullptr );
 }
 
-static const u32   UpdateGrainSize = 120;
-
 
 pcstr OGREGraphicsScene::sm_kapszPropertyNames[] =
 {
@@ -283,9 +281,9 @@ OGREGraphicsScene::Update(
 
     u32         size = (u32)m_Objects.size();
 
-    if (m_bParallelize && ( g_Managers.pTask != nullptr ) && ( UpdateGrainSize < size ))
+    if (m_bParallelize && ( g_Managers.pTask != nullptr ) && ( 1 < size ))
     {
-        g_Managers.pTask->ParallelFor( m_pTask, UpdateCallback, this, 0, size, UpdateGrainSize );
+        g_Managers.pTask->ParallelFor( m_pTask, UpdateCallback, this, 0, size );
     }
     else
     {
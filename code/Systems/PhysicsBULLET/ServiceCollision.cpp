@@ -326,7 +326,7 @@ LineTest(
             BulletObject* pObject = (BulletObject*)closestResults.collisionObject.getUserPointer();
             if( pObject )
             {
-                Result->m_Hit = pObject->GetName();
+                Result->m_Hit = pObject->GetNameId();
             }
         }
         else
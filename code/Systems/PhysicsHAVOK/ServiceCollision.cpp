@@ -24,11 +24,72 @@
 extern ManagerInterfaces    g_Managers;
 
 
+//
+// local constants
+//
+#define BATCH_GRAIN_SIZE 64  // Fewest tests of a batch run by one job
+
+
+//
+// local types
+//
+struct BatchJob
+{
+    const Collision::Request* m_pRequests;  // Requests of the batch
+    Collision::Result*        m_pResults;   // Results of the batch
+    HavokPhysicsScene*        m_pScene;     // Scene to test in
+};
+
+
+// Closest hit collector skipping the objects a request excludes
+class FilteredRayHitCollector : public hkpClosestRayHitCollector
+{
+public:
+    FilteredRayHitCollector( const Collision::Request& Request )
+        : m_Ignore( Request.m_Ignore )
+        , m_Flags( Request.m_Flags )
+    {
+    }
+
+protected:
+    virtual void addRayHit( const hkpCdBody& cdBody, const hkpShapeRayCastCollectorOutput& hitInfo )
+    {
+        const hkpCollidable* pCollidable = static_cast<const hkpCollidable*>( cdBody.getRootCollidable() );
+
+        // The ground is anything that does not move
+        const hkpRigidBody* pBody = hkpGetRigidBody( pCollidable );
+        Bool bGround = ( pBody != NULL && pBody->isFixed() ) ? True : False;
+        if( ( ( m_Flags & Collision::e_Ground ) && !bGround ) ||
+            ( ( m_Flags & Collision::e_IgnoreGround ) && bGround ) )
+        {
+            return;
+        }
+
+        if( m_Ignore != Base::InvalidStringId )
+        {
+            hkpWorldObject* pWorldObject = (hkpWorldObject*)pCollidable->getOwner();
+            HavokObject* pObject = (HavokObject*)pWorldObject->getUserData();
+            if( pObject != NULL && pObject->GetNameId() == m_Ignore )
+            {
+                return;
+            }
+        }
+
+        hkpClosestRayHitCollector::addRayHit( cdBody, hitInfo );
+    }
+
+private:
+    Base::StringId  m_Ignore;  // Name id of the object to skip
+    Collision::Flags m_Flags;  // Ground flags of the request
+};
+
+
 //
 // local prototypes
 //
 static void ProcessCollision( CollisionData& Data, HavokPhysicsScene* pScene );
 static void LineTest( const Collision::Request& Request, Collision::Result* Result, HavokPhysicsScene* pScene );
+static void ProcessBatchRange( void* pParam, u32 Begin, u32 End );
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -144,6 +205,72 @@ HavokCollisionService::ProcessRequests(
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// ProcessBatches - Process all requested batches of collisions
+void
+HavokCollisionService::ProcessBatches(
+    HavokPhysicsScene* pScene,
+    ISystemTask* pTask
+    )
+{
+    // Take the batches requested since the last update, new requests can come in
+    // while these are tested
+    std::vector<CollisionBatch*> Batches;
+    {
+        std::lock_guard<std::mutex> lock( m_BatchesLock );
+
+        std::map<Collision::Handle,CollisionBatch>::iterator it;
+        for( it = m_Batches.begin(); it != m_Batches.end(); it++ )
+        {
+            CollisionBatch& Batch = (*it).second;
+            if( Batch.m_bPending )
+            {
+                Batch.m_Testing.swap( Batch.m_Pending );
+                Batch.m_Pending.clear();
+                Batch.m_bPending = False;
+
+                Batches.push_back( &Batch );
+            }
+        }
+    }
+
+    std::vector<CollisionBatch*>::iterator it;
+    for( it = Batches.begin(); it != Batches.end(); it++ )
+    {
+        CollisionBatch* pBatch = *it;
+        u32 Count = (u32)pBatch->m_Testing.size();
+        pBatch->m_TestingResults.resize( Count );
+
+        // Run the tests, they only read the world
+        if( Count > 0 )
+        {
+            BatchJob Job;
+            Job.m_pRequests = &pBatch->m_Testing[ 0 ];
+            Job.m_pResults  = &pBatch->m_TestingResults[ 0 ];
+            Job.m_pScene    = pScene;
+
+            if( pTask != NULL && g_Managers.pTask != NULL && Count > BATCH_GRAIN_SIZE )
+            {
+                g_Managers.pTask->ParallelFor( pTask, ProcessBatchRange, &Job, 0, Count, BATCH_GRAIN_SIZE );
+            }
+            else
+            {
+                ProcessBatchRange( &Job, 0, Count );
+            }
+        }
+
+        // Store the results
+        {
+            std::lock_guard<std::mutex> lock( m_BatchesLock );
+
+            pBatch->m_Requests.swap( pBatch->m_Testing );
+            pBatch->m_Results.swap( pBatch->m_TestingResults );
+            pBatch->m_bFinished = True;
+        }
+    }
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Test - Requests a collision test
 Collision::Handle
@@ -246,6 +373,62 @@ HavokCollisionService::Finalize(
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// SubmitBatch - Requests a batch of collision tests
+Collision::Handle
+HavokCollisionService::SubmitBatch(
+    Collision::Handle Batch,
+    std::vector<Collision::Request>& Requests
+    )
+{
+    std::lock_guard<std::mutex> lock( m_BatchesLock );
+
+    // Create a new batch if the handle isn't known
+    if( Batch == Collision::InvalidHandle || m_Batches.find( Batch ) == m_Batches.end() )
+    {
+        std::lock_guard<std::mutex> lock2( m_PendingRequestsLock );
+        Batch = GetNextHandle();
+    }
+
+    // Store the requests to test them later, the caller gets the memory of the
+    // last ones back
+    CollisionBatch& Data = m_Batches[ Batch ];
+    Data.m_Pending.swap( Requests );
+    Data.m_bPending = True;
+
+    Requests.clear();
+
+    // Return the handle
+    return Batch;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FinalizeBatch - Gets the results of the batch tested last
+Bool
+HavokCollisionService::FinalizeBatch(
+    Collision::Handle Batch,
+    std::vector<Collision::Request>& Requests,
+    std::vector<Collision::Result>& Results
+    )
+{
+    std::lock_guard<std::mutex> lock( m_BatchesLock );
+
+    std::map<Collision::Handle,CollisionBatch>::iterator it = m_Batches.find( Batch );
+    if( it == m_Batches.end() || !(*it).second.m_bFinished )
+    {
+        return False;
+    }
+
+    // Hand out the results, the memory of the callers vectors is used for the next ones
+    Requests.swap( (*it).second.m_Requests );
+    Results.swap( (*it).second.m_Results );
+    (*it).second.m_bFinished = False;
+
+    return True;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // GetNextHandle - Returns the next unique handle
 Collision::Handle 
@@ -283,6 +466,36 @@ ProcessCollision(
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// ProcessBatchRange - Process a range of the collisions of a batch
+static void
+ProcessBatchRange(
+    void* pParam,
+    u32 Begin,
+    u32 End
+    )
+{
+    BatchJob* pJob = (BatchJob*)pParam;
+
+    // Every thread testing the batch locks the world for reading
+    hkpWorld* pWorld = pJob->m_pScene->GetWorld();
+    pWorld->lockReadOnly();
+
+    for( u32 i = Begin; i < End; i++ )
+    {
+        CollisionData Data;
+        memset( &Data, 0, sizeof( Data ) );
+
+        Data.m_Request = pJob->m_pRequests[ i ];
+        ProcessCollision( Data, pJob->m_pScene );
+
+        pJob->m_pResults[ i ] = Data.m_Result;
+    }
+
+    pWorld->unlockReadOnly();
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // LineTest - Initiate a collision line test
 static void 
@@ -302,8 +515,8 @@ LineTest(
     ASSERT( input.m_from.isOk3() );
     ASSERT( input.m_to.isOk3() );
 
-    // Perform ray cast
-    hkpClosestRayHitCollector output;
+    // Perform ray cast, skipping what the request excludes
+    FilteredRayHitCollector output( Request );
     pScene->GetWorld()->castRay( input, output );
 
     // Process results
@@ -325,7 +538,7 @@ LineTest(
         HavokObject* pObject = (HavokObject*)pWorldObject->getUserData();
         if( pObject )
         {
-            Result->m_Hit = pObject->GetName();
+            Result->m_Hit = pObject->GetNameId();
         }
     }
     else
@@ -336,6 +549,7 @@ LineTest(
     }
 
     // Mark is as finalized
+    Result->m_Filtered = True;
     Result->m_Finalized = True;
 }
 
@@ -29,6 +29,19 @@ struct CollisionData
     Collision::Result  m_Result;     // Result of collision
 };
 
+struct CollisionBatch
+{
+    std::vector<Collision::Request> m_Pending;         // Requests to test in the next update
+    std::vector<Collision::Request> m_Testing;         // Requests being tested
+    std::vector<Collision::Result>  m_TestingResults;  // Results of the requests being tested
+    std::vector<Collision::Request> m_Requests;        // Requests tested last
+    std::vector<Collision::Result>  m_Results;         // Results of the requests tested last
+    Bool                            m_bPending;        // m_Pending holds requests
+    Bool                            m_bFinished;       // m_Results holds results not taken yet
+
+    CollisionBatch() : m_bPending( False ), m_bFinished( False ) {}
+};
+
 
 ///////////////////////////////////////////////////////////////////////////////
 /// <summary>
@@ -56,6 +69,14 @@ public:
     /// <param name="pScene">Pointer to HavokPhysics system.</param>
     void ProcessRequests( HavokPhysicsScene* pScene );
 
+    /// <summary cref="HavokCollisionService::ProcessBatches">
+    ///   Processes the batches of collision tests requested since the last update.  The
+    ///   world must not be written to while the tests of a batch run in parallel.
+    /// </summary>
+    /// <param name="pScene">Pointer to HavokPhysics system.</param>
+    /// <param name="pTask">Task to run the tests in parallel for, NULL to run them serially.</param>
+    void ProcessBatches( HavokPhysicsScene* pScene, ISystemTask* pTask );
+
     /// <summary cref="HavokCollisionService::Test">
     ///   Implementation of the <c>ICollision::Test</c> function.
     ///   Registers a test request and returns a unique handle to make future requests.
@@ -80,6 +101,24 @@ public:
     /// <seealso cref="ICollision::Finalize"/>
     virtual Bool Finalize( Collision::Handle Handle, Collision::Result* pResult );
 
+    /// <summary cref="HavokCollisionService::SubmitBatch">
+    ///   Implementation of the <c>ICollision::SubmitBatch</c> function.
+    ///   Registers a batch of tests, which run when the requests are processed next.
+    /// </summary>
+    /// <returns>Coll::Handle - A unique handle for this batch.</returns>
+    /// <seealso cref="ICollision::SubmitBatch"/>
+    virtual Collision::Handle SubmitBatch( Collision::Handle Batch, std::vector<Collision::Request>& Requests );
+
+    /// <summary cref="HavokCollisionService::FinalizeBatch">
+    ///   Implementation of the <c>ICollision::FinalizeBatch</c> function.
+    ///   Request the results of the batch tested last.  If no new results are
+    ///   available, this will return false.
+    /// </summary>
+    /// <returns>Bool - True if new results were swapped in.</returns>
+    /// <seealso cref="ICollision::FinalizeBatch"/>
+    virtual Bool FinalizeBatch( Collision::Handle Batch, std::vector<Collision::Request>& Requests,
+                                std::vector<Collision::Result>& Results );
+
 
 protected:
 
@@ -96,9 +135,11 @@ protected:
     std::vector<Collision::Request>             m_PendingRequests;      // Store pending collision tests
     std::map<Collision::Handle,Collision::Result>    m_PendingResults;       // Store pending results
     std::vector<Collision::Handle>              m_DeadHandles;          // Store a list of used (dead) results
+    std::map<Collision::Handle,CollisionBatch>  m_Batches;              // Batches of collision tests
 
     std::mutex                                  m_PendingRequestsLock;  // Lock for m_PendingRequests
     std::mutex                                  m_PendingResultsLock;   // Lock for m_PendingResults
     std::mutex                                  m_DeadHandlesLock;      // Lock for m_DeadHandles
+    std::mutex                                  m_BatchesLock;          // Lock for m_Batches
 };
 
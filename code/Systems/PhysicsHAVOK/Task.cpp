@@ -199,12 +199,19 @@ HavokPhysicsTask::Update(
 			(*it)->Update();
 		}
 
+		//
+		// Process the batched collision requests in parallel while the world is only read.
+		//
+		HavokPhysicsSystem* pSystem = (HavokPhysicsSystem*)m_pScene->GetSystem();
+		m_pWorld->lockReadOnly();
+		pSystem->GetService()->ProcessBatches( m_pScene, this );
+		m_pWorld->unlockReadOnly();
+
 		m_pWorld->lock();
 
 		//
 		// Process collision request (need to make this use multithreaded jobs)
 		//
-		HavokPhysicsSystem* pSystem = (HavokPhysicsSystem*)m_pScene->GetSystem();
 		pSystem->GetService()->ProcessRequests( m_pScene );
 
 		//
@@ -40,12 +40,6 @@ extern ManagerInterfaces   g_Managers;
 #endif
 
 
-// Grain sizes of the parallel jobs. The less is the grainsize the better is 
-// the load balance, and the higher is the parallel overhead. 
-static const u32 FireObjectUpdateGrainSize = 10;  // 10 - 20
-static const u32 CollisionCheckGrainSize = 20;  // 10 - 20
-static const u32 BuildVerticesGrainSize = 10;
-
 
 pcstr FireObject::sm_kapszTypeNames[] =
 {
@@ -1099,12 +1093,13 @@ void FireObject::update(f32 fDeltaTime, const FireObjectList& fireObjectList)
     u32 size = (u32)m_Fires.size();
     if (
         ( g_Managers.pTask != NULL ) &&
-        ( FireObjectUpdateGrainSize < size )
+        ( 1 < size )
     )
     {
-        // This is nested parallel job, so we do not identify it (so far)
-        g_Managers.pTask->ParallelFor( /*GetSystemScene()->GetSystemTask()*/
-                                       NULL, UpdateCallback, this, 0, size, FireObjectUpdateGrainSize );
+        // Burning and idle fires differ a lot in cost, ParallelFor splits the range
+        // in halves so the idle threads can steal the expensive ones.
+        g_Managers.pTask->ParallelFor( GetSystemScene()->GetSystemTask(),
+                                       UpdateCallback, this, 0, size );
     }
     else
     {
@@ -1436,11 +1431,11 @@ void FireObject::EmitterCollisionCheck( const FireObjectList& fireObjectList, Pa
         // Iterate through all of the heat particle (rays) for "this" fire object.
         if (
             ( g_Managers.pTask != NULL ) &&
-            ( CollisionCheckGrainSize < size )
+            ( 1 < size )
         )
         {
-            // This is nested parallel job, so we do not identify it (so far)
-            g_Managers.pTask->ParallelFor( NULL, FireCollisionCallback, &cccd, 0, size, CollisionCheckGrainSize );
+            g_Managers.pTask->ParallelFor( GetSystemScene()->GetSystemTask(),
+                                           FireCollisionCallback, &cccd, 0, size );
         }
         else
         {
@@ -1717,7 +1712,6 @@ FireObject::GetVertexCount(
     }
     else
     {
-        std::vector<ParticleEmitter::Particle> particles;
         size_t size = m_Fires.size();
         for( size_t i = 0; i < size; ++i )
         {
@@ -1765,11 +1759,14 @@ FireObject::BuildVertexBuffer( void* pVertices )
 
     if (
         ( g_Managers.pTask != NULL ) &&
-        ( BuildVerticesGrainSize < size )
+        ( 1 < size )
     )
     {
-        // This is nested parallel job, so we do not identify it (so far)
-        g_Managers.pTask->ParallelFor( NULL, BuildVerticesCallback, this, 0, size, BuildVerticesGrainSize );
+        // The vertices are built with SIMD, hyperthreads of a core gain nothing on them.
+        u32 cJobs = g_Managers.pTask->GetRecommendedJobCount( ITaskManager::SIMD_FP );
+        u32 GrainSize = ( size + cJobs - 1 ) / std::max( cJobs, 1u );
+        g_Managers.pTask->ParallelFor( GetSystemScene()->GetSystemTask(),
+                                       BuildVerticesCallback, this, 0, size, GrainSize );
     }
     else
     {
@@ -1896,7 +1893,10 @@ FireObject::BuildVertexBuffer( void* pVertices )
     if(m_bRenderHeatParticles)
     {
         VertexHP *vhp = reinterpret_cast<VertexHP*>(m_pVertices);
-        std::vector<ParticleEmitter::HeatParticle> particles;
+        // No fire has more particles than all together, so the copies fit without growing
+        FrameAllocator<ParticleEmitter::HeatParticle> Allocator( g_Managers.pService->FrameArena() );
+        std::vector<ParticleEmitter::HeatParticle, FrameAllocator<ParticleEmitter::HeatParticle> > particles( Allocator );
+        particles.reserve( m_ParticleVertexCount );
 
         size_t size = m_Fires.size();
         for( size_t i = 0; i < size; ++i )
@@ -1931,7 +1931,9 @@ FireObject::BuildVertexBuffer( void* pVertices )
     else
     {
         VertexFP *vfp = reinterpret_cast<VertexFP*>(m_pVertices);
-        std::vector<ParticleEmitter::Particle> particles;
+        FrameAllocator<ParticleEmitter::Particle> Allocator( g_Managers.pService->FrameArena() );
+        std::vector<ParticleEmitter::Particle, FrameAllocator<ParticleEmitter::Particle> > particles( Allocator );
+        particles.reserve( m_ParticleVertexCount );
         size_t size = m_Fires.size();
         for( size_t i = 0; i < size; ++i )
         {
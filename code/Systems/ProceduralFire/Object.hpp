@@ -35,8 +35,7 @@ class FireTask;
 //    the limiting (longest) operation.
 #define FIREOBJ_PREBUILD_VERTICES 0
 
-// Use the constant BuildVerticesGrainSize defined in FireObject.cpp for fine 
-// tuning load balance vs. overhead.
+// The pieces are sized by ParallelFor after the measured cost of the fires.
 #define FIREOBJ_PARALLEL_BUILD_VERTICES 0
 
 ///////////////////////////////////////////////////////////////////////////////
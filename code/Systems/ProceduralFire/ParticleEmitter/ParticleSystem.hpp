@@ -127,7 +127,8 @@ public:
         return mAliveParticles;
     }
 
-    void getAliveParticles( std::vector<P> &particles ) const
+    template<class A>
+    void getAliveParticles( std::vector<P, A> &particles ) const
     {
         size_t size = mAliveParticles.size();
         for( size_t i = 0; i < size; ++i )
@@ -32,14 +32,6 @@
 extern ManagerInterfaces   g_Managers;
 
 
-// Grain sizes of the parallel jobs. The less is the grainsize the better is 
-// the load balance, and the higher is the parallel overhead. 
-static const u32    FireSystemTaskGrainSize = 8;
-
-#if FIRETASK_PARALLEL_PREBUILD_VERTICES
-    static const u32   BuildVetrexBuffersGrainSize = 40;
-#endif
-
 
 FireTask::FireTask(
     FireScene* pScene
@@ -82,10 +74,11 @@ FireTask::Update(
     if (
         m_pScene->m_bParallelize &&
         ( g_Managers.pTask != NULL ) &&
-        ( FireSystemTaskGrainSize < size )
+        ( 1 < size )
     )
     {
-        g_Managers.pTask->ParallelFor( this, UpdateCallback, this, 0, size, FireSystemTaskGrainSize );
+        // ParallelFor measures the cost of the objects and sizes the pieces after it
+        g_Managers.pTask->ParallelFor( this, UpdateCallback, this, 0, size );
     }
     else
     {
@@ -96,10 +89,10 @@ FireTask::Update(
     if (
         m_pScene->m_bParallelize &&
         ( g_Managers.pTask != NULL ) &&
-        ( BuildVetrexBuffersGrainSize < size )
+        ( 1 < size )
     )
     {
-        g_Managers.pTask->ParallelFor( this, BuildVertexBuffersCallback, this, 0, size, BuildVetrexBuffersGrainSize );
+        g_Managers.pTask->ParallelFor( this, BuildVertexBuffersCallback, this, 0, size );
     }
     else
     {
@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# Runs the AI on generated scenes of growing bot counts and prints its time per bot.
+# The scenes keep the same density, horses, chickens and swallows spread over a square
+# which grows with the count, so the time per bot should stay about the same.
+#
+# usage: BenchmarkAiScaling.sh <directory of Smoke> [bot counts]
+#        FRAMES and THREADS set Benchmark::Frames and TaskManager::Threads.
+
+BIN=${1:?usage: $0 <directory of Smoke> [bot counts]}
+shift
+COUNTS=${*:-300 1200 4800}
+FRAMES=${FRAMES:-200}
+THREADS=${THREADS:-0}
+
+SCENES=$(mktemp -d)
+trap 'rm -rf "$SCENES"' EXIT
+
+printf "%8s %12s %12s\n" bots "AI ms" "AI us/bot"
+for COUNT in $COUNTS
+do
+ GDF="$SCENES/ai$COUNT.gdf"
+ awk -v Count="$COUNT" 'BEGIN {
+  srand( 1 )
+  # 300 bots on a square of 4000 units
+  Half = 2000 * sqrt( Count / 300 )
+  split( "Horse Chicken Swallow", Types, " " )
+
+  print "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+  print "<GlobalDefinition>"
+  print "  <Systems>"
+  print "    <System Type=\"Geometry\" Lib=\"SystemGeometry\"/>"
+  print "    <System Type=\"AI\" Lib=\"SystemAi\"/>"
+  print "  </Systems>"
+  print "  <Scenes Startup=\"Main\">"
+  print "    <Scene Name=\"Main\">"
+  print "      <Properties SystemType=\"Geometry\"/>"
+  print "      <Properties SystemType=\"AI\"/>"
+  print "      <Objects>"
+  for ( i = 0; i < Count; i++ )
+  {
+   printf "        <Object Name=\"Bot%d\">\n", i
+   print  "          <Properties SystemType=\"Geometry\">"
+   printf "            <Property Name=\"Position\" Value1=\"%.1f\" Value2=\"0\" Value3=\"%.1f\"/>\n",
+          ( 2 * rand() - 1 ) * Half, ( 2 * rand() - 1 ) * Half
+   print  "          </Properties>"
+   printf "          <Properties SystemType=\"AI\" ObjectType=\"%s\"/>\n", Types[ i % 3 + 1 ]
+   print  "        </Object>"
+  }
+  print "      </Objects>"
+  print "    </Scene>"
+  print "  </Scenes>"
+  print "</GlobalDefinition>"
+ }' > "$GDF"
+
+ ( cd "$BIN" && ./Smoke --benchmark Benchmark::Frames="$FRAMES" Benchmark::Output="$SCENES/ai$COUNT.json" \
+                        TaskManager::Threads="$THREADS" "$GDF" > "$SCENES/ai$COUNT.log" 2>&1 )
+ MS=$(sed -n 's/.*"AI": { "mean": \([0-9.]*\).*/\1/p' "$SCENES/ai$COUNT.json" 2>/dev/null)
+ if [ -z "$MS" ]
+ then
+  echo "Smoke failed on $COUNT bots:" >&2
+  tail -5 "$SCENES/ai$COUNT.log" >&2
+  exit 1
+ fi
+ awk -v Count="$COUNT" -v Ms="$MS" 'BEGIN { printf "%8d %12.3f %12.3f\n", Count, Ms, Ms * 1000 / Count }'
+done